@@ -0,0 +1,533 @@
+#include "accessor_decode.h"
+#include "core/logging.h"
+#include "core/timer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ACCESSOR_DECODE_AVX2 1
+#define ACCESSOR_DECODE_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ACCESSOR_DECODE_SSE2 1
+#endif
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#define ACCESSOR_DECODE_F16C 1
+#endif
+
+static uint32_t get_component_count(cgltf_type type) {
+    switch (type) {
+        case cgltf_type_scalar: return 1;
+        case cgltf_type_vec2: return 2;
+        case cgltf_type_vec3: return 3;
+        case cgltf_type_vec4: return 4;
+        default: ASSERT_MESSAGE(false, "unsupported accessor type - %d", type);
+    }
+    return 0;
+}
+
+static uint32_t get_component_size(cgltf_component_type component_type) {
+    switch (component_type) {
+        case cgltf_component_type_r_8:
+        case cgltf_component_type_r_8u: return 1;
+        case cgltf_component_type_r_16:
+        case cgltf_component_type_r_16u: return 2;
+        case cgltf_component_type_r_32u:
+        case cgltf_component_type_r_32f: return 4;
+        default: ASSERT_MESSAGE(false, "unsupported component type - %d", component_type);
+    }
+    return 0;
+}
+
+static const uint8_t *get_buffer_view_data(const cgltf_buffer_view *buffer_view) {
+    // 经过 meshopt 解压的 buffer view 数据存放在 `data` 中
+    if (buffer_view->data) { return (const uint8_t *) buffer_view->data; }
+    return (const uint8_t *) buffer_view->buffer->data + buffer_view->offset;
+}
+
+// 归一化与 SIMD 路径一样乘以倒数，保证两条路径结果逐位一致
+static float read_component(const uint8_t *src, cgltf_component_type component_type, bool normalized) {
+    switch (component_type) {
+        case cgltf_component_type_r_8: {
+            int8_t value;
+            memcpy(&value, src, sizeof(value));
+            return normalized ? std::max(value * (1.0f / 127.0f), -1.0f) : (float) value;
+        }
+        case cgltf_component_type_r_8u: return normalized ? src[0] * (1.0f / 255.0f) : (float) src[0];
+        case cgltf_component_type_r_16: {
+            int16_t value;
+            memcpy(&value, src, sizeof(value));
+            return normalized ? std::max(value * (1.0f / 32767.0f), -1.0f) : (float) value;
+        }
+        case cgltf_component_type_r_16u: {
+            uint16_t value;
+            memcpy(&value, src, sizeof(value));
+            return normalized ? value * (1.0f / 65535.0f) : (float) value;
+        }
+        case cgltf_component_type_r_32u: {
+            uint32_t value;
+            memcpy(&value, src, sizeof(value));
+            return (float) value;
+        }
+        case cgltf_component_type_r_32f: {
+            float value;
+            memcpy(&value, src, sizeof(value));
+            return value;
+        }
+        default: ASSERT_MESSAGE(false, "unsupported component type - %d", component_type);
+    }
+    return 0.0f;
+}
+
+static uint32_t read_index(const uint8_t *src, cgltf_component_type component_type) {
+    switch (component_type) {
+        case cgltf_component_type_r_8u: return src[0];
+        case cgltf_component_type_r_16u: {
+            uint16_t value;
+            memcpy(&value, src, sizeof(value));
+            return value;
+        }
+        case cgltf_component_type_r_32u: {
+            uint32_t value;
+            memcpy(&value, src, sizeof(value));
+            return value;
+        }
+        default: ASSERT_MESSAGE(false, "unsupported index component type - %d", component_type);
+    }
+    return 0;
+}
+
+static void decode_elements_scalar(const uint8_t *src, size_t src_stride, cgltf_component_type component_type, bool normalized,
+                                   uint32_t component_count, size_t first, size_t count, float *dst, size_t dst_stride) {
+    uint32_t component_size = get_component_size(component_type);
+    for (size_t i = first; i < count; ++i) {
+        const uint8_t *element = src + i * src_stride;
+        float *out = (float *) ((uint8_t *) dst + i * dst_stride);
+        for (uint32_t c = 0; c < component_count; ++c) { out[c] = read_component(element + c * component_size, component_type, normalized); }
+    }
+}
+
+#if ACCESSOR_DECODE_SSE2
+// 一次读取 4 个分量并转换为 float，读取的字节数可能超过元素本身，调用方需保证不越界
+static __m128 load_element_sse2(const uint8_t *src, cgltf_component_type component_type, bool normalized) {
+    switch (component_type) {
+        case cgltf_component_type_r_8: {
+            int32_t bits;
+            memcpy(&bits, src, sizeof(bits));
+            __m128i x = _mm_cvtsi32_si128(bits);
+            x = _mm_unpacklo_epi8(x, x);
+            x = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 24);
+            __m128 v = _mm_cvtepi32_ps(x);
+            return normalized ? _mm_max_ps(_mm_mul_ps(v, _mm_set1_ps(1.0f / 127.0f)), _mm_set1_ps(-1.0f)) : v;
+        }
+        case cgltf_component_type_r_8u: {
+            int32_t bits;
+            memcpy(&bits, src, sizeof(bits));
+            __m128i zero = _mm_setzero_si128();
+            __m128i x = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero);
+            __m128 v = _mm_cvtepi32_ps(x);
+            return normalized ? _mm_mul_ps(v, _mm_set1_ps(1.0f / 255.0f)) : v;
+        }
+        case cgltf_component_type_r_16: {
+            __m128i x = _mm_loadl_epi64((const __m128i *) src);
+            x = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+            __m128 v = _mm_cvtepi32_ps(x);
+            return normalized ? _mm_max_ps(_mm_mul_ps(v, _mm_set1_ps(1.0f / 32767.0f)), _mm_set1_ps(-1.0f)) : v;
+        }
+        case cgltf_component_type_r_16u: {
+            __m128i x = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *) src), _mm_setzero_si128());
+            __m128 v = _mm_cvtepi32_ps(x);
+            return normalized ? _mm_mul_ps(v, _mm_set1_ps(1.0f / 65535.0f)) : v;
+        }
+        default: return _mm_loadu_ps((const float *) src);
+    }
+}
+
+// 只写入 `component_count` 个分量，不会覆盖目标中相邻的数据
+static void store_element_sse2(float *dst, __m128 v, uint32_t component_count) {
+    switch (component_count) {
+        case 1: _mm_store_ss(dst, v); break;
+        case 2: _mm_storel_pi((__m64 *) dst, v); break;
+        case 3:
+            _mm_storel_pi((__m64 *) dst, v);
+            _mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+            break;
+        default: _mm_storeu_ps(dst, v); break;
+    }
+}
+#endif
+
+// 源与目标都紧密排列时按分量整体转换，不区分元素边界
+static void decode_tight(const uint8_t *src, cgltf_component_type component_type, bool normalized, size_t scalar_count, float *dst) {
+    size_t i = 0;
+#if ACCESSOR_DECODE_AVX2
+    if (component_type == cgltf_component_type_r_8u || component_type == cgltf_component_type_r_16u) {
+        bool is_u8 = component_type == cgltf_component_type_r_8u;
+        __m256 scale = _mm256_set1_ps(is_u8 ? 1.0f / 255.0f : 1.0f / 65535.0f);
+        for (; i + 8 <= scalar_count; i += 8) {
+            __m256i x = is_u8 ? _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (src + i)))
+                              : _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (src + i * 2)));
+            __m256 v = _mm256_cvtepi32_ps(x);
+            _mm256_storeu_ps(dst + i, normalized ? _mm256_mul_ps(v, scale) : v);
+        }
+    } else if (component_type == cgltf_component_type_r_8 || component_type == cgltf_component_type_r_16) {
+        bool is_s8 = component_type == cgltf_component_type_r_8;
+        __m256 scale = _mm256_set1_ps(is_s8 ? 1.0f / 127.0f : 1.0f / 32767.0f);
+        __m256 minus_one = _mm256_set1_ps(-1.0f);
+        for (; i + 8 <= scalar_count; i += 8) {
+            __m256i x = is_s8 ? _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *) (src + i)))
+                              : _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (src + i * 2)));
+            __m256 v = _mm256_cvtepi32_ps(x);
+            _mm256_storeu_ps(dst + i, normalized ? _mm256_max_ps(_mm256_mul_ps(v, scale), minus_one) : v);
+        }
+    }
+#elif ACCESSOR_DECODE_SSE2
+    if (component_type != cgltf_component_type_r_32u && component_type != cgltf_component_type_r_32f) {
+        uint32_t component_size = get_component_size(component_type);
+        // 8 位分量一次读取 4 字节、16 位分量一次读取 8 字节，均不超过最后 4 个分量的范围
+        for (; i + 4 <= scalar_count; i += 4) { _mm_storeu_ps(dst + i, load_element_sse2(src + i * component_size, component_type, normalized)); }
+    }
+#endif
+    decode_elements_scalar(src, get_component_size(component_type), component_type, normalized, 1, i, scalar_count, dst, sizeof(float));
+}
+
+static void decode_strided(const uint8_t *src, size_t src_stride, size_t src_available, cgltf_component_type component_type, bool normalized,
+                           uint32_t component_count, size_t count, float *dst, size_t dst_stride) {
+    size_t i = 0;
+#if ACCESSOR_DECODE_SSE2
+    if (component_type != cgltf_component_type_r_32u) {
+        // SIMD 每次读取 4 个分量，只有读取范围仍在 buffer view 内的元素才走 SIMD，其余回退到标量
+        size_t load_size = 4 * get_component_size(component_type);
+        size_t simd_count = 0;
+        if (src_available >= load_size) { simd_count = std::min(count, (src_available - load_size) / src_stride + 1); }
+        for (; i < simd_count; ++i) {
+            __m128 v = load_element_sse2(src + i * src_stride, component_type, normalized);
+            store_element_sse2((float *) ((uint8_t *) dst + i * dst_stride), v, component_count);
+        }
+    }
+#endif
+    decode_elements_scalar(src, src_stride, component_type, normalized, component_count, i, count, dst, dst_stride);
+}
+
+static void apply_sparse(const cgltf_accessor *accessor, uint32_t component_count, float *dst, size_t dst_stride) {
+    const cgltf_accessor_sparse *sparse = &accessor->sparse;
+    const uint8_t *indices = get_buffer_view_data(sparse->indices_buffer_view) + sparse->indices_byte_offset;
+    const uint8_t *values = get_buffer_view_data(sparse->values_buffer_view) + sparse->values_byte_offset;
+    uint32_t index_size = get_component_size(sparse->indices_component_type);
+    uint32_t component_size = get_component_size(accessor->component_type);
+    size_t value_stride = component_size * get_component_count(accessor->type);
+
+    for (size_t i = 0; i < sparse->count; ++i) {
+        uint32_t element_index = read_index(indices + i * index_size, sparse->indices_component_type);
+        ASSERT(element_index < accessor->count);
+        float *out = (float *) ((uint8_t *) dst + element_index * dst_stride);
+        for (uint32_t c = 0; c < component_count; ++c) {
+            out[c] = read_component(values + i * value_stride + c * component_size, accessor->component_type, accessor->normalized);
+        }
+    }
+}
+
+void decode_accessor_floats(const cgltf_accessor *accessor, float *dst, uint32_t dst_component_count, size_t dst_stride) {
+    uint32_t component_count = std::min(get_component_count(accessor->type), dst_component_count);
+
+    if (!accessor->buffer_view) {
+        // 没有 buffer view 的 accessor 初始值全为 0，只由 sparse 数据填充
+        for (size_t i = 0; i < accessor->count; ++i) {
+            memset((uint8_t *) dst + i * dst_stride, 0, component_count * sizeof(float));
+        }
+    } else {
+        const uint8_t *src = get_buffer_view_data(accessor->buffer_view) + accessor->offset;
+        size_t src_available = accessor->buffer_view->size - accessor->offset;
+        size_t src_element_size = get_component_size(accessor->component_type) * get_component_count(accessor->type);
+        size_t src_stride = accessor->stride ? accessor->stride : src_element_size;
+
+        bool is_tight = src_stride == src_element_size && component_count == get_component_count(accessor->type) &&
+                        dst_stride == component_count * sizeof(float);
+        if (is_tight && accessor->component_type == cgltf_component_type_r_32f) {
+            memcpy(dst, src, accessor->count * src_element_size);
+        } else if (is_tight) {
+            decode_tight(src, accessor->component_type, accessor->normalized, accessor->count * component_count, dst);
+        } else {
+            decode_strided(src, src_stride, src_available, accessor->component_type, accessor->normalized, component_count,
+                           accessor->count, dst, dst_stride);
+        }
+    }
+
+    if (accessor->is_sparse) { apply_sparse(accessor, component_count, dst, dst_stride); }
+}
+
+static void widen_u16_indices(const uint8_t *src, uint32_t *dst, size_t count) {
+    size_t i = 0;
+#if ACCESSOR_DECODE_AVX2
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (src + i * 2))));
+    }
+#elif ACCESSOR_DECODE_SSE2
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (src + i * 2));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_unpacklo_epi16(x, zero));
+        _mm_storeu_si128((__m128i *) (dst + i + 4), _mm_unpackhi_epi16(x, zero));
+    }
+#endif
+    for (; i < count; ++i) { dst[i] = read_index(src + i * 2, cgltf_component_type_r_16u); }
+}
+
+static void widen_u8_indices(const uint8_t *src, uint32_t *dst, size_t count) {
+    size_t i = 0;
+#if ACCESSOR_DECODE_AVX2
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (src + i))));
+    }
+#elif ACCESSOR_DECODE_SSE2
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i lo = _mm_unpacklo_epi8(x, zero);
+        __m128i hi = _mm_unpackhi_epi8(x, zero);
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *) (dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *) (dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i *) (dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+    }
+#endif
+    for (; i < count; ++i) { dst[i] = src[i]; }
+}
+
+void decode_accessor_indices(const cgltf_accessor *accessor, uint32_t *dst) {
+    ASSERT(accessor->buffer_view);
+    const uint8_t *src = get_buffer_view_data(accessor->buffer_view) + accessor->offset;
+    uint32_t index_size = get_component_size(accessor->component_type);
+    size_t stride = accessor->stride ? accessor->stride : index_size;
+
+    if (stride != index_size) {
+        for (size_t i = 0; i < accessor->count; ++i) { dst[i] = read_index(src + i * stride, accessor->component_type); }
+    } else if (accessor->component_type == cgltf_component_type_r_32u) {
+        memcpy(dst, src, accessor->count * sizeof(uint32_t));
+    } else if (accessor->component_type == cgltf_component_type_r_16u) {
+        widen_u16_indices(src, dst, accessor->count);
+    } else if (accessor->component_type == cgltf_component_type_r_8u) {
+        widen_u8_indices(src, dst, accessor->count);
+    } else {
+        ASSERT_MESSAGE(false, "unsupported index component type - %d", accessor->component_type);
+    }
+
+    if (accessor->is_sparse) {
+        const cgltf_accessor_sparse *sparse = &accessor->sparse;
+        const uint8_t *indices = get_buffer_view_data(sparse->indices_buffer_view) + sparse->indices_byte_offset;
+        const uint8_t *values = get_buffer_view_data(sparse->values_buffer_view) + sparse->values_byte_offset;
+        uint32_t sparse_index_size = get_component_size(sparse->indices_component_type);
+        for (size_t i = 0; i < sparse->count; ++i) {
+            uint32_t element_index = read_index(indices + i * sparse_index_size, sparse->indices_component_type);
+            ASSERT(element_index < accessor->count);
+            dst[element_index] = read_index(values + i * index_size, accessor->component_type);
+        }
+    }
+}
+
+static float half_to_float(uint16_t half) {
+    uint32_t sign = (uint32_t) (half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1fu;
+    uint32_t mantissa = half & 0x3ffu;
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // subnormal，规格化后再转换
+            exponent = 127 - 15 + 1;
+            while (!(mantissa & 0x400u)) {
+                mantissa <<= 1;
+                --exponent;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+        }
+    } else if (exponent == 0x1f) {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint16_t float_to_half(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (bits >> 16) & 0x8000u;
+    uint32_t abs_bits = bits & 0x7fffffffu;
+
+    if (abs_bits > 0x7f800000u) { return sign | 0x7e00u; } // nan
+    if (abs_bits >= 0x477ff000u) { return sign | 0x7c00u; } // 超出 half 范围，包括 inf
+    if (abs_bits < 0x38800000u) {
+        // 结果为 subnormal，乘以 2^24 后按当前舍入模式（默认 nearest-even）取整
+        float abs_value;
+        memcpy(&abs_value, &abs_bits, sizeof(abs_value));
+        return sign | (uint16_t) std::nearbyint(abs_value * 16777216.0f);
+    }
+
+    uint32_t half = (abs_bits >> 13) - ((127 - 15) << 10);
+    uint32_t round_bits = abs_bits & 0x1fffu;
+    if (round_bits > 0x1000u || (round_bits == 0x1000u && (half & 1u))) { ++half; }
+    return sign | (uint16_t) half;
+}
+
+void convert_halfs_to_floats(const uint16_t *src, float *dst, size_t count) {
+    size_t i = 0;
+#if ACCESSOR_DECODE_F16C
+    for (; i + 8 <= count; i += 8) { _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) (src + i)))); }
+#endif
+    for (; i < count; ++i) { dst[i] = half_to_float(src[i]); }
+}
+
+void convert_floats_to_halfs(const float *src, uint16_t *dst, size_t count) {
+    size_t i = 0;
+#if ACCESSOR_DECODE_F16C
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128((__m128i *) (dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+#endif
+    for (; i < count; ++i) { dst[i] = float_to_half(src[i]); }
+}
+
+const char *accessor_decode_simd_name() {
+#if ACCESSOR_DECODE_AVX2 && ACCESSOR_DECODE_F16C
+    return "avx2+f16c";
+#elif ACCESSOR_DECODE_AVX2
+    return "avx2";
+#elif ACCESSOR_DECODE_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+static void log_benchmark_result(const char *name, size_t element_count, uint32_t iteration_count, double simd_ms, double scalar_ms) {
+    double total_elements = (double) element_count * iteration_count;
+    log_info("accessor decode benchmark: %s, %zu elements, %u iterations, %.1f elements/us %s, %.1f elements/us scalar", name, element_count,
+             iteration_count, simd_ms > 0.0 ? total_elements / (simd_ms * 1e3) : 0.0, accessor_decode_simd_name(),
+             scalar_ms > 0.0 ? total_elements / (scalar_ms * 1e3) : 0.0);
+}
+
+void accessor_decode_benchmark(uint32_t element_count, uint32_t iteration_count) {
+    uint32_t seed = 1;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+
+    // 归一化 u16 vec4 紧密排列（如 joint weights）与 s16 vec3 按 8 字节跨距排列（如量化后的法线）
+    std::vector<uint8_t> bytes((size_t) element_count * 8);
+    for (uint8_t &byte : bytes) { byte = (uint8_t) random(); }
+    cgltf_buffer buffer{};
+    buffer.data = bytes.data();
+    buffer.size = bytes.size();
+    cgltf_buffer_view buffer_view{};
+    buffer_view.buffer = &buffer;
+    buffer_view.size = bytes.size();
+
+    struct FloatCase {
+        const char *name;
+        cgltf_component_type component_type;
+        cgltf_type type;
+        size_t stride;
+    };
+    const FloatCase float_cases[] = {
+        {"u16 vec4 tight", cgltf_component_type_r_16u, cgltf_type_vec4, 0},
+        {"s16 vec3 strided", cgltf_component_type_r_16, cgltf_type_vec3, 8},
+    };
+    std::vector<float> simd_floats((size_t) element_count * 4), scalar_floats((size_t) element_count * 4);
+    for (const FloatCase &float_case : float_cases) {
+        cgltf_accessor accessor{};
+        accessor.component_type = float_case.component_type;
+        accessor.normalized = true;
+        accessor.type = float_case.type;
+        accessor.count = element_count;
+        accessor.stride = float_case.stride;
+        accessor.buffer_view = &buffer_view;
+        uint32_t component_count = get_component_count(float_case.type);
+        size_t src_stride = float_case.stride ? float_case.stride : component_count * get_component_size(float_case.component_type);
+        size_t dst_stride = component_count * sizeof(float);
+
+        uint64_t start_time = timer_now_ns();
+        for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) {
+            decode_accessor_floats(&accessor, simd_floats.data(), component_count, dst_stride);
+        }
+        double simd_ms = timer_elapsed_ms(start_time);
+
+        start_time = timer_now_ns();
+        for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) {
+            decode_elements_scalar(bytes.data(), src_stride, float_case.component_type, true, component_count, 0, element_count, scalar_floats.data(),
+                                   dst_stride);
+        }
+        double scalar_ms = timer_elapsed_ms(start_time);
+
+        ASSERT_MESSAGE(memcmp(simd_floats.data(), scalar_floats.data(), element_count * dst_stride) == 0,
+                       "accessor decode %s %s result differs from scalar", float_case.name, accessor_decode_simd_name());
+        log_benchmark_result(float_case.name, element_count, iteration_count, simd_ms, scalar_ms);
+    }
+
+    const cgltf_component_type index_types[] = {cgltf_component_type_r_8u, cgltf_component_type_r_16u};
+    std::vector<uint32_t> simd_indices(element_count), scalar_indices(element_count);
+    for (cgltf_component_type index_type : index_types) {
+        cgltf_accessor accessor{};
+        accessor.component_type = index_type;
+        accessor.type = cgltf_type_scalar;
+        accessor.count = element_count;
+        accessor.buffer_view = &buffer_view;
+        uint32_t index_size = get_component_size(index_type);
+
+        uint64_t start_time = timer_now_ns();
+        for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) { decode_accessor_indices(&accessor, simd_indices.data()); }
+        double simd_ms = timer_elapsed_ms(start_time);
+
+        start_time = timer_now_ns();
+        for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) {
+            for (size_t i = 0; i < element_count; ++i) { scalar_indices[i] = read_index(bytes.data() + i * index_size, index_type); }
+        }
+        double scalar_ms = timer_elapsed_ms(start_time);
+
+        const char *name = index_type == cgltf_component_type_r_8u ? "u8 indices" : "u16 indices";
+        ASSERT_MESSAGE(simd_indices == scalar_indices, "accessor decode %s %s result differs from scalar", name, accessor_decode_simd_name());
+        log_benchmark_result(name, element_count, iteration_count, simd_ms, scalar_ms);
+    }
+
+    // half 不含 inf/nan，float 的指数覆盖 subnormal 到超出 half 范围，nan 的 payload 在两条路径上不保证一致
+    std::vector<uint16_t> halfs(element_count), simd_halfs(element_count), scalar_halfs(element_count);
+    std::vector<float> floats(element_count);
+    for (uint32_t i = 0; i < element_count; ++i) {
+        uint32_t bits = random();
+        halfs[i] = (uint16_t) ((bits & 0x8000u) | (bits % 0x7c00u));
+        uint32_t float_bits = ((bits & 1u) << 31) | ((100u + random() % 46u) << 23) | (random() & 0x7fffffu);
+        memcpy(&floats[i], &float_bits, sizeof(float));
+    }
+
+    uint64_t start_time = timer_now_ns();
+    for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) { convert_halfs_to_floats(halfs.data(), simd_floats.data(), element_count); }
+    double simd_ms = timer_elapsed_ms(start_time);
+    start_time = timer_now_ns();
+    for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) {
+        for (size_t i = 0; i < element_count; ++i) { scalar_floats[i] = half_to_float(halfs[i]); }
+    }
+    double scalar_ms = timer_elapsed_ms(start_time);
+    ASSERT_MESSAGE(memcmp(simd_floats.data(), scalar_floats.data(), element_count * sizeof(float)) == 0,
+                   "accessor decode half to float %s result differs from scalar", accessor_decode_simd_name());
+    log_benchmark_result("half to float", element_count, iteration_count, simd_ms, scalar_ms);
+
+    start_time = timer_now_ns();
+    for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) { convert_floats_to_halfs(floats.data(), simd_halfs.data(), element_count); }
+    simd_ms = timer_elapsed_ms(start_time);
+    start_time = timer_now_ns();
+    for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) {
+        for (size_t i = 0; i < element_count; ++i) { scalar_halfs[i] = float_to_half(floats[i]); }
+    }
+    scalar_ms = timer_elapsed_ms(start_time);
+    ASSERT_MESSAGE(simd_halfs == scalar_halfs, "accessor decode float to half %s result differs from scalar", accessor_decode_simd_name());
+    log_benchmark_result("float to half", element_count, iteration_count, simd_ms, scalar_ms);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cgltf.h>
+#include <cstddef>
+#include <cstdint>
+
+#define ACCESSOR_DECODE_BENCHMARK_ELEMENT_COUNT 262144
+#define ACCESSOR_DECODE_BENCHMARK_ITERATION_COUNT 50
+
+// 将 accessor 解码为 float，每个元素最多写入 `dst_component_count` 个 float，相邻元素间隔 `dst_stride` 字节
+// 支持 float 以及（归一化的）u8/s8/u16/s16/u32 分量，sparse accessor 的替换值在稠密数据之后写入
+// accessor 的分量数少于 `dst_component_count` 时，多出的分量保持原值
+void decode_accessor_floats(const cgltf_accessor *accessor, float *dst, uint32_t dst_component_count, size_t dst_stride);
+
+// 将 u8/u16/u32 索引 accessor 统一扩展为 u32
+void decode_accessor_indices(const cgltf_accessor *accessor, uint32_t *dst);
+
+void convert_halfs_to_floats(const uint16_t *src, float *dst, size_t count);
+
+// 按 round-to-nearest-even 舍入
+void convert_floats_to_halfs(const float *src, uint16_t *dst, size_t count);
+
+// 编译时启用的指令集，用于日志输出
+const char *accessor_decode_simd_name();
+
+// 用随机数据分别计时 SIMD 与标量路径，结果不一致时断言失败
+void accessor_decode_benchmark(uint32_t element_count, uint32_t iteration_count);
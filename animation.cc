@@ -0,0 +1,475 @@
+#include "animation.h"
+#include "mesh_loader.h"
+#include "core/logging.h"
+#include "core/thread_pool.h"
+#include "core/timer.h"
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ANIMATION_AVX2 1
+#define ANIMATION_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ANIMATION_SSE2 1
+#endif
+
+#define ANIMATION_INSTANCES_PER_JOB 8 // 每个任务至少处理的实例数，实例很少时不值得分发到工作线程
+#define ANIMATION_JOBS_PER_THREAD 4   // 每个线程分到的任务数，实例的关节数不同时平衡负载
+
+void animation_system_create(ThreadPool *thread_pool, AnimationSystem **out_animation_system) {
+    AnimationSystem *animation_system = new AnimationSystem();
+    animation_system->thread_pool = thread_pool;
+    *out_animation_system = animation_system;
+}
+
+void animation_system_destroy(AnimationSystem *animation_system) { delete animation_system; }
+
+// 填充部分为单位变换
+static void resize_pose(AnimationPose *pose, uint32_t joint_count) {
+    for (uint32_t i = 0; i < 3; ++i) { pose->translations[i].resize(joint_count, 0.0f); }
+    for (uint32_t i = 0; i < 4; ++i) { pose->rotations[i].resize(joint_count, i == 3 ? 1.0f : 0.0f); }
+    for (uint32_t i = 0; i < 3; ++i) { pose->scales[i].resize(joint_count, 1.0f); }
+}
+
+static void copy_pose(const AnimationPose *source, AnimationPose *destination) {
+    for (uint32_t i = 0; i < 3; ++i) { destination->translations[i] = source->translations[i]; }
+    for (uint32_t i = 0; i < 4; ++i) { destination->rotations[i] = source->rotations[i]; }
+    for (uint32_t i = 0; i < 3; ++i) { destination->scales[i] = source->scales[i]; }
+}
+
+static int32_t find_skeleton_joint(const Skeleton *skeleton, uint32_t node) {
+    auto it = std::lower_bound(skeleton->nodes.begin(), skeleton->nodes.end(), node);
+    return it != skeleton->nodes.end() && *it == node ? (int32_t) (it - skeleton->nodes.begin()) : -1;
+}
+
+// 关节与其最近的关节祖先之间的节点也参与计算，否则动画无法传递到这些节点的子关节
+static void build_skeleton(const TransformHierarchy *hierarchy, const Skin *skin, Skeleton *skeleton) {
+    std::vector<uint32_t> joint_nodes = skin->joint_nodes;
+    std::sort(joint_nodes.begin(), joint_nodes.end());
+    joint_nodes.erase(std::unique(joint_nodes.begin(), joint_nodes.end()), joint_nodes.end());
+    auto is_joint = [&](uint32_t node) { return std::binary_search(joint_nodes.begin(), joint_nodes.end(), node); };
+
+    std::vector<uint32_t> &nodes = skeleton->nodes;
+    nodes = joint_nodes;
+    std::vector<uint32_t> path;
+    for (uint32_t joint_node: joint_nodes) {
+        path.clear();
+        int32_t parent = hierarchy->parents[joint_node];
+        while (parent >= 0 && !is_joint(parent)) {
+            path.push_back(parent);
+            parent = hierarchy->parents[parent];
+        }
+        if (parent >= 0) { nodes.insert(nodes.end(), path.begin(), path.end()); }
+    }
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+    // 先序排列下按节点下标排序即保证父关节在前
+    skeleton->joint_count = nodes.size();
+    skeleton->padded_joint_count = (skeleton->joint_count + ANIMATION_JOINT_ALIGNMENT - 1) / ANIMATION_JOINT_ALIGNMENT * ANIMATION_JOINT_ALIGNMENT;
+    skeleton->parents.resize(skeleton->joint_count);
+    skeleton->parent_nodes.resize(skeleton->joint_count);
+    resize_pose(&skeleton->rest_pose, skeleton->padded_joint_count);
+    for (uint32_t i = 0; i < skeleton->joint_count; ++i) {
+        int32_t parent_node = hierarchy->parents[nodes[i]];
+        int32_t parent = parent_node >= 0 ? find_skeleton_joint(skeleton, parent_node) : -1;
+        skeleton->parents[i] = parent;
+        skeleton->parent_nodes[i] = parent >= 0 ? -1 : parent_node;
+
+        for (uint32_t j = 0; j < 3; ++j) { skeleton->rest_pose.translations[j][i] = hierarchy->translations[j][nodes[i]]; }
+        for (uint32_t j = 0; j < 4; ++j) { skeleton->rest_pose.rotations[j][i] = hierarchy->rotations[j][nodes[i]]; }
+        for (uint32_t j = 0; j < 3; ++j) { skeleton->rest_pose.scales[j][i] = hierarchy->scales[j][nodes[i]]; }
+    }
+
+    skeleton->skin_joints.resize(skin->joint_nodes.size());
+    for (size_t i = 0; i < skin->joint_nodes.size(); ++i) { skeleton->skin_joints[i] = find_skeleton_joint(skeleton, skin->joint_nodes[i]); }
+    skeleton->inverse_bind_matrices = skin->inverse_bind_matrices;
+}
+
+int32_t add_animation_layer(AnimationInstance *instance, const Skeleton *skeleton, const Geometry *geometry, uint32_t clip_index, float weight) {
+    if (instance->layer_count == ANIMATION_MAX_LAYERS) { return -1; }
+
+    const AnimationClip *clip = &geometry->animations[clip_index];
+    AnimationLayer *layer = &instance->layers[instance->layer_count];
+    layer->track_joints.resize(clip->tracks.size());
+    bool is_bound = false;
+    for (size_t i = 0; i < clip->tracks.size(); ++i) {
+        layer->track_joints[i] = find_skeleton_joint(skeleton, clip->tracks[i].node);
+        is_bound = is_bound || layer->track_joints[i] >= 0;
+    }
+    if (!is_bound) { return -1; }
+
+    layer->clip_index = clip_index;
+    layer->time = 0.0f;
+    layer->speed = 1.0f;
+    layer->weight = weight;
+    layer->cursors.assign(clip->tracks.size(), 0);
+    return instance->layer_count++;
+}
+
+void animation_system_sync(AnimationSystem *animation_system, const Geometry *geometry) {
+    for (uint32_t skin_index = animation_system->skeletons.size(); skin_index < geometry->skins.size(); ++skin_index) {
+        animation_system->skeletons.emplace_back();
+        Skeleton *skeleton = &animation_system->skeletons.back();
+        build_skeleton(&geometry->transform_hierarchy, &geometry->skins[skin_index], skeleton);
+
+        animation_system->instances.emplace_back();
+        AnimationInstance *instance = &animation_system->instances.back();
+        instance->skeleton_index = skin_index;
+        instance->layer_count = 0;
+        instance->skin_matrices.resize(skeleton->skin_joints.size(), glm::mat4(1.0f));
+        for (uint32_t clip_index = 0; clip_index < geometry->animations.size() && instance->layer_count == 0; ++clip_index) {
+            add_animation_layer(instance, skeleton, geometry, clip_index, 1.0f);
+        }
+        log_info("skeleton %u: %u joints, %zu skin joints, %s", skin_index, skeleton->joint_count, skeleton->skin_joints.size(),
+                 instance->layer_count > 0 ? "animated" : "no animation");
+    }
+}
+
+// 为一层的每个关节解码前后两个关键帧，没有轨道的分量两帧都为静止姿态
+static void sample_layer_keys(const AnimationClip *clip, const Skeleton *skeleton, AnimationLayer *layer, AnimationWorkspace *workspace) {
+    copy_pose(&skeleton->rest_pose, &workspace->keys[0]);
+    copy_pose(&skeleton->rest_pose, &workspace->keys[1]);
+    for (uint32_t i = 0; i < ANIMATION_TRACK_TYPE_COUNT; ++i) { workspace->alphas[i].assign(skeleton->padded_joint_count, 0.0f); }
+
+    float frame = layer->time * ANIMATION_SAMPLE_RATE;
+    for (size_t track_index = 0; track_index < clip->tracks.size(); ++track_index) {
+        int32_t joint = layer->track_joints[track_index];
+        if (joint < 0) { continue; }
+
+        const AnimationTrack *track = &clip->tracks[track_index];
+        const AnimationKey *keys = &clip->keys[track->first_key];
+        uint32_t cursor = layer->cursors[track_index];
+        if (cursor >= track->key_count || keys[cursor].frame > frame) { cursor = 0; } // 时间回绕或倒放
+        while (cursor + 1 < track->key_count && keys[cursor + 1].frame <= frame) { ++cursor; }
+        layer->cursors[track_index] = cursor;
+
+        const AnimationKey *key0 = &keys[cursor];
+        const AnimationKey *key1 = &keys[std::min(cursor + 1, track->key_count - 1)];
+        float alpha = key1->frame > key0->frame ? std::clamp((frame - key0->frame) / (key1->frame - key0->frame), 0.0f, 1.0f) : 0.0f;
+        workspace->alphas[track->type][joint] = alpha;
+
+        float values[2][4];
+        if (track->type == ANIMATION_TRACK_ROTATION) {
+            decode_rotation_key(key0, values[0]);
+            decode_rotation_key(key1, values[1]);
+            for (uint32_t k = 0; k < 2; ++k) {
+                for (uint32_t i = 0; i < 4; ++i) { workspace->keys[k].rotations[i][joint] = values[k][i]; }
+            }
+        } else {
+            decode_vector_key(track, key0, values[0]);
+            decode_vector_key(track, key1, values[1]);
+            for (uint32_t k = 0; k < 2; ++k) {
+                std::vector<float> *components = track->type == ANIMATION_TRACK_TRANSLATION ? workspace->keys[k].translations : workspace->keys[k].scales;
+                for (uint32_t i = 0; i < 3; ++i) { components[i][joint] = values[k][i]; }
+            }
+        }
+    }
+}
+
+// 插值一层并按权重累加到混合姿态：translation 与 scale 线性插值，rotation 为 nlerp，累加前翻转到与已累加的结果同一半球
+// `weight` 已除以各层的总权重，累加后 translation 与 scale 即为加权平均；`is_last` 时归一化四元数
+static void accumulate_joint(AnimationWorkspace *workspace, uint32_t i, float weight, bool is_first, bool is_last) {
+    AnimationPose *key0 = &workspace->keys[0], *key1 = &workspace->keys[1], *blended = &workspace->blended_pose;
+
+    for (uint32_t c = 0; c < 3; ++c) {
+        float translation = key0->translations[c][i] + (key1->translations[c][i] - key0->translations[c][i]) * workspace->alphas[ANIMATION_TRACK_TRANSLATION][i];
+        float scale = key0->scales[c][i] + (key1->scales[c][i] - key0->scales[c][i]) * workspace->alphas[ANIMATION_TRACK_SCALE][i];
+        blended->translations[c][i] = (is_first ? 0.0f : blended->translations[c][i]) + translation * weight;
+        blended->scales[c][i] = (is_first ? 0.0f : blended->scales[c][i]) + scale * weight;
+    }
+
+    float q0[4], q1[4], rotation[4];
+    float dot = 0.0f;
+    for (uint32_t c = 0; c < 4; ++c) {
+        q0[c] = key0->rotations[c][i];
+        q1[c] = key1->rotations[c][i];
+        dot += q0[c] * q1[c];
+    }
+    float length_squared = 0.0f;
+    for (uint32_t c = 0; c < 4; ++c) {
+        rotation[c] = q0[c] + ((dot < 0.0f ? -q1[c] : q1[c]) - q0[c]) * workspace->alphas[ANIMATION_TRACK_ROTATION][i];
+        length_squared += rotation[c] * rotation[c];
+    }
+    float blended_dot = 0.0f;
+    for (uint32_t c = 0; c < 4; ++c) { blended_dot += (is_first ? 0.0f : blended->rotations[c][i]) * rotation[c]; }
+    float rotation_weight = (blended_dot < 0.0f ? -weight : weight) / std::sqrt(length_squared);
+    float blended_length_squared = 0.0f;
+    for (uint32_t c = 0; c < 4; ++c) {
+        blended->rotations[c][i] = (is_first ? 0.0f : blended->rotations[c][i]) + rotation[c] * rotation_weight;
+        blended_length_squared += blended->rotations[c][i] * blended->rotations[c][i];
+    }
+    if (is_last) {
+        float inverse_length = 1.0f / std::sqrt(blended_length_squared);
+        for (uint32_t c = 0; c < 4; ++c) { blended->rotations[c][i] *= inverse_length; }
+    }
+}
+
+#if ANIMATION_SSE2
+static inline __m128 dot4_sse2(const __m128 a[4], const __m128 b[4]) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3])));
+}
+
+// 每次处理 4 个关节，与 accumulate_joint 相同，符号翻转以与符号位异或实现
+static uint32_t accumulate_layer_sse2(AnimationWorkspace *workspace, uint32_t begin, uint32_t end, float weight, bool is_first, bool is_last) {
+    AnimationPose *key0 = &workspace->keys[0], *key1 = &workspace->keys[1], *blended = &workspace->blended_pose;
+    const __m128 weights = _mm_set1_ps(weight), zero = _mm_setzero_ps(), sign_bit = _mm_set1_ps(-0.0f);
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 translation_alpha = _mm_loadu_ps(&workspace->alphas[ANIMATION_TRACK_TRANSLATION][i]);
+        __m128 scale_alpha = _mm_loadu_ps(&workspace->alphas[ANIMATION_TRACK_SCALE][i]);
+        for (uint32_t c = 0; c < 3; ++c) {
+            __m128 t0 = _mm_loadu_ps(&key0->translations[c][i]), t1 = _mm_loadu_ps(&key1->translations[c][i]);
+            __m128 s0 = _mm_loadu_ps(&key0->scales[c][i]), s1 = _mm_loadu_ps(&key1->scales[c][i]);
+            __m128 translation = _mm_mul_ps(_mm_add_ps(t0, _mm_mul_ps(_mm_sub_ps(t1, t0), translation_alpha)), weights);
+            __m128 scale = _mm_mul_ps(_mm_add_ps(s0, _mm_mul_ps(_mm_sub_ps(s1, s0), scale_alpha)), weights);
+            if (!is_first) {
+                translation = _mm_add_ps(translation, _mm_loadu_ps(&blended->translations[c][i]));
+                scale = _mm_add_ps(scale, _mm_loadu_ps(&blended->scales[c][i]));
+            }
+            _mm_storeu_ps(&blended->translations[c][i], translation);
+            _mm_storeu_ps(&blended->scales[c][i], scale);
+        }
+
+        __m128 q0[4], q1[4], rotation[4], accumulated[4];
+        for (uint32_t c = 0; c < 4; ++c) {
+            q0[c] = _mm_loadu_ps(&key0->rotations[c][i]);
+            q1[c] = _mm_loadu_ps(&key1->rotations[c][i]);
+            accumulated[c] = is_first ? zero : _mm_loadu_ps(&blended->rotations[c][i]);
+        }
+        __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot4_sse2(q0, q1), zero), sign_bit);
+        __m128 rotation_alpha = _mm_loadu_ps(&workspace->alphas[ANIMATION_TRACK_ROTATION][i]);
+        for (uint32_t c = 0; c < 4; ++c) { rotation[c] = _mm_add_ps(q0[c], _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(q1[c], flip), q0[c]), rotation_alpha)); }
+
+        __m128 blended_flip = _mm_and_ps(_mm_cmplt_ps(dot4_sse2(accumulated, rotation), zero), sign_bit);
+        __m128 rotation_weight = _mm_xor_ps(_mm_div_ps(weights, _mm_sqrt_ps(dot4_sse2(rotation, rotation))), blended_flip);
+        for (uint32_t c = 0; c < 4; ++c) { accumulated[c] = _mm_add_ps(accumulated[c], _mm_mul_ps(rotation[c], rotation_weight)); }
+        if (is_last) {
+            __m128 inverse_length = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(dot4_sse2(accumulated, accumulated)));
+            for (uint32_t c = 0; c < 4; ++c) { accumulated[c] = _mm_mul_ps(accumulated[c], inverse_length); }
+        }
+        for (uint32_t c = 0; c < 4; ++c) { _mm_storeu_ps(&blended->rotations[c][i], accumulated[c]); }
+    }
+    return i;
+}
+#endif
+
+#if ANIMATION_AVX2
+static inline __m256 dot4_avx2(const __m256 a[4], const __m256 b[4]) {
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[0], b[0]), _mm256_mul_ps(a[1], b[1])),
+                         _mm256_add_ps(_mm256_mul_ps(a[2], b[2]), _mm256_mul_ps(a[3], b[3])));
+}
+
+// 每次处理 8 个关节
+static uint32_t accumulate_layer_avx2(AnimationWorkspace *workspace, uint32_t begin, uint32_t end, float weight, bool is_first, bool is_last) {
+    AnimationPose *key0 = &workspace->keys[0], *key1 = &workspace->keys[1], *blended = &workspace->blended_pose;
+    const __m256 weights = _mm256_set1_ps(weight), zero = _mm256_setzero_ps(), sign_bit = _mm256_set1_ps(-0.0f);
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 translation_alpha = _mm256_loadu_ps(&workspace->alphas[ANIMATION_TRACK_TRANSLATION][i]);
+        __m256 scale_alpha = _mm256_loadu_ps(&workspace->alphas[ANIMATION_TRACK_SCALE][i]);
+        for (uint32_t c = 0; c < 3; ++c) {
+            __m256 t0 = _mm256_loadu_ps(&key0->translations[c][i]), t1 = _mm256_loadu_ps(&key1->translations[c][i]);
+            __m256 s0 = _mm256_loadu_ps(&key0->scales[c][i]), s1 = _mm256_loadu_ps(&key1->scales[c][i]);
+            __m256 translation = _mm256_mul_ps(_mm256_add_ps(t0, _mm256_mul_ps(_mm256_sub_ps(t1, t0), translation_alpha)), weights);
+            __m256 scale = _mm256_mul_ps(_mm256_add_ps(s0, _mm256_mul_ps(_mm256_sub_ps(s1, s0), scale_alpha)), weights);
+            if (!is_first) {
+                translation = _mm256_add_ps(translation, _mm256_loadu_ps(&blended->translations[c][i]));
+                scale = _mm256_add_ps(scale, _mm256_loadu_ps(&blended->scales[c][i]));
+            }
+            _mm256_storeu_ps(&blended->translations[c][i], translation);
+            _mm256_storeu_ps(&blended->scales[c][i], scale);
+        }
+
+        __m256 q0[4], q1[4], rotation[4], accumulated[4];
+        for (uint32_t c = 0; c < 4; ++c) {
+            q0[c] = _mm256_loadu_ps(&key0->rotations[c][i]);
+            q1[c] = _mm256_loadu_ps(&key1->rotations[c][i]);
+            accumulated[c] = is_first ? zero : _mm256_loadu_ps(&blended->rotations[c][i]);
+        }
+        __m256 flip = _mm256_and_ps(_mm256_cmp_ps(dot4_avx2(q0, q1), zero, _CMP_LT_OQ), sign_bit);
+        __m256 rotation_alpha = _mm256_loadu_ps(&workspace->alphas[ANIMATION_TRACK_ROTATION][i]);
+        for (uint32_t c = 0; c < 4; ++c) {
+            rotation[c] = _mm256_add_ps(q0[c], _mm256_mul_ps(_mm256_sub_ps(_mm256_xor_ps(q1[c], flip), q0[c]), rotation_alpha));
+        }
+
+        __m256 blended_flip = _mm256_and_ps(_mm256_cmp_ps(dot4_avx2(accumulated, rotation), zero, _CMP_LT_OQ), sign_bit);
+        __m256 rotation_weight = _mm256_xor_ps(_mm256_div_ps(weights, _mm256_sqrt_ps(dot4_avx2(rotation, rotation))), blended_flip);
+        for (uint32_t c = 0; c < 4; ++c) { accumulated[c] = _mm256_add_ps(accumulated[c], _mm256_mul_ps(rotation[c], rotation_weight)); }
+        if (is_last) {
+            __m256 inverse_length = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(dot4_avx2(accumulated, accumulated)));
+            for (uint32_t c = 0; c < 4; ++c) { accumulated[c] = _mm256_mul_ps(accumulated[c], inverse_length); }
+        }
+        for (uint32_t c = 0; c < 4; ++c) { _mm256_storeu_ps(&blended->rotations[c][i], accumulated[c]); }
+    }
+    return i;
+}
+#endif
+
+static void accumulate_layer(AnimationWorkspace *workspace, uint32_t joint_count, float weight, bool is_first, bool is_last) {
+    uint32_t i = 0;
+#if ANIMATION_AVX2
+    i = accumulate_layer_avx2(workspace, i, joint_count, weight, is_first, is_last);
+#endif
+#if ANIMATION_SSE2
+    i = accumulate_layer_sse2(workspace, i, joint_count, weight, is_first, is_last);
+#endif
+    for (; i < joint_count; ++i) { accumulate_joint(workspace, i, weight, is_first, is_last); }
+}
+
+// 采样并混合所有层，计算关节的世界矩阵与蒙皮矩阵；只读取 Geometry，可在工作线程上执行
+static void evaluate_instance(const Skeleton *skeleton, const Geometry *geometry, AnimationInstance *instance, AnimationWorkspace *workspace) {
+    const uint32_t joint_count = skeleton->padded_joint_count;
+    resize_pose(&workspace->keys[0], joint_count);
+    resize_pose(&workspace->keys[1], joint_count);
+    resize_pose(&workspace->blended_pose, joint_count);
+    workspace->local_matrices.resize(joint_count);
+    workspace->world_matrices.resize(joint_count);
+
+    float total_weight = 0.0f;
+    uint32_t last_layer = 0;
+    for (uint32_t i = 0; i < instance->layer_count; ++i) {
+        if (instance->layers[i].weight <= 0.0f) { continue; }
+        total_weight += instance->layers[i].weight;
+        last_layer = i;
+    }
+
+    if (total_weight > 0.0f) {
+        bool is_first = true;
+        for (uint32_t i = 0; i <= last_layer; ++i) {
+            AnimationLayer *layer = &instance->layers[i];
+            if (layer->weight <= 0.0f) { continue; }
+            sample_layer_keys(&geometry->animations[layer->clip_index], skeleton, layer, workspace);
+            accumulate_layer(workspace, joint_count, layer->weight / total_weight, is_first, i == last_layer);
+            is_first = false;
+        }
+    } else {
+        copy_pose(&skeleton->rest_pose, &workspace->blended_pose);
+    }
+
+    const AnimationPose *pose = &workspace->blended_pose;
+    TransformComponents components;
+    for (uint32_t i = 0; i < 3; ++i) { components.translations[i] = pose->translations[i].data(); }
+    for (uint32_t i = 0; i < 4; ++i) { components.rotations[i] = pose->rotations[i].data(); }
+    for (uint32_t i = 0; i < 3; ++i) { components.scales[i] = pose->scales[i].data(); }
+    compose_transform_matrices(&components, 0, skeleton->joint_count, workspace->local_matrices.data());
+
+    const std::vector<glm::mat4> &node_world_matrices = geometry->transform_hierarchy.world_matrices;
+    for (uint32_t i = 0; i < skeleton->joint_count; ++i) {
+        int32_t parent = skeleton->parents[i], parent_node = skeleton->parent_nodes[i];
+        if (parent >= 0) {
+            multiply_transform_matrices(workspace->world_matrices[parent], workspace->local_matrices[i], &workspace->world_matrices[i]);
+        } else if (parent_node >= 0) {
+            multiply_transform_matrices(node_world_matrices[parent_node], workspace->local_matrices[i], &workspace->world_matrices[i]);
+        } else {
+            workspace->world_matrices[i] = workspace->local_matrices[i];
+        }
+    }
+
+    for (size_t i = 0; i < skeleton->skin_joints.size(); ++i) {
+        multiply_transform_matrices(workspace->world_matrices[skeleton->skin_joints[i]], skeleton->inverse_bind_matrices[i], &instance->skin_matrices[i]);
+    }
+}
+
+// 实例按连续的区间分给各任务，每个任务使用独立的 workspace
+static void evaluate_instances(ThreadPool *thread_pool, std::vector<AnimationWorkspace> *workspaces, const std::vector<Skeleton> &skeletons,
+                               const Geometry *geometry, AnimationInstance **instances, uint32_t instance_count) {
+    if (instance_count == 0) { return; }
+    uint32_t max_job_count = (thread_pool_worker_count(thread_pool) + 1) * ANIMATION_JOBS_PER_THREAD;
+    uint32_t job_count = std::min(max_job_count, (instance_count + ANIMATION_INSTANCES_PER_JOB - 1) / ANIMATION_INSTANCES_PER_JOB);
+    if (workspaces->size() < job_count) { workspaces->resize(job_count); }
+
+    uint32_t instances_per_job = (instance_count + job_count - 1) / job_count;
+    thread_pool_parallel_for(thread_pool, job_count, [&](uint32_t job_index) {
+        uint32_t begin = job_index * instances_per_job, end = std::min(begin + instances_per_job, instance_count);
+        for (uint32_t i = begin; i < end; ++i) {
+            evaluate_instance(&skeletons[instances[i]->skeleton_index], geometry, instances[i], &(*workspaces)[job_index]);
+        }
+    });
+}
+
+// 循环播放，倒放时从末尾回绕
+static void advance_instance_time(const Geometry *geometry, AnimationInstance *instance, float delta_seconds) {
+    for (uint32_t i = 0; i < instance->layer_count; ++i) {
+        AnimationLayer *layer = &instance->layers[i];
+        float duration = geometry->animations[layer->clip_index].duration;
+        if (duration <= 0.0f) { continue; }
+        layer->time = std::fmod(layer->time + delta_seconds * layer->speed, duration);
+        if (layer->time < 0.0f) { layer->time += duration; }
+    }
+}
+
+void animation_system_update(AnimationSystem *animation_system, const Geometry *geometry, float delta_seconds) {
+    uint64_t start_time = timer_now_ns();
+
+    std::vector<AnimationInstance *> instances;
+    uint32_t joint_count = 0;
+    for (AnimationInstance &instance: animation_system->instances) {
+        if (instance.layer_count == 0) { continue; }
+        advance_instance_time(geometry, &instance, delta_seconds);
+        instances.push_back(&instance);
+        joint_count += animation_system->skeletons[instance.skeleton_index].joint_count;
+    }
+    evaluate_instances(animation_system->thread_pool, &animation_system->workspaces, animation_system->skeletons, geometry, instances.data(),
+                       instances.size());
+
+    animation_system->stats.instance_count = instances.size();
+    animation_system->stats.joint_count = joint_count;
+    animation_system->stats.update_ms = timer_elapsed_ms(start_time);
+}
+
+const std::vector<glm::mat4> *get_animated_skin_matrices(const AnimationSystem *animation_system, uint32_t skin_index) {
+    if (skin_index >= animation_system->instances.size() || animation_system->instances[skin_index].layer_count == 0) { return nullptr; }
+    return &animation_system->instances[skin_index].skin_matrices;
+}
+
+void animation_benchmark(AnimationSystem *animation_system, const Geometry *geometry, uint32_t skin_index, uint32_t instance_count, uint32_t iteration_count) {
+    ASSERT(skin_index < animation_system->skeletons.size());
+    const Skeleton *skeleton = &animation_system->skeletons[skin_index];
+
+    std::vector<AnimationInstance> instances(instance_count);
+    std::vector<AnimationInstance *> instance_pointers(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i) {
+        AnimationInstance *instance = &instances[i];
+        instance->skeleton_index = skin_index;
+        instance->layer_count = 0;
+        instance->skin_matrices.resize(skeleton->skin_joints.size());
+        for (uint32_t clip_index = 0; clip_index < geometry->animations.size() && instance->layer_count < 2; ++clip_index) {
+            int32_t layer_index = add_animation_layer(instance, skeleton, geometry, clip_index, 0.5f);
+            if (layer_index >= 0) { instance->layers[layer_index].time = std::fmod(i * 0.173f, std::max(geometry->animations[clip_index].duration, 1e-3f)); }
+        }
+        instance_pointers[i] = instance;
+    }
+    if (instance_count == 0 || instances[0].layer_count == 0) {
+        log_warning("animation benchmark skipped, no animation affects skeleton %u", skin_index);
+        return;
+    }
+
+    double skeletons_per_ms[2];
+    ThreadPool *thread_pools[2] = {nullptr, animation_system->thread_pool};
+    for (uint32_t mode = 0; mode < 2; ++mode) {
+        uint64_t start_time = timer_now_ns();
+        for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) {
+            for (AnimationInstance &instance: instances) { advance_instance_time(geometry, &instance, 1.0f / 60.0f); }
+            evaluate_instances(thread_pools[mode], &animation_system->workspaces, animation_system->skeletons, geometry, instance_pointers.data(),
+                               instance_count);
+        }
+        double elapsed_ms = timer_elapsed_ms(start_time);
+        skeletons_per_ms[mode] = elapsed_ms > 0.0 ? (double) instance_count * iteration_count / elapsed_ms : 0.0;
+    }
+
+    log_info("animation benchmark: %u skeletons x %u joints, %u layers, %u iterations, %.1f skeletons/ms on 1 thread, %.1f skeletons/ms on %u threads, %s",
+             instance_count, skeleton->joint_count, instances[0].layer_count, iteration_count, skeletons_per_ms[0], skeletons_per_ms[1],
+             thread_pool_worker_count(animation_system->thread_pool) + 1, animation_simd_name());
+}
+
+const char *animation_simd_name() {
+#if ANIMATION_AVX2
+    return "avx2";
+#elif ANIMATION_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "animation_clip.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+struct Geometry;
+struct ThreadPool;
+
+#define ANIMATION_MAX_LAYERS 4
+#define ANIMATION_JOINT_ALIGNMENT 8 // 姿态按 8 个关节对齐，SIMD 一次处理一组关节，无需处理尾部
+
+// 一组关节的局部变换，按分量以 SoA 存放，长度为 Skeleton::padded_joint_count
+struct AnimationPose {
+    std::vector<float> translations[3];
+    std::vector<float> rotations[4]; // 四元数 x, y, z, w
+    std::vector<float> scales[3];
+};
+
+// 由 Skin 构建的骨骼：关节以及关节之间的非关节节点，按节点层级中的先序排列，父节点在前
+struct Skeleton {
+    uint32_t joint_count;
+    uint32_t padded_joint_count;
+    std::vector<uint32_t> nodes;       // 在 Geometry::transform_hierarchy 中的下标
+    std::vector<int32_t> parents;      // 骨骼内的父关节，-1 时父节点为 parent_nodes 中的节点
+    std::vector<int32_t> parent_nodes; // 根关节在节点层级中的父节点，没有时为 -1，其世界矩阵不受动画影响
+    std::vector<uint32_t> skin_joints; // Skin 的第 i 个关节在骨骼中的下标
+    std::vector<glm::mat4> inverse_bind_matrices; // 按 Skin 的关节顺序
+    AnimationPose rest_pose; // 没有轨道的关节与分量保持节点层级中的局部变换
+};
+
+// 一个正在播放的 clip，多层按权重混合
+struct AnimationLayer {
+    uint32_t clip_index; // 在 Geometry::animations 中的下标
+    float time;
+    float speed;
+    float weight;
+    std::vector<int32_t> track_joints; // clip 的每条轨道在骨骼中的关节，-1 为不影响该骨骼
+    std::vector<uint32_t> cursors;     // 每条轨道上次采样的关键帧，相对于 first_key，时间前进时由此向后查找
+};
+
+struct AnimationInstance {
+    uint32_t skeleton_index;
+    uint32_t layer_count;
+    AnimationLayer layers[ANIMATION_MAX_LAYERS];
+    std::vector<glm::mat4> skin_matrices; // 世界空间的关节矩阵 * inverse bind matrix，按 Skin 的关节顺序
+};
+
+// 每个任务独占的中间结果
+struct AnimationWorkspace {
+    AnimationPose keys[2];                                 // 每个关节前后两个关键帧
+    std::vector<float> alphas[ANIMATION_TRACK_TYPE_COUNT]; // 每个关节各分量在两个关键帧之间的位置
+    AnimationPose blended_pose;
+    std::vector<glm::mat4> local_matrices;
+    std::vector<glm::mat4> world_matrices;
+};
+
+struct AnimationStats {
+    uint32_t instance_count;
+    uint32_t joint_count;
+    double update_ms;
+};
+
+// Geometry::skins 的第 i 个对应 skeletons[i] 与 instances[i]，instances 只在 layer_count > 0 时有效
+struct AnimationSystem {
+    ThreadPool *thread_pool;
+    std::vector<Skeleton> skeletons;
+    std::vector<AnimationInstance> instances;
+    std::vector<AnimationWorkspace> workspaces;
+    AnimationStats stats;
+};
+
+void animation_system_create(ThreadPool *thread_pool, AnimationSystem **out_animation_system);
+
+void animation_system_destroy(AnimationSystem *animation_system);
+
+// 为新追加的 skin 构建骨骼，并播放第一个作用于该骨骼的 clip；需在节点层级更新之后调用
+void animation_system_sync(AnimationSystem *animation_system, const Geometry *geometry);
+
+// 将 clip 加入实例的混合层，超过 ANIMATION_MAX_LAYERS 时忽略，返回层的下标或 -1
+int32_t add_animation_layer(AnimationInstance *instance, const Skeleton *skeleton, const Geometry *geometry, uint32_t clip_index, float weight);
+
+// 推进所有实例的时间，按实例并行采样、混合并计算蒙皮矩阵，需在节点层级更新之后调用
+void animation_system_update(AnimationSystem *animation_system, const Geometry *geometry, float delta_seconds);
+
+// 实例没有播放动画时返回 nullptr，蒙皮矩阵按节点层级中的关节世界矩阵计算
+const std::vector<glm::mat4> *get_animated_skin_matrices(const AnimationSystem *animation_system, uint32_t skin_index);
+
+// 以第 `skin_index` 个骨骼构造 `instance_count` 个实例，混合至多两个 clip，分别单线程与并行更新 `iteration_count` 次，输出每毫秒可计算的骨骼数
+void animation_benchmark(AnimationSystem *animation_system, const Geometry *geometry, uint32_t skin_index, uint32_t instance_count, uint32_t iteration_count);
+
+// 编译时启用的指令集，用于日志输出
+const char *animation_simd_name();
@@ -0,0 +1,177 @@
+#include "animation_clip.h"
+#include "core/logging.h"
+#include <glm/gtc/quaternion.hpp>
+
+#define ANIMATION_MAX_FRAME 65535
+#define ANIMATION_VECTOR_TOLERANCE 2e-4f   // translation 与 scale 的插值误差容差，相对于轨道范围
+#define ANIMATION_ROTATION_TOLERANCE 1e-3f // rotation 的插值误差容差，弧度
+
+static glm::quat to_quat(const glm::vec4 &value) { return glm::quat(value.w, value.x, value.y, value.z); }
+
+static glm::vec4 get_raw_value(const RawAnimationTrack *track, size_t key_index) {
+    return track->interpolation == ANIMATION_INTERPOLATION_CUBIC_SPLINE ? track->values[key_index * 3 + 1] : track->values[key_index];
+}
+
+// 按 glTF 的插值方式求原始轨道在 `time` 处的值，超出范围时取两端的值
+static glm::vec4 sample_raw_track(const RawAnimationTrack *track, float time) {
+    const std::vector<float> &times = track->times;
+    if (time <= times.front()) { return get_raw_value(track, 0); }
+    if (time >= times.back()) { return get_raw_value(track, times.size() - 1); }
+
+    size_t key_index = std::upper_bound(times.begin(), times.end(), time) - times.begin() - 1;
+    float delta = times[key_index + 1] - times[key_index];
+    float u = delta > 0.0f ? (time - times[key_index]) / delta : 0.0f;
+    glm::vec4 value0 = get_raw_value(track, key_index), value1 = get_raw_value(track, key_index + 1);
+
+    switch (track->interpolation) {
+        case ANIMATION_INTERPOLATION_STEP: return value0;
+        case ANIMATION_INTERPOLATION_LINEAR: {
+            if (track->type != ANIMATION_TRACK_ROTATION) { return glm::mix(value0, value1, u); }
+            glm::quat rotation = glm::slerp(to_quat(value0), to_quat(value1), u);
+            return glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+        }
+        case ANIMATION_INTERPOLATION_CUBIC_SPLINE: {
+            glm::vec4 out_tangent = track->values[key_index * 3 + 2] * delta, in_tangent = track->values[(key_index + 1) * 3] * delta;
+            float u2 = u * u, u3 = u2 * u;
+            glm::vec4 value = (2.0f * u3 - 3.0f * u2 + 1.0f) * value0 + (u3 - 2.0f * u2 + u) * out_tangent + (-2.0f * u3 + 3.0f * u2) * value1 +
+                              (u3 - u2) * in_tangent;
+            return track->type == ANIMATION_TRACK_ROTATION ? glm::normalize(value) : value;
+        }
+        default: return value0;
+    }
+}
+
+// 与运行时的采样一致：translation 与 scale 线性插值，rotation 为 nlerp
+static glm::vec4 interpolate(AnimationTrackType type, const glm::vec4 &value0, const glm::vec4 &value1, float u) {
+    if (type != ANIMATION_TRACK_ROTATION) { return glm::mix(value0, value1, u); }
+    return glm::normalize(glm::mix(value0, glm::dot(value0, value1) < 0.0f ? -value1 : value1, u));
+}
+
+static bool is_within_tolerance(AnimationTrackType type, const glm::vec4 &value, const glm::vec4 &expected, float tolerance) {
+    if (type == ANIMATION_TRACK_ROTATION) { return std::abs(glm::dot(value, expected)) >= std::cos(tolerance * 0.5f); }
+    glm::vec3 delta = glm::abs(glm::vec3(value) - glm::vec3(expected));
+    return std::max(delta.x, std::max(delta.y, delta.z)) <= tolerance;
+}
+
+// 贪心地延长每一段，直到段内某个采样无法由两端插值得到，保留的帧号递增且包含首尾
+static void reduce_keys(AnimationTrackType type, const std::vector<glm::vec4> &samples, float tolerance, std::vector<uint32_t> *kept_frames) {
+    kept_frames->clear();
+    uint32_t frame_count = samples.size();
+
+    bool is_constant = true;
+    for (uint32_t i = 1; i < frame_count && is_constant; ++i) { is_constant = is_within_tolerance(type, samples[i], samples[0], tolerance); }
+    kept_frames->push_back(0);
+    if (is_constant) { return; }
+
+    uint32_t begin = 0;
+    for (uint32_t end = begin + 2; end < frame_count; ++end) {
+        bool is_reducible = true;
+        for (uint32_t i = begin + 1; i < end && is_reducible; ++i) {
+            float u = (float) (i - begin) / (end - begin);
+            is_reducible = is_within_tolerance(type, interpolate(type, samples[begin], samples[end], u), samples[i], tolerance);
+        }
+        if (!is_reducible) {
+            begin = end - 1;
+            kept_frames->push_back(begin);
+        }
+    }
+    kept_frames->push_back(frame_count - 1);
+}
+
+static AnimationKey encode_rotation_key(uint32_t frame, glm::vec4 rotation) {
+    rotation = glm::normalize(rotation);
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; ++i) {
+        if (std::abs(rotation[i]) > std::abs(rotation[largest])) { largest = i; }
+    }
+    if (rotation[largest] < 0.0f) { rotation = -rotation; }
+
+    AnimationKey key{};
+    key.frame = frame;
+    for (uint32_t i = 0, j = 0; i < 4; ++i) {
+        if (i == largest) { continue; }
+        float normalized = (std::clamp(rotation[i], -ANIMATION_ROTATION_RANGE, ANIMATION_ROTATION_RANGE) + ANIMATION_ROTATION_RANGE) /
+                           (2.0f * ANIMATION_ROTATION_RANGE);
+        key.values[j++] = (uint16_t) std::lround(normalized * 32767.0f);
+    }
+    key.values[0] |= (largest >> 1) << 15;
+    key.values[1] |= (largest & 1) << 15;
+    return key;
+}
+
+static AnimationKey encode_vector_key(const AnimationTrack *track, uint32_t frame, const glm::vec4 &value) {
+    AnimationKey key{};
+    key.frame = frame;
+    for (uint32_t i = 0; i < 3; ++i) {
+        float normalized = track->range_extent[i] > 0.0f ? (value[i] - track->range_min[i]) / track->range_extent[i] : 0.0f;
+        key.values[i] = (uint16_t) std::lround(std::clamp(normalized, 0.0f, 1.0f) * 65535.0f);
+    }
+    return key;
+}
+
+void compress_animation_clip(const std::vector<RawAnimationTrack> &raw_tracks, AnimationClip *clip, AnimationCompressStats *stats) {
+    *stats = {};
+    clip->tracks.clear();
+    clip->keys.clear();
+
+    float duration = 0.0f;
+    for (const RawAnimationTrack &raw_track: raw_tracks) { duration = std::max(duration, raw_track.times.back()); }
+    uint32_t frame_count = (uint32_t) std::ceil(duration * ANIMATION_SAMPLE_RATE) + 1;
+    if (frame_count > ANIMATION_MAX_FRAME + 1) {
+        log_warning("animation of %.2f s exceeds %u frames, truncated", duration, ANIMATION_MAX_FRAME);
+        frame_count = ANIMATION_MAX_FRAME + 1;
+    }
+    clip->duration = (frame_count - 1) / ANIMATION_SAMPLE_RATE;
+
+    std::vector<glm::vec4> samples(frame_count);
+    std::vector<uint32_t> kept_frames;
+    for (const RawAnimationTrack &raw_track: raw_tracks) {
+        for (uint32_t frame = 0; frame < frame_count; ++frame) {
+            samples[frame] = sample_raw_track(&raw_track, std::min(frame / ANIMATION_SAMPLE_RATE, duration));
+            // 相邻的四元数取同一半球，插值沿最短路径，去除关键帧时的判断与运行时一致
+            if (raw_track.type == ANIMATION_TRACK_ROTATION && frame > 0 && glm::dot(samples[frame], samples[frame - 1]) < 0.0f) {
+                samples[frame] = -samples[frame];
+            }
+        }
+
+        AnimationTrack track{};
+        track.node = raw_track.node;
+        track.type = raw_track.type;
+        float tolerance = ANIMATION_ROTATION_TOLERANCE;
+        if (raw_track.type != ANIMATION_TRACK_ROTATION) {
+            glm::vec3 min_value = glm::vec3(samples[0]), max_value = glm::vec3(samples[0]);
+            for (const glm::vec4 &sample: samples) {
+                min_value = glm::min(min_value, glm::vec3(sample));
+                max_value = glm::max(max_value, glm::vec3(sample));
+            }
+            glm::vec3 extent = max_value - min_value;
+            for (uint32_t i = 0; i < 3; ++i) {
+                track.range_min[i] = min_value[i];
+                track.range_extent[i] = extent[i];
+            }
+            tolerance = std::max(std::max(extent.x, std::max(extent.y, extent.z)) * ANIMATION_VECTOR_TOLERANCE, 1e-6f);
+        }
+
+        reduce_keys(raw_track.type, samples, tolerance, &kept_frames);
+        track.first_key = clip->keys.size();
+        track.key_count = kept_frames.size();
+        for (uint32_t frame: kept_frames) {
+            clip->keys.push_back(raw_track.type == ANIMATION_TRACK_ROTATION ? encode_rotation_key(frame, samples[frame])
+                                                                             : encode_vector_key(&track, frame, samples[frame]));
+        }
+        clip->tracks.push_back(track);
+
+        uint32_t component_count = raw_track.type == ANIMATION_TRACK_ROTATION ? 4 : 3;
+        stats->raw_key_count += frame_count;
+        stats->key_count += kept_frames.size();
+        stats->raw_bytes += frame_count * (component_count + 1) * sizeof(float);
+        stats->compressed_bytes += sizeof(AnimationTrack) + kept_frames.size() * sizeof(AnimationKey);
+    }
+}
+
+void accumulate_animation_compress_stats(AnimationCompressStats *total, const AnimationCompressStats *stats) {
+    total->raw_key_count += stats->raw_key_count;
+    total->key_count += stats->key_count;
+    total->raw_bytes += stats->raw_bytes;
+    total->compressed_bytes += stats->compressed_bytes;
+}
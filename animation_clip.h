@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#define ANIMATION_SAMPLE_RATE 30.0f         // 关键帧时间量化为该帧率下的帧号
+#define ANIMATION_ROTATION_RANGE 0.70710678f // smallest three 中其余分量的绝对值不超过 1/sqrt(2)
+
+enum AnimationTrackType : uint32_t {
+    ANIMATION_TRACK_TRANSLATION,
+    ANIMATION_TRACK_ROTATION,
+    ANIMATION_TRACK_SCALE,
+    ANIMATION_TRACK_TYPE_COUNT,
+};
+
+// 压缩的关键帧，8 字节：帧号 + 3 个 u16
+// rotation 为 smallest three：丢弃绝对值最大的分量（取正号后由其余分量恢复），其余分量量化为 15 位，丢弃分量的下标存放在前两个值的最高位
+// translation 与 scale 为轨道范围内量化的 unorm16
+struct AnimationKey {
+    uint16_t frame;
+    uint16_t values[3];
+};
+
+// 一个节点的一种变换分量，关键帧为 AnimationClip::keys 中连续的一段，按帧号递增
+struct AnimationTrack {
+    uint32_t node; // 导入时为 ImportedNode 的下标，追加到 Geometry 后为节点层级中的下标
+    AnimationTrackType type;
+    uint32_t first_key;
+    uint32_t key_count; // 至少为 1，只有一个关键帧时为常量
+    float range_min[3]; // 仅 translation 与 scale：value = range_min + unorm16 * range_extent
+    float range_extent[3];
+};
+
+struct AnimationClip {
+    float duration; // 秒
+    std::vector<AnimationTrack> tracks;
+    std::vector<AnimationKey> keys;
+};
+
+// 压缩前的轨道，glTF sampler 的原始关键帧
+enum AnimationInterpolation : uint32_t {
+    ANIMATION_INTERPOLATION_LINEAR,
+    ANIMATION_INTERPOLATION_STEP,
+    ANIMATION_INTERPOLATION_CUBIC_SPLINE, // values 每个关键帧依次为 in tangent、值、out tangent
+};
+
+struct RawAnimationTrack {
+    uint32_t node;
+    AnimationTrackType type;
+    AnimationInterpolation interpolation;
+    std::vector<float> times;
+    std::vector<glm::vec4> values; // rotation 为四元数 x, y, z, w，其余只有 xyz 有效
+};
+
+struct AnimationCompressStats {
+    uint64_t raw_key_count; // 按 ANIMATION_SAMPLE_RATE 重采样后的关键帧数
+    uint64_t key_count;     // 去除可由相邻关键帧插值得到的关键帧后剩余的
+    uint64_t raw_bytes;     // 重采样后以 float 存放的字节数
+    uint64_t compressed_bytes;
+};
+
+// 按 ANIMATION_SAMPLE_RATE 重采样，去除插值误差在容差以内的关键帧，再量化；时长不超过 u16 帧号的范围
+void compress_animation_clip(const std::vector<RawAnimationTrack> &raw_tracks, AnimationClip *clip, AnimationCompressStats *stats);
+
+void accumulate_animation_compress_stats(AnimationCompressStats *total, const AnimationCompressStats *stats);
+
+inline void decode_rotation_key(const AnimationKey *key, float rotation[4]) {
+    uint32_t largest = ((key->values[0] >> 15) << 1) | (key->values[1] >> 15);
+    float components[3];
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < 3; ++i) {
+        components[i] = (key->values[i] & 0x7fff) * (2.0f * ANIMATION_ROTATION_RANGE / 32767.0f) - ANIMATION_ROTATION_RANGE;
+        sum += components[i] * components[i];
+    }
+    for (uint32_t i = 0, j = 0; i < 4; ++i) { rotation[i] = i == largest ? std::sqrt(std::max(0.0f, 1.0f - sum)) : components[j++]; }
+}
+
+inline void decode_vector_key(const AnimationTrack *track, const AnimationKey *key, float value[3]) {
+    for (uint32_t i = 0; i < 3; ++i) { value[i] = track->range_min[i] + key->values[i] * (1.0f / 65535.0f) * track->range_extent[i]; }
+}
@@ -1,6 +1,10 @@
 #include "app.h"
+#include "accessor_decode.h"
+#include "animation.h"
 #include "core/deletion_queue.h"
+#include "core/frame_graph.h"
 #include "core/logging.h"
+#include "core/timer.h"
 #include "vk.h"
 #include "vk_context.h"
 #include "vk_command_buffer.h"
@@ -17,9 +21,12 @@
 #include "vk_sampler.h"
 #include "vk_swapchain.h"
 #include "vk_buffer.h"
+#include "upload_engine.h"
+#include "texture_streamer.h"
 #include <SDL3/SDL.h>
 #include <imgui.h>
 #include <microprofile.h>
+#include <cfloat>
 
 // struct RenderEntity {
 //     // for `VkCmdDrawIndexed`
@@ -50,6 +57,8 @@
 //     MaterialPassType pass_type;
 // };
 
+static void create_frame_graph(App *app);
+
 // vulkan clip space has inverted Y and half Z
 glm::mat4 clip = glm::mat4(
     // clang-format off
@@ -72,8 +81,10 @@ void create_color_image(App *app, VkFormat format) {
 }
 
 void create_depth_image(App *app, VkFormat format) {
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    if (app->is_occlusion_culling_enabled) { usage |= VK_IMAGE_USAGE_SAMPLED_BIT; } // 构建深度金字塔时采样
     vk_create_image(app->vk_context, app->vk_context->swapchain_extent.width, app->vk_context->swapchain_extent.height,
-                    format, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, false, &app->depth_image);
+                    format, usage, false, &app->depth_image);
     vk_create_image_view(app->vk_context->device, app->depth_image->image, format, VK_IMAGE_ASPECT_DEPTH_BIT,
                          app->depth_image->mip_levels, &app->depth_image_view);
 
@@ -103,6 +114,56 @@ void create_depth_image(App *app, VkFormat format) {
     vk_free_command_buffer(app->vk_context->device, app->vk_context->command_pool, command_buffer);
 }
 
+static uint32_t get_previous_power_of_two(uint32_t value) {
+    uint32_t power = 1;
+    while (power * 2 <= value) { power *= 2; }
+    return power;
+}
+
+// 第 0 层取不超过深度图的 2 的幂，每个纹素至多覆盖 3x3 个深度纹素，之后每层恰好是上一层的 2x2
+void create_depth_pyramid(App *app) {
+    const VkExtent2D *extent = &app->vk_context->swapchain_extent;
+    app->depth_pyramid_width = get_previous_power_of_two(extent->width);
+    app->depth_pyramid_height = get_previous_power_of_two(extent->height);
+
+    VkFormat format = VK_FORMAT_R32G32_SFLOAT;
+    vk_create_image(app->vk_context, app->depth_pyramid_width, app->depth_pyramid_height, format, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, true,
+                    &app->depth_pyramid);
+    vk_create_image_view(app->vk_context->device, app->depth_pyramid->image, format, VK_IMAGE_ASPECT_COLOR_BIT, app->depth_pyramid->mip_levels,
+                         &app->depth_pyramid_view);
+    app->depth_pyramid_level_views.resize(app->depth_pyramid->mip_levels);
+    for (uint32_t level = 0; level < app->depth_pyramid->mip_levels; ++level) {
+        vk_create_image_level_view(app->vk_context->device, app->depth_pyramid->image, format, VK_IMAGE_ASPECT_COLOR_BIT, level, 1,
+                                   &app->depth_pyramid_level_views[level]);
+    }
+
+    // 始终处于 GENERAL；第一帧的第一阶段剔除绑定但不采样，在此转换一次
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    vk_alloc_command_buffers(app->vk_context->device, app->vk_context->command_pool, 1, &command_buffer);
+
+    vk_begin_one_flight_command_buffer(command_buffer);
+    vk_transition_image_layout(command_buffer, app->depth_pyramid->image, VK_PIPELINE_STAGE_2_NONE, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_NONE,
+                               VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+    vk_end_command_buffer(command_buffer);
+
+    VkFence fence;
+    vk_create_fence(app->vk_context->device, false, &fence);
+
+    vk_queue_submit(app->vk_context->graphics_queue, command_buffer, fence);
+
+    vk_wait_fence(app->vk_context->device, fence);
+    vk_destroy_fence(app->vk_context->device, fence);
+
+    vk_free_command_buffer(app->vk_context->device, app->vk_context->command_pool, command_buffer);
+}
+
+void destroy_depth_pyramid(App *app) {
+    for (VkImageView image_view: app->depth_pyramid_level_views) { vk_destroy_image_view(app->vk_context->device, image_view); }
+    app->depth_pyramid_level_views.clear();
+    vk_destroy_image_view(app->vk_context->device, app->depth_pyramid_view);
+    vk_destroy_image(app->vk_context, app->depth_pyramid);
+}
+
 void create_quad_geometry(const App *app, Geometry *geometry) {
     Vertex vertices[4];
     // clang-format off
@@ -111,27 +172,43 @@ void create_quad_geometry(const App *app, Geometry *geometry) {
     vertices[2] = {{-0.5f,  0.5f, 0.0f}, {0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 0.5f}};
     vertices[3] = {{ 0.5f,  0.5f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 0.5f}};
     // clang-format on
-    uint32_t indices[6] = {0, 1, 2, 2, 1, 3};
+    uint16_t indices[6] = {0, 1, 2, 2, 1, 3};
     MeshBuffer mesh_buffer;
-    create_mesh_buffer(app->vk_context, vertices, 4, sizeof(Vertex), indices, 6, sizeof(uint32_t), &mesh_buffer);
+    create_mesh_buffer(app->upload_engine, app->geometry_arena, vertices, 4, sizeof(Vertex), nullptr, 0, nullptr, indices, sizeof(indices), nullptr, 0, &mesh_buffer);
+    mesh_buffer.vertex_layout = VERTEX_LAYOUT_STANDARD;
+    mesh_buffer.quantization = {};
 
     Mesh mesh = {};
     mesh.mesh_buffer = mesh_buffer;
 
     Primitive primitive = {};
+    primitive.index_type = INDEX_TYPE_UINT16;
     primitive.index_count = 6;
     primitive.index_offset = 0;
+    primitive.vertex_count = 4;
+    primitive.vertex_offset = 0;
+    primitive.material_index = -1;
+    primitive.lod_count = 1;
+    primitive.lods[0] = {primitive.index_offset, primitive.index_count, 0.0f};
+    primitive.aabb = compute_aabb(vertices, 4);
+    primitive.bounding_sphere = compute_bounding_sphere(vertices, 4);
     mesh.primitives.push_back(primitive);
+    mesh.aabb = primitive.aabb;
+    mesh.bounding_sphere = primitive.bounding_sphere;
 
+    int32_t parent = -1;
+    uint32_t node_index = add_transform_nodes(&geometry->transform_hierarchy, &parent, 1);
+    geometry->instances.push_back({(uint32_t) geometry->meshes.size(), node_index, 0, 0, -1, 0, 0});
     geometry->meshes.push_back(mesh);
 }
 
-void app_create(SDL_Window *window, App **out_app) {
+void app_create(SDL_Window *window, ThreadPool *thread_pool, App **out_app) {
     int width, height;
     SDL_GetWindowSizeInPixels(window, &width, &height);
 
     App *app = new App();
     app->window = window;
+    app->thread_pool = thread_pool;
     app->vk_context = new VkContext();
 
     vk_init(app->vk_context, window, width, height);
@@ -149,7 +226,7 @@ void app_create(SDL_Window *window, App **out_app) {
         vk_create_semaphore(vk_context->device, &frame->image_acquired_semaphore);
         vk_create_semaphore(vk_context->device, &frame->render_finished_semaphore);
 
-        uint32_t max_sets = 3; // 计算着色器一个 set，mesh pipeline 中 shader 两个 set
+        uint32_t max_sets = 64; // 计算着色器一个 set，mesh pipeline 中全局状态一个 set、每个材质一个 set，不足时分配器新建 pool
         std::vector<DescriptorPoolSizeRatio> size_ratios;
         size_ratios.push_back({VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1});
         size_ratios.push_back({VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1});
@@ -158,8 +235,22 @@ void app_create(SDL_Window *window, App **out_app) {
 
         vk_create_buffer(vk_context, sizeof(GlobalState), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                          VMA_MEMORY_USAGE_CPU_TO_GPU, &frame->global_state_buffer);
+
+        DrawCullStats draw_cull_stats{};
+        vk_create_buffer(vk_context, sizeof(DrawCullStats), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                         VMA_MEMORY_USAGE_GPU_TO_CPU, &frame->cull_stats_buffer);
+        frame->cull_stats_buffer_device_address = vk_get_buffer_device_address(vk_context, &frame->cull_stats_buffer);
+        vk_copy_data_to_buffer(vk_context, &frame->cull_stats_buffer, &draw_cull_stats, sizeof(DrawCullStats));
     }
 
+    // 深度图的用途与剔除 pipeline 的选择依赖这些开关，先于资源创建确定
+    app->is_cluster_culling_enabled = vk_context->is_draw_indirect_count_supported;
+    log_info("cluster culling %s", app->is_cluster_culling_enabled ? "enabled" : "disabled");
+    app->is_gpu_driven_enabled = vk_context->is_draw_indirect_count_supported && vk_context->is_draw_indirect_first_instance_supported;
+    log_info("gpu driven rendering %s", app->is_gpu_driven_enabled ? "enabled" : "disabled");
+    app->is_occlusion_culling_enabled = app->is_gpu_driven_enabled && vk_context->is_storage_image_extended_formats_supported;
+    log_info("occlusion culling %s", app->is_occlusion_culling_enabled ? "enabled" : "disabled");
+
     VkFormat color_image_format = VK_FORMAT_R16G16B16A16_SFLOAT;
     create_color_image(app, color_image_format);
 
@@ -173,14 +264,83 @@ void app_create(SDL_Window *window, App **out_app) {
     }
     {
         std::vector<VkDescriptorSetLayoutBinding> bindings;
-        bindings.push_back({0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, nullptr});
+        bindings.push_back({0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT, nullptr});
         vk_create_descriptor_set_layout(vk_context->device, bindings, &app->global_state_descriptor_set_layout);
     }
     {
         std::vector<VkDescriptorSetLayoutBinding> bindings;
-        bindings.push_back({0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr});
+        bindings.push_back({0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT, nullptr});
         vk_create_descriptor_set_layout(vk_context->device, bindings, &app->single_combined_image_sampler_descriptor_set_layout);
     }
+    if (app->is_occlusion_culling_enabled) {
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        bindings.push_back({0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr});
+        bindings.push_back({1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr});
+        vk_create_descriptor_set_layout(vk_context->device, bindings, &app->depth_pyramid_descriptor_set_layout);
+
+        create_depth_pyramid(app);
+    }
+
+    { // create cluster cull pipeline
+        VkShaderModule compute_shader_module;
+        vk_create_shader_module(vk_context->device, "shaders/cluster_cull.comp.spv", &compute_shader_module);
+
+        VkPushConstantRange push_constant_range{};
+        push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        push_constant_range.size = sizeof(ClusterCullState);
+
+        vk_create_pipeline_layout(vk_context->device, 0, nullptr, &push_constant_range, &app->cluster_cull_pipeline_layout);
+        vk_create_compute_pipeline(vk_context->device, app->cluster_cull_pipeline_layout, compute_shader_module, &app->cluster_cull_pipeline);
+
+        vk_destroy_shader_module(vk_context->device, compute_shader_module);
+    }
+
+    { // create draw cull pipeline，遮挡剔除的变体在 set 1 采样深度金字塔
+        VkShaderModule compute_shader_module;
+        vk_create_shader_module(vk_context->device, app->is_occlusion_culling_enabled ? "shaders/draw_cull.occlusion.comp.spv" : "shaders/draw_cull.comp.spv",
+                                &compute_shader_module);
+
+        VkPushConstantRange push_constant_range{};
+        push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        push_constant_range.size = sizeof(DrawCullState);
+
+        VkDescriptorSetLayout descriptor_set_layouts[2] = {app->global_state_descriptor_set_layout, app->single_combined_image_sampler_descriptor_set_layout};
+        vk_create_pipeline_layout(vk_context->device, app->is_occlusion_culling_enabled ? 2 : 1, descriptor_set_layouts, &push_constant_range,
+                                  &app->draw_cull_pipeline_layout);
+        vk_create_compute_pipeline(vk_context->device, app->draw_cull_pipeline_layout, compute_shader_module, &app->draw_cull_pipeline);
+
+        vk_destroy_shader_module(vk_context->device, compute_shader_module);
+    }
+
+    if (app->is_occlusion_culling_enabled) { // create depth pyramid pipeline
+        VkShaderModule compute_shader_module;
+        vk_create_shader_module(vk_context->device, "shaders/depth_pyramid.comp.spv", &compute_shader_module);
+
+        VkPushConstantRange push_constant_range{};
+        push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        push_constant_range.size = sizeof(DepthPyramidState);
+
+        vk_create_pipeline_layout(vk_context->device, 1, &app->depth_pyramid_descriptor_set_layout, &push_constant_range, &app->depth_pyramid_pipeline_layout);
+        vk_create_compute_pipeline(vk_context->device, app->depth_pyramid_pipeline_layout, compute_shader_module, &app->depth_pyramid_pipeline);
+
+        vk_destroy_shader_module(vk_context->device, compute_shader_module);
+    }
+
+    { // create skinning pipelines
+        const char *shader_paths[VERTEX_LAYOUT_COUNT] = {"shaders/skinning.comp.spv", "shaders/skinning.packed.comp.spv"};
+
+        VkPushConstantRange push_constant_range{};
+        push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        push_constant_range.size = sizeof(SkinningState);
+
+        vk_create_pipeline_layout(vk_context->device, 0, nullptr, &push_constant_range, &app->skinning_pipeline_layout);
+        for (uint32_t i = 0; i < VERTEX_LAYOUT_COUNT; ++i) {
+            VkShaderModule compute_shader_module;
+            vk_create_shader_module(vk_context->device, shader_paths[i], &compute_shader_module);
+            vk_create_compute_pipeline(vk_context->device, app->skinning_pipeline_layout, compute_shader_module, &app->skinning_pipelines[i]);
+            vk_destroy_shader_module(vk_context->device, compute_shader_module);
+        }
+    }
 
     {// create compute pipeline
         VkShaderModule compute_shader_module;
@@ -193,9 +353,10 @@ void app_create(SDL_Window *window, App **out_app) {
         vk_destroy_shader_module(vk_context->device, compute_shader_module);
     }
 
-    { // create mesh pipeline
-        VkShaderModule vert_shader, frag_shader;
-        vk_create_shader_module(vk_context->device, "shaders/mesh.vert.spv", &vert_shader);
+    { // create mesh pipelines
+        const char *vert_shader_paths[VERTEX_LAYOUT_COUNT] = {"shaders/mesh.vert.spv", "shaders/mesh.packed.vert.spv"};
+        const char *indirect_vert_shader_paths[VERTEX_LAYOUT_COUNT] = {"shaders/mesh.indirect.vert.spv", "shaders/mesh.packed.indirect.vert.spv"};
+        VkShaderModule frag_shader;
         vk_create_shader_module(vk_context->device, "shaders/mesh.frag.spv", &frag_shader);
 
         VkPushConstantRange push_constant_range{};
@@ -206,15 +367,24 @@ void app_create(SDL_Window *window, App **out_app) {
         descriptor_set_layouts[0] = app->global_state_descriptor_set_layout;
         descriptor_set_layouts[1] = app->single_combined_image_sampler_descriptor_set_layout;
         vk_create_pipeline_layout(vk_context->device, 2, descriptor_set_layouts, &push_constant_range, &app->mesh_pipeline_layout);
-        vk_create_graphics_pipeline(vk_context->device, app->mesh_pipeline_layout, color_image_format, true, true, depth_image_format, {{VK_SHADER_STAGE_VERTEX_BIT, vert_shader}, {VK_SHADER_STAGE_FRAGMENT_BIT, frag_shader}}, VK_POLYGON_MODE_FILL, &app->mesh_pipeline);
+        for (uint32_t i = 0; i < VERTEX_LAYOUT_COUNT; ++i) {
+            VkShaderModule vert_shader;
+            vk_create_shader_module(vk_context->device, vert_shader_paths[i], &vert_shader);
+            vk_create_graphics_pipeline(vk_context->device, app->mesh_pipeline_layout, color_image_format, true, true, depth_image_format, {{VK_SHADER_STAGE_VERTEX_BIT, vert_shader}, {VK_SHADER_STAGE_FRAGMENT_BIT, frag_shader}}, VK_POLYGON_MODE_FILL, &app->mesh_pipelines[i]);
+            vk_destroy_shader_module(vk_context->device, vert_shader);
+
+            vk_create_shader_module(vk_context->device, indirect_vert_shader_paths[i], &vert_shader);
+            vk_create_graphics_pipeline(vk_context->device, app->mesh_pipeline_layout, color_image_format, true, true, depth_image_format, {{VK_SHADER_STAGE_VERTEX_BIT, vert_shader}, {VK_SHADER_STAGE_FRAGMENT_BIT, frag_shader}}, VK_POLYGON_MODE_FILL, &app->indirect_mesh_pipelines[i]);
+            vk_destroy_shader_module(vk_context->device, vert_shader);
+        }
 
         vk_destroy_shader_module(vk_context->device, frag_shader);
-        vk_destroy_shader_module(vk_context->device, vert_shader);
     }
 
-    { // create wireframe pipeline
-        VkShaderModule vert_shader, frag_shader;
-        vk_create_shader_module(vk_context->device, "shaders/wireframe.vert.spv", &vert_shader);
+    { // create wireframe pipelines
+        const char *vert_shader_paths[VERTEX_LAYOUT_COUNT] = {"shaders/wireframe.vert.spv", "shaders/wireframe.packed.vert.spv"};
+        const char *indirect_vert_shader_paths[VERTEX_LAYOUT_COUNT] = {"shaders/wireframe.indirect.vert.spv", "shaders/wireframe.packed.indirect.vert.spv"};
+        VkShaderModule frag_shader;
         vk_create_shader_module(vk_context->device, "shaders/wireframe.frag.spv", &frag_shader);
 
         VkPushConstantRange push_constant_range{};
@@ -224,16 +394,35 @@ void app_create(SDL_Window *window, App **out_app) {
         VkDescriptorSetLayout descriptor_set_layouts[1];
         descriptor_set_layouts[0] = app->global_state_descriptor_set_layout;
         vk_create_pipeline_layout(vk_context->device, 1, descriptor_set_layouts, &push_constant_range, &app->wireframe_pipeline_layout);
-        vk_create_graphics_pipeline(vk_context->device, app->wireframe_pipeline_layout, color_image_format, true, false, depth_image_format, {{VK_SHADER_STAGE_VERTEX_BIT, vert_shader}, {VK_SHADER_STAGE_FRAGMENT_BIT, frag_shader}}, VK_POLYGON_MODE_LINE, &app->wireframe_pipeline);
+        for (uint32_t i = 0; i < VERTEX_LAYOUT_COUNT; ++i) {
+            VkShaderModule vert_shader;
+            vk_create_shader_module(vk_context->device, vert_shader_paths[i], &vert_shader);
+            vk_create_graphics_pipeline(vk_context->device, app->wireframe_pipeline_layout, color_image_format, true, false, depth_image_format, {{VK_SHADER_STAGE_VERTEX_BIT, vert_shader}, {VK_SHADER_STAGE_FRAGMENT_BIT, frag_shader}}, VK_POLYGON_MODE_LINE, &app->wireframe_pipelines[i]);
+            vk_destroy_shader_module(vk_context->device, vert_shader);
+
+            vk_create_shader_module(vk_context->device, indirect_vert_shader_paths[i], &vert_shader);
+            vk_create_graphics_pipeline(vk_context->device, app->wireframe_pipeline_layout, color_image_format, true, false, depth_image_format, {{VK_SHADER_STAGE_VERTEX_BIT, vert_shader}, {VK_SHADER_STAGE_FRAGMENT_BIT, frag_shader}}, VK_POLYGON_MODE_LINE, &app->indirect_wireframe_pipelines[i]);
+            vk_destroy_shader_module(vk_context->device, vert_shader);
+        }
 
         vk_destroy_shader_module(vk_context->device, frag_shader);
-        vk_destroy_shader_module(vk_context->device, vert_shader);
     }
 
+    upload_engine_create(vk_context, UPLOAD_RING_CAPACITY, &app->upload_engine);
+    texture_streamer_create(vk_context, app->upload_engine, TEXTURE_BUDGET_CAP_BYTES, TEXTURE_STREAM_BUDGET_BYTES, FRAMES_IN_FLIGHT,
+                            &app->texture_streamer);
+
     {
         // create default gray image
         uint32_t gray = glm::packUnorm4x8(glm::vec4(0.66f, 0.66f, 0.66f, 1.0f));
-        vk_create_image_from_data(vk_context, &gray, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT, false, &app->default_gray_image);
+        vk_create_image(vk_context, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, false, &app->default_gray_image);
+        upload_image(app->upload_engine, app->default_gray_image, VK_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, &gray, sizeof(gray));
+
+        // create default white image
+        uint32_t white = 0xffffffff;
+        vk_create_image(vk_context, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, false, &app->default_white_image);
+        upload_image(app->upload_engine, app->default_white_image, VK_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, &white, sizeof(white));
+        vk_create_image_view(vk_context->device, app->default_white_image->image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, 1, &app->default_white_image_view);
 
         // create default checkerboard image
         uint32_t magenta = glm::packUnorm4x8(glm::vec4(1.0f, 0.0f, 1.0f, 1.0f));
@@ -244,22 +433,46 @@ void app_create(SDL_Window *window, App **out_app) {
                 pixels[y * 16 + x] = ((x % 2) ^ (y % 2)) ? magenta : black;
             }
         }
-        vk_create_image_from_data(vk_context, pixels, 16, 16, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT, false, &app->default_checkerboard_image);
+        vk_create_image(vk_context, 16, 16, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, false, &app->default_checkerboard_image);
+        upload_image(app->upload_engine, app->default_checkerboard_image, VK_FORMAT_R8G8B8A8_UNORM, 16, 16, 1, pixels, sizeof(pixels));
         vk_create_image_view(vk_context->device, app->default_checkerboard_image->image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, 1, &app->default_checkerboard_image_view);
 
+        // 默认贴图在首帧即被引用，需要等待上传完成
+        upload_engine_wait(app->upload_engine, upload_engine_flush(app->upload_engine));
+
         // create default sampler
         vk_create_sampler(vk_context->device, VK_FILTER_NEAREST, VK_FILTER_NEAREST, &app->default_sampler_nearest);
+        vk_create_mipmap_sampler(vk_context->device, VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, &app->default_sampler_linear_mipmap);
     }
 
     // create ui
     // (*app)->gui_context = ImGui::CreateContext();
 
-    // load_gltf(app->vk_context, "models/cube.gltf", &app->gltf_model_geometry);
-    load_gltf(app->vk_context, "models/chinese-dragon.gltf", &app->gltf_model_geometry);
-    // load_gltf(app->vk_context, "models/Fox.glb", &app->gltf_model_geometry);
-    // load_gltf(app->vk_context, "models/suzanne/scene.gltf", &app->gltf_model_geometry);
+    geometry_arena_create(vk_context, GEOMETRY_ARENA_VERTEX_CAPACITY, GEOMETRY_ARENA_INDEX_CAPACITY, &app->geometry_arena);
+
+    asset_loader_create(thread_pool, app->upload_engine, app->geometry_arena, ASSET_LOADER_MAX_IMPORTING_COUNT, &app->asset_loader);
+    animation_system_create(thread_pool, &app->animation_system);
+
+    // 模型在后台导入，首帧不等待，mesh 交接并上传完成后逐个可见
+    GltfLoadOptions gltf_load_options{};
+    gltf_load_options.optimize = true;
+    gltf_load_options.vertex_layout = VERTEX_LAYOUT_PACKED; // VERTEX_LAYOUT_STANDARD 用于对比画面与带宽
+    gltf_load_options.position_stream = true;
+    gltf_load_options.generate_lods = true;
+    gltf_load_options.build_meshlets = true;
+    gltf_load_options.import_textures = true;
+    gltf_load_options.compress_textures = vk_context->is_texture_compression_bc_supported;
+    gltf_load_options.map_files = true;
+    gltf_load_options.uint8_indices = vk_context->is_index_type_uint8_supported;
+    // app->gltf_model_request = asset_loader_request_gltf(app->asset_loader, "models/cube.gltf", &gltf_load_options, 0, &app->gltf_model_geometry);
+    app->gltf_model_request = asset_loader_request_gltf(app->asset_loader, "models/chinese-dragon.gltf", &gltf_load_options, 0, &app->gltf_model_geometry);
+    // app->gltf_model_request = asset_loader_request_gltf(app->asset_loader, "models/Fox.glb", &gltf_load_options, 0, &app->gltf_model_geometry);
+    // app->gltf_model_request = asset_loader_request_gltf(app->asset_loader, "models/suzanne/scene.gltf", &gltf_load_options, 0, &app->gltf_model_geometry);
 
     create_quad_geometry(app, &app->quad_geometry);
+    upload_engine_flush(app->upload_engine); // 不等待，mesh 在上传可用后才会绘制
+
+    create_frame_graph(app);
 
     create_camera(&app->camera, glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, -1.0f));
 
@@ -273,25 +486,51 @@ void app_destroy(App *app) {
 
     destroy_camera(&app->camera);
 
-    destroy_geometry(app->vk_context, &app->quad_geometry);
-    destroy_geometry(app->vk_context, &app->gltf_model_geometry);
+    frame_graph_destroy(app->frame_graph);
+
+    asset_loader_destroy(app->asset_loader);
+    animation_system_destroy(app->animation_system);
+    destroy_geometry(app->vk_context, app->geometry_arena, &app->quad_geometry);
+    destroy_geometry(app->vk_context, app->geometry_arena, &app->gltf_model_geometry);
+    geometry_arena_destroy(app->vk_context, app->geometry_arena);
+    texture_streamer_destroy(app->texture_streamer);
+    upload_engine_destroy(app->upload_engine);
 
+    vk_destroy_sampler(app->vk_context->device, app->default_sampler_linear_mipmap);
     vk_destroy_sampler(app->vk_context->device, app->default_sampler_nearest);
     vk_destroy_image_view(app->vk_context->device, app->default_checkerboard_image_view);
     vk_destroy_image(app->vk_context, app->default_checkerboard_image);
+    vk_destroy_image_view(app->vk_context->device, app->default_white_image_view);
+    vk_destroy_image(app->vk_context, app->default_white_image);
     vk_destroy_image(app->vk_context, app->default_gray_image);
 
     // ImGui::DestroyContext(app->gui_context);
 
-    vk_destroy_pipeline(app->vk_context->device, app->wireframe_pipeline);
+    for (VkPipeline pipeline: app->wireframe_pipelines) { vk_destroy_pipeline(app->vk_context->device, pipeline); }
+    for (VkPipeline pipeline: app->indirect_wireframe_pipelines) { vk_destroy_pipeline(app->vk_context->device, pipeline); }
     vk_destroy_pipeline_layout(app->vk_context->device, app->wireframe_pipeline_layout);
 
-    vk_destroy_pipeline(app->vk_context->device, app->mesh_pipeline);
+    for (VkPipeline pipeline: app->mesh_pipelines) { vk_destroy_pipeline(app->vk_context->device, pipeline); }
+    for (VkPipeline pipeline: app->indirect_mesh_pipelines) { vk_destroy_pipeline(app->vk_context->device, pipeline); }
     vk_destroy_pipeline_layout(app->vk_context->device, app->mesh_pipeline_layout);
 
     vk_destroy_pipeline(app->vk_context->device, app->compute_pipeline);
     vk_destroy_pipeline_layout(app->vk_context->device, app->compute_pipeline_layout);
 
+    for (VkPipeline pipeline: app->skinning_pipelines) { vk_destroy_pipeline(app->vk_context->device, pipeline); }
+    vk_destroy_pipeline_layout(app->vk_context->device, app->skinning_pipeline_layout);
+    vk_destroy_pipeline(app->vk_context->device, app->draw_cull_pipeline);
+    vk_destroy_pipeline_layout(app->vk_context->device, app->draw_cull_pipeline_layout);
+    if (app->is_occlusion_culling_enabled) {
+        vk_destroy_pipeline(app->vk_context->device, app->depth_pyramid_pipeline);
+        vk_destroy_pipeline_layout(app->vk_context->device, app->depth_pyramid_pipeline_layout);
+        vk_destroy_descriptor_set_layout(app->vk_context->device, app->depth_pyramid_descriptor_set_layout);
+        destroy_depth_pyramid(app);
+        if (app->draw_visibility_buffer_size > 0) { vk_destroy_buffer(app->vk_context, &app->draw_visibility_buffer); }
+    }
+    vk_destroy_pipeline(app->vk_context->device, app->cluster_cull_pipeline);
+    vk_destroy_pipeline_layout(app->vk_context->device, app->cluster_cull_pipeline_layout);
+
     vk_destroy_descriptor_set_layout(app->vk_context->device, app->single_combined_image_sampler_descriptor_set_layout);
     vk_destroy_descriptor_set_layout(app->vk_context->device, app->global_state_descriptor_set_layout);
     vk_destroy_descriptor_set_layout(app->vk_context->device, app->single_storage_image_descriptor_set_layout);
@@ -303,6 +542,13 @@ void app_destroy(App *app) {
     vk_destroy_image(app->vk_context, app->color_image);
 
     for (uint8_t i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+        if (app->frames[i].indirect_draw_buffer_size > 0) { vk_destroy_buffer(app->vk_context, &app->frames[i].indirect_draw_buffer); }
+        if (app->frames[i].draw_item_buffer_size > 0) { vk_destroy_buffer(app->vk_context, &app->frames[i].draw_item_buffer); }
+        if (app->frames[i].instance_buffer_size > 0) { vk_destroy_buffer(app->vk_context, &app->frames[i].instance_buffer); }
+        if (app->frames[i].cluster_draw_buffer_size > 0) { vk_destroy_buffer(app->vk_context, &app->frames[i].cluster_draw_buffer); }
+        if (app->frames[i].skinned_vertex_buffer_size > 0) { vk_destroy_buffer(app->vk_context, &app->frames[i].skinned_vertex_buffer); }
+        if (app->frames[i].joint_matrix_buffer_size > 0) { vk_destroy_buffer(app->vk_context, &app->frames[i].joint_matrix_buffer); }
+        vk_destroy_buffer(app->vk_context, &app->frames[i].cull_stats_buffer);
         vk_destroy_buffer(app->vk_context, &app->frames[i].global_state_buffer);
         vk_descriptor_allocator_destroy(app->vk_context->device, app->frames[i].descriptor_allocator);
         vk_destroy_semaphore(app->vk_context->device, app->frames[i].render_finished_semaphore);
@@ -332,12 +578,695 @@ void draw_background(const App *app, VkCommandBuffer command_buffer) {
     vk_update_descriptor_set(app->vk_context->device, descriptor_set, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
                              &image_info);
 
-    vk_command_bind_descriptor_sets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, app->compute_pipeline_layout, 1, &descriptor_set);
+    vk_command_bind_descriptor_sets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, app->compute_pipeline_layout, 0, 1, &descriptor_set);
     vk_command_dispatch(command_buffer, std::ceil(app->vk_context->swapchain_extent.width / 16.0),
                         std::ceil(app->vk_context->swapchain_extent.height / 16.0), 1);
 }
 
-void draw_geometries(const App *app, VkCommandBuffer command_buffer) {
+// 实例引用的 mesh 尚未交接或上传尚未完成时返回 nullptr
+static const Mesh *get_instance_mesh(const App *app, const Geometry *geometry, const MeshInstance *instance) {
+    if (instance->mesh_index >= geometry->meshes.size()) { return nullptr; }
+    const Mesh *mesh = &geometry->meshes[instance->mesh_index];
+    return upload_engine_is_available(app->upload_engine, mesh->mesh_buffer.upload_token) ? mesh : nullptr;
+}
+
+static const glm::mat4 &get_instance_model_matrix(const Geometry *geometry, const MeshInstance *instance) {
+    return geometry->transform_hierarchy.world_matrices[instance->node_index];
+}
+
+static float get_max_scale(const glm::mat4 &model) {
+    return std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+}
+
+static const PrimitiveLod *get_primitive_lod(const Primitive *primitive, uint32_t lod_level) {
+    return &primitive->lods[std::min(lod_level, primitive->lod_count - 1)];
+}
+
+// 同一 mesh 的所有 primitive 使用同一级 lod，取各 primitive 在该级误差的最大值
+static float get_mesh_lod_error(const Mesh *mesh, uint32_t lod_level) {
+    float error = 0.0f;
+    for (const Primitive &primitive: mesh->primitives) { error = std::max(error, get_primitive_lod(&primitive, lod_level)->error); }
+    return error;
+}
+
+// 选择误差投影到屏幕上不超过阈值的最粗一级 lod
+static uint32_t select_mesh_lod(const Mesh *mesh, float pixels_per_unit, float threshold_pixels) {
+    uint32_t lod_count = 1;
+    for (const Primitive &primitive: mesh->primitives) { lod_count = std::max(lod_count, primitive.lod_count); }
+
+    uint32_t lod_level = 0;
+    while (lod_level + 1 < lod_count && get_mesh_lod_error(mesh, lod_level + 1) * pixels_per_unit <= threshold_pixels) { ++lod_level; }
+    return lod_level;
+}
+
+// 根据包围球在屏幕上的投影尺寸为每个实例选择 lod，并统计本帧的三角形数
+static void select_lods(App *app) {
+    const glm::mat4 &projection = app->global_state.projection;
+    float viewport_height = (float) app->vk_context->swapchain_extent.height;
+    const Geometry *geometry = &app->gltf_model_geometry;
+
+    LodStats lod_stats{};
+    for (MeshInstance &instance: app->gltf_model_geometry.instances) {
+        const Mesh *mesh = get_instance_mesh(app, geometry, &instance);
+        if (!mesh) { continue; }
+
+        const glm::mat4 &model = get_instance_model_matrix(geometry, &instance);
+        float max_scale = get_max_scale(model);
+        glm::vec3 center = glm::vec3(model * glm::vec4(mesh->bounding_sphere.center, 1.0f));
+        float radius = mesh->bounding_sphere.radius * max_scale;
+
+        // 以包围球上离相机最近的点估计投影尺寸，相机位于包围球内时使用 lod 0
+        float distance = glm::length(center - app->camera.position) - radius;
+        uint32_t lod_level = 0;
+        if (distance > 0.0f) {
+            float pixels_per_unit = viewport_height * 0.5f * std::abs(projection[1][1]) / distance * max_scale; // 模型空间单位长度投影的像素数
+            lod_level = select_mesh_lod(mesh, pixels_per_unit, LOD_ERROR_THRESHOLD_PIXELS);
+            if (lod_level > instance.lod_level) {
+                lod_level = std::max(instance.lod_level, select_mesh_lod(mesh, pixels_per_unit, LOD_ERROR_THRESHOLD_PIXELS * (1.0f - LOD_HYSTERESIS)));
+            }
+        }
+        instance.lod_level = lod_level;
+
+        ++lod_stats.instance_counts[lod_level];
+        for (const Primitive &primitive: mesh->primitives) { lod_stats.triangle_count += get_primitive_lod(&primitive, lod_level)->index_count / 3; }
+    }
+
+    if (memcmp(lod_stats.instance_counts, app->lod_stats.instance_counts, sizeof(lod_stats.instance_counts)) != 0) {
+        log_debug("lod changed: %u triangles, instances per lod: %u %u %u %u %u %u %u %u", lod_stats.triangle_count, lod_stats.instance_counts[0],
+                  lod_stats.instance_counts[1], lod_stats.instance_counts[2], lod_stats.instance_counts[3], lod_stats.instance_counts[4],
+                  lod_stats.instance_counts[5], lod_stats.instance_counts[6], lod_stats.instance_counts[7]);
+    }
+    app->lod_stats = lod_stats;
+}
+
+// 蒙皮 mesh 且引用的 skin 有效的实例由 skinning 每帧重写顶点
+static bool is_instance_skinned(const Geometry *geometry, const Mesh *mesh, const MeshInstance *instance) {
+    return mesh->mesh_buffer.skin_buffer_device_address != 0 && instance->skin_index >= 0 && instance->skin_index < (int32_t) geometry->skins.size();
+}
+
+// 以 mesh 的 aabb 变换到世界空间后批量剔除，结果供不走 gpu driven 的绘制与贴图请求使用
+// 尚未交接的 mesh 与蒙皮实例没有可靠的包围盒，总是可见
+static void cull_instances(App *app) {
+    const Geometry *geometry = &app->gltf_model_geometry;
+    uint32_t instance_count = geometry->instances.size();
+    resize_cull_bounds(&app->instance_bounds, instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i) {
+        const MeshInstance *instance = &geometry->instances[i];
+        const Mesh *mesh = get_instance_mesh(app, geometry, instance);
+        if (!mesh || is_instance_skinned(geometry, mesh, instance)) {
+            set_cull_bounds_unbounded(&app->instance_bounds, i);
+            continue;
+        }
+        set_cull_bounds(&app->instance_bounds, i, get_instance_model_matrix(geometry, instance), mesh->aabb.min, mesh->aabb.max);
+    }
+
+    glm::vec4 frustum_planes[6];
+    camera_get_frustum_planes(&app->camera, app->global_state.projection, frustum_planes);
+    app->instance_visibility.resize(get_visibility_word_count(instance_count));
+
+    DrawCullStats stats{};
+    stats.visible_count = frustum_cull(frustum_planes, &app->instance_bounds, app->instance_visibility.data());
+    stats.culled_count = instance_count - stats.visible_count;
+    if (memcmp(&stats, &app->instance_cull_stats, sizeof(DrawCullStats)) != 0) {
+        log_debug("instance frustum culling: %u visible, %u culled, %s", stats.visible_count, stats.culled_count, frustum_cull_simd_name());
+    }
+    app->instance_cull_stats = stats;
+}
+
+static bool is_instance_visible(const App *app, uint32_t instance_index) {
+    return instance_index >= app->instance_bounds.count || is_visible(app->instance_visibility.data(), instance_index);
+}
+
+static void request_material_texture(App *app, int32_t texture_index, float projected_pixels) {
+    if (texture_index < 0) { return; }
+    Texture *texture = &app->gltf_model_geometry.textures[texture_index];
+    if (!texture->image) { return; }
+
+    // 假设贴图大致覆盖模型表面一次，边长为 s 的贴图投影到 d 个像素上时只需第 log2(s / d) 层
+    float texture_size = (float) std::max(texture->width, texture->height);
+    uint32_t level = 0;
+    if (projected_pixels < texture_size) { level = std::min((uint32_t) std::log2(texture_size / std::max(projected_pixels, 1.0f)), texture->level_count - 1); }
+    request_texture_level(texture, level, app->frame_number);
+}
+
+// cull_instances 之后调用，视锥内的实例按包围球投影的直径请求其材质贴图的 mip，由 texture streamer 在本帧按预算上传
+static void request_texture_levels(App *app) {
+    const glm::mat4 &projection = app->global_state.projection;
+    float viewport_height = (float) app->vk_context->swapchain_extent.height;
+    const Geometry *geometry = &app->gltf_model_geometry;
+
+    for (uint32_t instance_index = 0; instance_index < geometry->instances.size(); ++instance_index) {
+        const MeshInstance &instance = geometry->instances[instance_index];
+        const Mesh *mesh = get_instance_mesh(app, geometry, &instance);
+        if (!mesh || !is_instance_visible(app, instance_index)) { continue; }
+
+        const glm::mat4 &model = get_instance_model_matrix(geometry, &instance);
+        glm::vec3 center = glm::vec3(model * glm::vec4(mesh->bounding_sphere.center, 1.0f));
+        float radius = mesh->bounding_sphere.radius * get_max_scale(model);
+
+        // 相机位于包围球内时请求最精细的一层
+        float distance = glm::length(center - app->camera.position) - radius;
+        float projected_pixels = distance > 0.0f ? radius * viewport_height * std::abs(projection[1][1]) / distance : FLT_MAX;
+        for (const Primitive &primitive: mesh->primitives) {
+            if (primitive.material_index < 0) { continue; }
+            const Material *material = &geometry->materials[primitive.material_index];
+            // 着色器只采样 base color，法线贴图在被使用之前不占用显存与上传预算
+            request_material_texture(app, material->base_color_texture, projected_pixels);
+        }
+    }
+}
+
+static bool has_single_material_and_index_type(const Mesh *mesh) {
+    for (const Primitive &primitive: mesh->primitives) {
+        if (primitive.material_index != mesh->primitives[0].material_index || primitive.index_type != mesh->primitives[0].index_type) { return false; }
+    }
+    return true;
+}
+
+// 只对 lod 0 做 cluster culling，更粗的 lod 三角形已经很少，直接整体绘制
+// 剔除后的 meshlet 在一次间接绘制中提交，只能绑定一个材质与索引类型，多材质或混合索引类型的 mesh 按 primitive 绘制
+// meshlet 的包围球与法线锥是绑定姿态下的，蒙皮实例不做 cluster culling
+static bool is_cluster_culled(const App *app, const Geometry *geometry, const Mesh *mesh, const MeshInstance *instance) {
+    return app->is_cluster_culling_enabled && mesh->mesh_buffer.meshlet_count > 0 && instance->lod_level == 0 && has_single_material_and_index_type(mesh) &&
+           !is_instance_skinned(geometry, mesh, instance);
+}
+
+// 容量不足时重新创建本帧的 buffer，调用前已等待过该帧的 fence
+static void reserve_frame_buffer(App *app, size_t size, VkBufferUsageFlags usage, VmaMemoryUsage memory_usage, Buffer *buffer,
+                                 VkDeviceAddress *device_address, size_t *capacity) {
+    if (*capacity >= size) { return; }
+    if (*capacity > 0) { vk_destroy_buffer(app->vk_context, buffer); }
+
+    *capacity = std::max(size, *capacity * 2);
+    vk_create_buffer(app->vk_context, *capacity, usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, memory_usage, buffer);
+    *device_address = vk_get_buffer_device_address(app->vk_context, buffer);
+}
+
+static void reserve_cluster_draw_buffer(App *app, RenderFrame *frame, size_t size) {
+    reserve_frame_buffer(app, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VMA_MEMORY_USAGE_GPU_ONLY, &frame->cluster_draw_buffer, &frame->cluster_draw_buffer_device_address, &frame->cluster_draw_buffer_size);
+}
+
+// 按 skin 中各关节节点的世界矩阵计算蒙皮矩阵，乘以实例模型矩阵的逆使蒙皮结果仍在模型空间，绘制时照常乘以模型矩阵
+// skin 在播放动画时使用动画系统算出的蒙皮矩阵
+static void compute_joint_matrices(const AnimationSystem *animation_system, const Geometry *geometry, const MeshInstance *instance,
+                                   glm::mat4 *joint_matrices) {
+    const Skin *skin = &geometry->skins[instance->skin_index];
+    glm::mat4 inverse_model = glm::inverse(get_instance_model_matrix(geometry, instance));
+    const std::vector<glm::mat4> *animated_skin_matrices = get_animated_skin_matrices(animation_system, instance->skin_index);
+    if (animated_skin_matrices) {
+        for (size_t i = 0; i < animated_skin_matrices->size(); ++i) { joint_matrices[i] = inverse_model * (*animated_skin_matrices)[i]; }
+        return;
+    }
+    for (size_t i = 0; i < skin->joint_nodes.size(); ++i) {
+        joint_matrices[i] = inverse_model * geometry->transform_hierarchy.world_matrices[skin->joint_nodes[i]] * skin->inverse_bind_matrices[i];
+    }
+}
+
+// 每个蒙皮实例蒙皮一次，写入本帧的 skinned vertex buffer，需在 draw_geometries 之前、渲染之外录制
+// 之后 mesh、wireframe 等 pass 都读取蒙皮后的顶点，开销只随蒙皮实例数增长，与 pass 数无关
+void skin_instances(App *app, VkCommandBuffer command_buffer) {
+    RenderFrame *frame = &app->frames[app->frame_index];
+
+    // mesh 随异步加载逐帧增加，每帧重新分配各实例在 skinned vertex buffer 中的区域
+    Geometry *geometry = &app->gltf_model_geometry;
+    SkinningStats stats{};
+    for (MeshInstance &instance: geometry->instances) {
+        const Mesh *mesh = get_instance_mesh(app, geometry, &instance);
+        if (!mesh || !is_instance_skinned(geometry, mesh, &instance)) { continue; }
+        instance.skinned_vertex_offset = stats.vertex_count * sizeof(Vertex);
+        ++stats.instance_count;
+        stats.vertex_count += mesh->mesh_buffer.vertex_count;
+        stats.joint_count += geometry->skins[instance.skin_index].joint_nodes.size();
+    }
+    if (stats.instance_count != app->skinning_stats.instance_count || stats.vertex_count != app->skinning_stats.vertex_count) {
+        log_debug("skinning: %u instances, %u vertices, %u joints", stats.instance_count, stats.vertex_count, stats.joint_count);
+    }
+    app->skinning_stats = stats;
+    if (stats.instance_count == 0) { return; }
+
+    reserve_frame_buffer(app, stats.vertex_count * sizeof(Vertex), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY,
+                         &frame->skinned_vertex_buffer, &frame->skinned_vertex_buffer_device_address, &frame->skinned_vertex_buffer_size);
+    reserve_frame_buffer(app, stats.joint_count * sizeof(glm::mat4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+                         &frame->joint_matrix_buffer, &frame->joint_matrix_buffer_device_address, &frame->joint_matrix_buffer_size);
+
+    std::vector<glm::mat4> joint_matrices(stats.joint_count);
+    uint32_t joint_offset = 0;
+    VkPipeline bound_pipeline = VK_NULL_HANDLE;
+    for (const MeshInstance &instance: geometry->instances) {
+        const Mesh *mesh = get_instance_mesh(app, geometry, &instance);
+        if (!mesh || !is_instance_skinned(geometry, mesh, &instance)) { continue; }
+
+        VkPipeline pipeline = app->skinning_pipelines[mesh->mesh_buffer.vertex_layout];
+        if (pipeline != bound_pipeline) {
+            vk_command_bind_pipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+            bound_pipeline = pipeline;
+        }
+
+        compute_joint_matrices(app->animation_system, geometry, &instance, &joint_matrices[joint_offset]);
+
+        SkinningState skinning_state{};
+        skinning_state.vertex_buffer_device_address = mesh->mesh_buffer.vertex_buffer_device_address;
+        skinning_state.skin_buffer_device_address = mesh->mesh_buffer.skin_buffer_device_address;
+        skinning_state.joint_matrix_buffer_device_address = frame->joint_matrix_buffer_device_address + joint_offset * sizeof(glm::mat4);
+        skinning_state.skinned_vertex_buffer_device_address = frame->skinned_vertex_buffer_device_address + instance.skinned_vertex_offset;
+        skinning_state.position_offset = glm::vec4(mesh->mesh_buffer.quantization.position_offset, 0.0f);
+        skinning_state.position_scale = glm::vec4(mesh->mesh_buffer.quantization.position_scale, 0.0f);
+        skinning_state.vertex_count = mesh->mesh_buffer.vertex_count;
+
+        vk_command_push_constants(command_buffer, app->skinning_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(SkinningState), &skinning_state);
+        vk_command_dispatch(command_buffer, (skinning_state.vertex_count + SKINNING_GROUP_SIZE - 1) / SKINNING_GROUP_SIZE, 1, 1);
+
+        joint_offset += geometry->skins[instance.skin_index].joint_nodes.size();
+    }
+
+    // 命令在提交后才执行，录制期间写入的关节矩阵对本帧的 dispatch 可见
+    vk_copy_data_to_buffer(app->vk_context, &frame->joint_matrix_buffer, joint_matrices.data(), joint_matrices.size() * sizeof(glm::mat4));
+}
+
+// 蒙皮实例读取本帧蒙皮后的 Vertex，使用 standard 格式的 pipeline；其余实例直接读取 mesh 的顶点
+static void get_instance_state(const App *app, const Geometry *geometry, const Mesh *mesh, const MeshInstance *instance,
+                               InstanceState *instance_state, VertexLayout *vertex_layout) {
+    *instance_state = {};
+    instance_state->model = get_instance_model_matrix(geometry, instance);
+    if (is_instance_skinned(geometry, mesh, instance)) {
+        instance_state->vertex_buffer_device_address = app->frames[app->frame_index].skinned_vertex_buffer_device_address + instance->skinned_vertex_offset;
+        *vertex_layout = VERTEX_LAYOUT_STANDARD; // 位置流是绑定姿态下的，position buffer 保持为 0
+        return;
+    }
+    instance_state->vertex_buffer_device_address = mesh->mesh_buffer.vertex_buffer_device_address;
+    instance_state->position_buffer_device_address = mesh->mesh_buffer.position_buffer_device_address;
+    instance_state->position_offset = glm::vec4(mesh->mesh_buffer.quantization.position_offset, 0.0f);
+    instance_state->position_scale = glm::vec4(mesh->mesh_buffer.quantization.position_scale, 0.0f);
+    *vertex_layout = mesh->mesh_buffer.vertex_layout;
+}
+
+// 蒙皮实例的包围球是绑定姿态下的，半径置为负数，不做视锥剔除
+static InstanceData get_instance_data(const Geometry *geometry, const Mesh *mesh, const MeshInstance *instance, const InstanceState *instance_state,
+                                      int32_t material_index) {
+    InstanceData instance_data{};
+    instance_data.model = instance_state->model;
+    instance_data.vertex_buffer_device_address = instance_state->vertex_buffer_device_address;
+    instance_data.position_buffer_device_address = instance_state->position_buffer_device_address;
+    instance_data.position_offset = instance_state->position_offset;
+    instance_data.position_scale = instance_state->position_scale;
+    instance_data.bounding_sphere = glm::vec4(mesh->bounding_sphere.center, is_instance_skinned(geometry, mesh, instance) ? -1.0f : mesh->bounding_sphere.radius);
+    instance_data.material_index = material_index;
+    return instance_data;
+}
+
+// 返回 pipeline、索引类型与材质都相同的批次，没有时新建
+// 每个绘制项查找一次，以哈希表代替线性查找，使每帧的开销只随绘制项数增长
+static uint32_t get_draw_batch(App *app, VertexLayout vertex_layout, IndexType index_type, int32_t material_index) {
+    uint64_t key = (uint64_t) (uint32_t) material_index << 32 | (uint64_t) vertex_layout << 8 | (uint64_t) index_type;
+    auto [it, is_inserted] = app->draw_batch_indices.try_emplace(key, (uint32_t) app->draw_batches.size());
+    if (!is_inserted) { return it->second; }
+
+    DrawBatch batch{};
+    batch.vertex_layout = vertex_layout;
+    batch.index_type = index_type;
+    batch.material_index = material_index;
+    app->draw_batches.push_back(batch);
+    return app->draw_batches.size() - 1;
+}
+
+static uint32_t get_draw_phase_count(const App *app) { return app->is_occlusion_culling_enabled ? 2 : 1; }
+
+// 将实例按 primitive 拆成绘制项并分批，写出各绘制项的 InstanceData 与 DrawItem，cpu 只顺序写两段数据，不再逐实例录制命令
+// 绘制命令由 cull_draws 在 gpu 上剔除后写入各批次，cluster culling 的实例只占一个 InstanceData，剔除后的 meshlet 由 cull_clusters 追加到其批次中
+// 需在 skinning 之后调用，蒙皮实例读取本帧的 skinned vertex buffer
+static void build_draw_batches(App *app) {
+    if (!app->is_gpu_driven_enabled) { return; }
+
+    RenderFrame *frame = &app->frames[app->frame_index];
+    Geometry *geometry = &app->gltf_model_geometry;
+    app->draw_batches.clear();
+    app->draw_batch_indices.clear();
+
+    std::vector<InstanceData> instance_data;
+    std::vector<DrawItem> draw_items;
+    std::vector<MeshInstance *> cluster_instances;
+    std::vector<uint32_t> draw_batch_indices; // 各绘制项的批次，批次的偏移确定后写入 DrawItem::batch_offset
+    for (MeshInstance &instance: geometry->instances) {
+        const Mesh *mesh = get_instance_mesh(app, geometry, &instance);
+        if (!mesh) { continue; }
+
+        InstanceState instance_state;
+        VertexLayout vertex_layout;
+        get_instance_state(app, geometry, mesh, &instance, &instance_state, &vertex_layout);
+
+        if (is_cluster_culled(app, geometry, mesh, &instance)) {
+            const Primitive *primitive = &mesh->primitives[0];
+            uint32_t batch_index = get_draw_batch(app, vertex_layout, primitive->index_type, primitive->material_index);
+            app->draw_batches[batch_index].max_draw_count += mesh->mesh_buffer.meshlet_count;
+            instance.instance_data_index = instance_data.size();
+            instance.cluster_draw_offset = batch_index; // 批次的偏移确定后替换为字节偏移
+            instance_data.push_back(get_instance_data(geometry, mesh, &instance, &instance_state, primitive->material_index));
+            cluster_instances.push_back(&instance);
+            continue;
+        }
+
+        for (const Primitive &primitive: mesh->primitives) {
+            const PrimitiveLod *lod = get_primitive_lod(&primitive, instance.lod_level);
+            uint32_t batch_index = get_draw_batch(app, vertex_layout, primitive.index_type, primitive.material_index);
+            DrawItem draw_item{};
+            draw_item.command.indexCount = lod->index_count;
+            draw_item.command.instanceCount = 1;
+            draw_item.command.firstIndex = get_first_index(&mesh->mesh_buffer, primitive.index_type) + lod->index_offset;
+            draw_item.command.vertexOffset = primitive.vertex_offset;
+            draw_item.command.firstInstance = instance_data.size();
+            draw_items.push_back(draw_item);
+            draw_batch_indices.push_back(batch_index);
+            ++app->draw_batches[batch_index].draw_count;
+            instance_data.push_back(get_instance_data(geometry, mesh, &instance, &instance_state, primitive.material_index));
+        }
+    }
+
+    DrawStats stats{};
+    stats.batch_count = app->draw_batches.size();
+    stats.draw_count = draw_items.size();
+    stats.cluster_instance_count = cluster_instances.size();
+    if (memcmp(&stats, &app->draw_stats, sizeof(DrawStats)) != 0) {
+        log_debug("gpu driven: %u batches, %u draws, %u cluster culled instances", stats.batch_count, stats.draw_count, stats.cluster_instance_count);
+    }
+    app->draw_stats = stats;
+    if (app->draw_batches.empty()) { return; }
+
+    uint32_t draw_buffer_size = 0;
+    for (DrawBatch &batch: app->draw_batches) {
+        batch.max_draw_count += batch.draw_count;
+        batch.offset = draw_buffer_size;
+        draw_buffer_size += sizeof(uint32_t) + batch.max_draw_count * sizeof(VkDrawIndexedIndirectCommand);
+    }
+    app->draw_buffer_size = draw_buffer_size;
+    for (size_t i = 0; i < draw_items.size(); ++i) { draw_items[i].batch_offset = app->draw_batches[draw_batch_indices[i]].offset; }
+    for (MeshInstance *instance: cluster_instances) { instance->cluster_draw_offset = app->draw_batches[instance->cluster_draw_offset].offset; }
+
+    reserve_frame_buffer(app, instance_data.size() * sizeof(InstanceData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+                         &frame->instance_buffer, &frame->instance_buffer_device_address, &frame->instance_buffer_size);
+    reserve_frame_buffer(app, draw_buffer_size * get_draw_phase_count(app), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VMA_MEMORY_USAGE_GPU_ONLY, &frame->indirect_draw_buffer, &frame->indirect_draw_buffer_device_address, &frame->indirect_draw_buffer_size);
+    vk_copy_data_to_buffer(app->vk_context, &frame->instance_buffer, instance_data.data(), instance_data.size() * sizeof(InstanceData));
+    if (draw_items.empty()) { return; }
+    reserve_frame_buffer(app, draw_items.size() * sizeof(DrawItem), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+                         &frame->draw_item_buffer, &frame->draw_item_buffer_device_address, &frame->draw_item_buffer_size);
+    vk_copy_data_to_buffer(app->vk_context, &frame->draw_item_buffer, draw_items.data(), draw_items.size() * sizeof(DrawItem));
+}
+
+// 各绘制项的可见性跨帧保留，绘制项数变化时下标不再对应，全部重置为可见，由本帧的第二阶段重新测试
+static void reset_draw_visibilities(App *app, VkCommandBuffer command_buffer) {
+    uint32_t draw_count = app->draw_stats.draw_count;
+    if (draw_count == app->draw_visibility_count) { return; }
+
+    size_t size = draw_count * sizeof(uint32_t);
+    if (size > app->draw_visibility_buffer_size) { vk_wait_idle(app->vk_context); } // 各帧共用，重建前等待所有帧
+    reserve_frame_buffer(app, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY,
+                         &app->draw_visibility_buffer, &app->draw_visibility_buffer_device_address, &app->draw_visibility_buffer_size);
+    vk_command_fill_buffer(command_buffer, app->draw_visibility_buffer.handle, 0, size, 1);
+    vk_buffer_barrier(command_buffer, &app->draw_visibility_buffer, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                      VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    app->draw_visibility_count = draw_count;
+}
+
+// 包围球变换到世界空间后对视锥的 6 个平面测试，可见的命令原子地压缩到所在批次中，并累计可见与剔除的绘制项数
+// 开启遮挡剔除时分两个阶段调用，见 DrawPhase；批次的绘制数在第一阶段清零，cluster culling 之后再向第一阶段的同一批次追加
+static void cull_draws(App *app, DrawPhase phase, VkCommandBuffer command_buffer) {
+    if (!app->is_gpu_driven_enabled || app->draw_batches.empty()) { return; }
+
+    RenderFrame *frame = &app->frames[app->frame_index];
+    if (phase == DRAW_PHASE_EARLY) {
+        vk_command_fill_buffer(command_buffer, frame->indirect_draw_buffer.handle, 0, app->draw_buffer_size * get_draw_phase_count(app), 0);
+        vk_buffer_barrier(command_buffer, &frame->indirect_draw_buffer, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                          VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    }
+    if (app->draw_stats.draw_count == 0) { return; }
+
+    if (phase == DRAW_PHASE_EARLY) {
+        if (app->is_occlusion_culling_enabled) { reset_draw_visibilities(app, command_buffer); }
+        // 视锥平面由着色器从 global state 的 view projection 中提取，本 pass 在 draw_geometries 之前录制，先写入本帧的 global state
+        vk_copy_data_to_buffer(app->vk_context, &frame->global_state_buffer, &app->global_state, sizeof(GlobalState));
+    }
+
+    VkDescriptorSet descriptor_sets[2];
+    vk_descriptor_allocator_alloc(app->vk_context->device, frame->descriptor_allocator, app->global_state_descriptor_set_layout, &descriptor_sets[0]);
+
+    VkDescriptorBufferInfo descriptor_buffer_info = {};
+    descriptor_buffer_info.buffer = frame->global_state_buffer.handle;
+    descriptor_buffer_info.offset = 0;
+    descriptor_buffer_info.range = sizeof(GlobalState);
+
+    VkWriteDescriptorSet write_descriptor_sets[2] = {{.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET}, {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET}};
+    write_descriptor_sets[0].dstBinding = 0;
+    write_descriptor_sets[0].dstSet = descriptor_sets[0];
+    write_descriptor_sets[0].descriptorCount = 1;
+    write_descriptor_sets[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    write_descriptor_sets[0].pBufferInfo = &descriptor_buffer_info;
+
+    // 第一阶段不采样金字塔，仍需绑定；金字塔始终处于 GENERAL
+    uint32_t descriptor_set_count = 1;
+    VkDescriptorImageInfo descriptor_image_info = {};
+    if (app->is_occlusion_culling_enabled) {
+        vk_descriptor_allocator_alloc(app->vk_context->device, frame->descriptor_allocator, app->single_combined_image_sampler_descriptor_set_layout,
+                                      &descriptor_sets[1]);
+
+        descriptor_image_info.sampler = app->default_sampler_nearest;
+        descriptor_image_info.imageView = app->depth_pyramid_view;
+        descriptor_image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        write_descriptor_sets[1].dstBinding = 0;
+        write_descriptor_sets[1].dstSet = descriptor_sets[1];
+        write_descriptor_sets[1].descriptorCount = 1;
+        write_descriptor_sets[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write_descriptor_sets[1].pImageInfo = &descriptor_image_info;
+        descriptor_set_count = 2;
+    }
+    vk_update_descriptor_sets(app->vk_context->device, descriptor_set_count, write_descriptor_sets);
+
+    vk_command_bind_pipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, app->draw_cull_pipeline);
+    vk_command_bind_descriptor_sets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, app->draw_cull_pipeline_layout, 0, descriptor_set_count, descriptor_sets);
+
+    DrawCullState cull_state{};
+    cull_state.instance_buffer_device_address = frame->instance_buffer_device_address;
+    cull_state.draw_item_buffer_device_address = frame->draw_item_buffer_device_address;
+    cull_state.draw_buffer_device_address = frame->indirect_draw_buffer_device_address;
+    cull_state.cull_stats_buffer_device_address = frame->cull_stats_buffer_device_address;
+    cull_state.draw_item_count = app->draw_stats.draw_count;
+    cull_state.phase = phase;
+    if (app->is_occlusion_culling_enabled) {
+        cull_state.visibility_buffer_device_address = app->draw_visibility_buffer_device_address;
+        cull_state.late_draw_offset = app->draw_buffer_size;
+        cull_state.depth_pyramid_level_count = app->depth_pyramid->mip_levels;
+        cull_state.depth_pyramid_size = glm::vec2(app->depth_pyramid_width, app->depth_pyramid_height);
+    }
+    vk_command_push_constants(command_buffer, app->draw_cull_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(DrawCullState), &cull_state);
+    vk_command_dispatch(command_buffer, (cull_state.draw_item_count + DRAW_CULL_GROUP_SIZE - 1) / DRAW_CULL_GROUP_SIZE, 1, 1);
+
+    if (phase == DRAW_PHASE_EARLY && app->is_cluster_culling_enabled) {
+        vk_buffer_barrier(command_buffer, &frame->indirect_draw_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                          VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    }
+}
+
+// 逐层归约第一阶段的深度，第 0 层读取深度图，之后每层读取上一层；层与层之间的同步在这里完成，之后由 frame graph 完成
+static void build_depth_pyramid(App *app, VkCommandBuffer command_buffer) {
+    RenderFrame *frame = &app->frames[app->frame_index];
+    vk_command_bind_pipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, app->depth_pyramid_pipeline);
+
+    uint32_t source_width = app->vk_context->swapchain_extent.width, source_height = app->vk_context->swapchain_extent.height;
+    for (uint32_t level = 0; level < app->depth_pyramid->mip_levels; ++level) {
+        uint32_t width = std::max(app->depth_pyramid_width >> level, 1u), height = std::max(app->depth_pyramid_height >> level, 1u);
+
+        VkDescriptorSet descriptor_set;
+        vk_descriptor_allocator_alloc(app->vk_context->device, frame->descriptor_allocator, app->depth_pyramid_descriptor_set_layout, &descriptor_set);
+
+        VkDescriptorImageInfo source_image_info = {};
+        source_image_info.sampler = app->default_sampler_nearest;
+        source_image_info.imageView = level == 0 ? app->depth_image_view : app->depth_pyramid_level_views[level - 1];
+        source_image_info.imageLayout = level == 0 ? VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+        VkDescriptorImageInfo destination_image_info = {};
+        destination_image_info.imageView = app->depth_pyramid_level_views[level];
+        destination_image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet write_descriptor_sets[2] = {{.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET}, {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET}};
+        write_descriptor_sets[0].dstBinding = 0;
+        write_descriptor_sets[0].dstSet = descriptor_set;
+        write_descriptor_sets[0].descriptorCount = 1;
+        write_descriptor_sets[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write_descriptor_sets[0].pImageInfo = &source_image_info;
+        write_descriptor_sets[1].dstBinding = 1;
+        write_descriptor_sets[1].dstSet = descriptor_set;
+        write_descriptor_sets[1].descriptorCount = 1;
+        write_descriptor_sets[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        write_descriptor_sets[1].pImageInfo = &destination_image_info;
+        vk_update_descriptor_sets(app->vk_context->device, 2, write_descriptor_sets);
+
+        vk_command_bind_descriptor_sets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, app->depth_pyramid_pipeline_layout, 0, 1, &descriptor_set);
+
+        DepthPyramidState pyramid_state{};
+        pyramid_state.source_size = glm::uvec2(source_width, source_height);
+        pyramid_state.destination_size = glm::uvec2(width, height);
+        pyramid_state.is_depth_source = level == 0;
+        vk_command_push_constants(command_buffer, app->depth_pyramid_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(DepthPyramidState), &pyramid_state);
+        vk_command_dispatch(command_buffer, (width + DEPTH_PYRAMID_GROUP_SIZE - 1) / DEPTH_PYRAMID_GROUP_SIZE,
+                            (height + DEPTH_PYRAMID_GROUP_SIZE - 1) / DEPTH_PYRAMID_GROUP_SIZE, 1);
+
+        if (level + 1 < app->depth_pyramid->mip_levels) {
+            vk_transition_image_levels(command_buffer, app->depth_pyramid->image, level, 1, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                       VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                                       VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+        }
+        source_width = width;
+        source_height = height;
+    }
+}
+
+// 在帧的 fence 之后调用，读到的是 FRAMES_IN_FLIGHT 帧之前 cull_draws 的结果，读取后清零供本帧累计
+static void read_draw_cull_stats(App *app, RenderFrame *frame) {
+    if (!app->is_gpu_driven_enabled) { return; }
+
+    DrawCullStats stats;
+    vk_copy_data_from_buffer(app->vk_context, &frame->cull_stats_buffer, &stats, sizeof(DrawCullStats));
+    if (memcmp(&stats, &app->draw_cull_stats, sizeof(DrawCullStats)) != 0) {
+        if (app->is_occlusion_culling_enabled) {
+            // 遮挡率为视锥内的绘制项中被遮挡的比例
+            uint32_t in_frustum_count = stats.visible_count + stats.occluded_count;
+            log_debug("occlusion culling: %u early, %u late draws, %u frustum culled, %u occluded draws (%.1f%%)", stats.early_draw_count,
+                      stats.late_draw_count, stats.culled_count, stats.occluded_count,
+                      in_frustum_count > 0 ? 100.0f * stats.occluded_count / in_frustum_count : 0.0f);
+        } else {
+            log_debug("frustum culling: %u visible, %u culled draws", stats.visible_count, stats.culled_count);
+        }
+    }
+    app->draw_cull_stats = stats;
+
+    DrawCullStats zero{};
+    vk_copy_data_to_buffer(app->vk_context, &frame->cull_stats_buffer, &zero, sizeof(DrawCullStats));
+}
+
+// 按 meshlet 剔除 lod 0 的实例，写出压缩后的绘制命令，需在 draw_geometries 之前、渲染之外录制；之后的同步由 frame graph 完成
+// gpu driven 绘制时命令追加到 build_draw_batches 分配的批次中，否则每个实例在 cluster draw buffer 中各有一段
+void cull_clusters(App *app, VkCommandBuffer command_buffer) {
+    if (!app->is_cluster_culling_enabled) { return; }
+
+    RenderFrame *frame = &app->frames[app->frame_index];
+    Geometry *geometry = &app->gltf_model_geometry;
+
+    VkDeviceAddress draw_buffer_device_address = frame->indirect_draw_buffer_device_address;
+    if (!app->is_gpu_driven_enabled) {
+        // mesh 随异步加载逐帧增加，每帧重新分配各实例在 cluster draw buffer 中的区域
+        size_t buffer_size = 0;
+        for (MeshInstance &instance: geometry->instances) {
+            instance.cluster_draw_offset = buffer_size;
+            if (instance.mesh_index >= geometry->meshes.size()) { continue; }
+            buffer_size += sizeof(uint32_t) + geometry->meshes[instance.mesh_index].mesh_buffer.meshlet_count * sizeof(VkDrawIndexedIndirectCommand);
+        }
+        if (buffer_size == 0) { return; }
+        reserve_cluster_draw_buffer(app, frame, buffer_size);
+        draw_buffer_device_address = frame->cluster_draw_buffer_device_address;
+
+        // 清零各实例的绘制数，未剔除的实例区域保持为 0 不会被读取
+        vk_command_fill_buffer(command_buffer, frame->cluster_draw_buffer.handle, 0, buffer_size, 0);
+        vk_buffer_barrier(command_buffer, &frame->cluster_draw_buffer, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                          VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    }
+
+    vk_command_bind_pipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, app->cluster_cull_pipeline);
+
+    glm::vec4 frustum_planes[6];
+    camera_get_frustum_planes(&app->camera, app->global_state.projection, frustum_planes);
+
+    for (const MeshInstance &instance: geometry->instances) {
+        const Mesh *mesh = get_instance_mesh(app, geometry, &instance);
+        if (!mesh || !is_cluster_culled(app, geometry, mesh, &instance)) { continue; }
+
+        // 将世界空间的平面与相机变换到模型空间，着色器中无需再变换每个 meshlet
+        const glm::mat4 &model = get_instance_model_matrix(geometry, &instance);
+        glm::mat4 model_transpose = glm::transpose(model);
+
+        ClusterCullState cull_state{};
+        for (uint32_t i = 0; i < 5; ++i) { cull_state.frustum_planes[i] = model_transpose * frustum_planes[i]; } // 远平面不参与剔除
+        cull_state.camera_position = glm::vec4(glm::vec3(glm::inverse(model) * glm::vec4(app->camera.position, 1.0f)), get_max_scale(model));
+        cull_state.meshlet_buffer_device_address = mesh->mesh_buffer.meshlet_buffer_device_address;
+        cull_state.draw_buffer_device_address = draw_buffer_device_address + instance.cluster_draw_offset;
+        cull_state.meshlet_count = mesh->mesh_buffer.meshlet_count;
+        cull_state.first_index = get_first_index(&mesh->mesh_buffer, mesh->primitives[0].index_type);
+        cull_state.first_instance = app->is_gpu_driven_enabled ? instance.instance_data_index : 0;
+
+        vk_command_push_constants(command_buffer, app->cluster_cull_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(ClusterCullState), &cull_state);
+        vk_command_dispatch(command_buffer, (cull_state.meshlet_count + CLUSTER_CULL_GROUP_SIZE - 1) / CLUSTER_CULL_GROUP_SIZE, 1, 1);
+    }
+}
+
+// 材质下标为 -1 时使用 [0] 的默认材质，与已绑定的相同时跳过
+static void bind_material(const App *app, const VkDescriptorSet *material_descriptor_sets, int32_t material_index,
+                          VkDescriptorSet *bound_material_descriptor_set, VkCommandBuffer command_buffer) {
+    VkDescriptorSet descriptor_set = material_descriptor_sets[material_index + 1];
+    if (descriptor_set == *bound_material_descriptor_set) { return; }
+    vk_command_bind_descriptor_sets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->mesh_pipeline_layout, 1, 1, &descriptor_set);
+    *bound_material_descriptor_set = descriptor_set;
+}
+
+// 所有 mesh 的索引都在 arena 中，索引缓冲始终从 0 绑定，只在索引类型变化时重新绑定
+static void bind_index_type(const App *app, IndexType index_type, IndexType *bound_index_type, VkCommandBuffer command_buffer) {
+    if (index_type == *bound_index_type) { return; }
+    vk_command_bind_index_buffer(command_buffer, app->geometry_arena->index_buffer.handle, 0, get_vk_index_type(index_type));
+    *bound_index_type = index_type;
+}
+
+// 绘制实例当前 lod 的所有 primitive，lod 0 且开启 cluster culling 时改为绘制剔除后的 meshlet
+// `material_descriptor_sets` 为 nullptr 时不绑定材质（线框）
+static void draw_mesh(const App *app, const Geometry *geometry, const Mesh *mesh, const MeshInstance *instance, const VkDescriptorSet *material_descriptor_sets,
+                      VkDescriptorSet *bound_material_descriptor_set, IndexType *bound_index_type, VkCommandBuffer command_buffer) {
+    if (is_cluster_culled(app, geometry, mesh, instance)) {
+        bind_index_type(app, mesh->primitives[0].index_type, bound_index_type, command_buffer);
+        if (material_descriptor_sets) {
+            bind_material(app, material_descriptor_sets, mesh->primitives[0].material_index, bound_material_descriptor_set, command_buffer);
+        }
+        const Buffer *draw_buffer = &app->frames[app->frame_index].cluster_draw_buffer;
+        vk_command_draw_indexed_indirect_count(command_buffer, draw_buffer->handle, instance->cluster_draw_offset + sizeof(uint32_t), draw_buffer->handle,
+                                               instance->cluster_draw_offset, mesh->mesh_buffer.meshlet_count, sizeof(VkDrawIndexedIndirectCommand));
+        return;
+    }
+
+    for (const Primitive &primitive: mesh->primitives) {
+        if (material_descriptor_sets) { bind_material(app, material_descriptor_sets, primitive.material_index, bound_material_descriptor_set, command_buffer); }
+        bind_index_type(app, primitive.index_type, bound_index_type, command_buffer);
+        const PrimitiveLod *lod = get_primitive_lod(&primitive, instance->lod_level);
+        vk_command_draw_indexed(command_buffer, lod->index_count, 1, get_first_index(&mesh->mesh_buffer, primitive.index_type) + lod->index_offset,
+                                primitive.vertex_offset, 0);
+    }
+}
+
+// 每个批次一次 vkCmdDrawIndexedIndirectCount，`material_descriptor_sets` 为 nullptr 时不绑定材质（线框）
+// `phase` 决定读取 indirect draw buffer 中哪个阶段的命令
+static void draw_indirect_batches(const App *app, DrawPhase phase, const VkPipeline *pipelines, VkPipelineLayout pipeline_layout,
+                                  const VkDescriptorSet *material_descriptor_sets, IndexType *bound_index_type, VkCommandBuffer command_buffer) {
+    const RenderFrame *frame = &app->frames[app->frame_index];
+    if (app->draw_batches.empty()) { return; }
+
+    DrawState draw_state{};
+    draw_state.instance_buffer_device_address = frame->instance_buffer_device_address;
+    vk_command_push_constants(command_buffer, pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, sizeof(DrawState), &draw_state);
+
+    VkPipeline bound_pipeline = VK_NULL_HANDLE;
+    VkDescriptorSet bound_material_descriptor_set = VK_NULL_HANDLE;
+    for (const DrawBatch &batch: app->draw_batches) {
+        VkPipeline pipeline = pipelines[batch.vertex_layout];
+        if (pipeline != bound_pipeline) {
+            vk_command_bind_pipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            bound_pipeline = pipeline;
+        }
+        if (material_descriptor_sets) { bind_material(app, material_descriptor_sets, batch.material_index, &bound_material_descriptor_set, command_buffer); }
+        bind_index_type(app, batch.index_type, bound_index_type, command_buffer);
+        uint32_t offset = phase * app->draw_buffer_size + batch.offset;
+        vk_command_draw_indexed_indirect_count(command_buffer, frame->indirect_draw_buffer.handle, offset + sizeof(uint32_t),
+                                               frame->indirect_draw_buffer.handle, offset, batch.max_draw_count, sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
+
+// 第二阶段在第一阶段的深度上补画；开启遮挡剔除时第一阶段的深度需保留，用于构建金字塔
+void draw_geometries(const App *app, DrawPhase phase, VkCommandBuffer command_buffer) {
     const RenderFrame *frame = &app->frames[app->frame_index];
 
     VkRenderingAttachmentInfo color_attachment = {.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO};
@@ -349,18 +1278,17 @@ void draw_geometries(const App *app, VkCommandBuffer command_buffer) {
     VkRenderingAttachmentInfo depth_attachment = {.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO};
     depth_attachment.imageView = app->depth_image_view;
     depth_attachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
-    depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depth_attachment.loadOp = phase == DRAW_PHASE_LATE ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depth_attachment.storeOp = app->is_occlusion_culling_enabled && phase == DRAW_PHASE_EARLY ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
     depth_attachment.clearValue.depthStencil.depth = 1.0f;
 
     const VkExtent2D *extent = &app->vk_context->swapchain_extent;
 
     vk_command_begin_rendering(command_buffer, extent, &color_attachment, 1, &depth_attachment);
 
-    vk_command_bind_pipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->mesh_pipeline);
-
     vk_command_set_viewport(command_buffer, 0, 0, extent->width, extent->height);
     vk_command_set_scissor(command_buffer, 0, 0, extent->width, extent->height);
+    IndexType bound_index_type = INDEX_TYPE_COUNT;
     {
         float factor = 2.0;
         vkCmdSetDepthBias(command_buffer, factor, 0.0f, factor);
@@ -391,41 +1319,61 @@ void draw_geometries(const App *app, VkCommandBuffer command_buffer) {
         write_descriptor_set.pBufferInfo = &buffer_infos.back();
         write_descriptor_sets.push_back(write_descriptor_set);
     }
-    {
-        VkDescriptorSet descriptor_set;
-        vk_descriptor_allocator_alloc(app->vk_context->device, frame->descriptor_allocator, app->single_combined_image_sampler_descriptor_set_layout, &descriptor_set);
-        descriptor_sets.push_back(descriptor_set);
+
+    // 每个材质一个 set，[0] 为默认材质；base color 贴图尚未上传完成时使用白色默认贴图
+    const Geometry *geometry = &app->gltf_model_geometry;
+    std::vector<VkDescriptorSet> material_descriptor_sets(geometry->materials.size() + 1);
+    for (size_t i = 0; i < material_descriptor_sets.size(); ++i) {
+        VkImageView image_view = app->default_white_image_view;
+        if (i > 0 && geometry->materials[i - 1].base_color_texture >= 0) {
+            const Texture *texture = &geometry->textures[geometry->materials[i - 1].base_color_texture];
+            if (texture->image && upload_engine_is_available(app->upload_engine, texture->upload_token)) { image_view = texture->image_view; }
+        }
+
+        vk_descriptor_allocator_alloc(app->vk_context->device, frame->descriptor_allocator, app->single_combined_image_sampler_descriptor_set_layout,
+                                      &material_descriptor_sets[i]);
 
         VkDescriptorImageInfo descriptor_image_info = {};
-        descriptor_image_info.sampler = app->default_sampler_nearest;
-        descriptor_image_info.imageView = app->default_checkerboard_image_view;
+        descriptor_image_info.sampler = app->default_sampler_linear_mipmap;
+        descriptor_image_info.imageView = image_view;
         descriptor_image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         image_infos.push_back(descriptor_image_info);
 
         VkWriteDescriptorSet write_descriptor_set = {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
         write_descriptor_set.dstBinding = 0;
-        write_descriptor_set.dstSet = descriptor_sets.back();
+        write_descriptor_set.dstSet = material_descriptor_sets[i];
         write_descriptor_set.descriptorCount = 1;
         write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         write_descriptor_set.pImageInfo = &image_infos.back();
         write_descriptor_sets.push_back(write_descriptor_set);
     }
     vk_update_descriptor_sets(app->vk_context->device, write_descriptor_sets.size(), write_descriptor_sets.data());
-    vk_command_bind_descriptor_sets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->mesh_pipeline_layout, descriptor_sets.size(), descriptor_sets.data());
-
-    for (const Mesh &mesh: app->gltf_model_geometry.meshes) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::scale(model, glm::vec3(0.25f, 0.25f, 0.25f)); // todo use model matrix from mesh itself
-
-        InstanceState instance_state{};
-        instance_state.model = model;
-        instance_state.vertex_buffer_device_address = mesh.mesh_buffer.vertex_buffer_device_address;
+    vk_command_bind_descriptor_sets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->mesh_pipeline_layout, 0, descriptor_sets.size(), descriptor_sets.data());
+
+    // 各顶点格式的 pipeline 共用同一 pipeline layout，切换 pipeline 时已绑定的 descriptor set 保持有效
+    if (app->is_gpu_driven_enabled) {
+        draw_indirect_batches(app, phase, app->indirect_mesh_pipelines, app->mesh_pipeline_layout, material_descriptor_sets.data(), &bound_index_type, command_buffer);
+    } else {
+        VkPipeline bound_pipeline = VK_NULL_HANDLE;
+        VkDescriptorSet bound_material_descriptor_set = VK_NULL_HANDLE;
+        for (uint32_t instance_index = 0; instance_index < geometry->instances.size(); ++instance_index) {
+            const MeshInstance &instance = geometry->instances[instance_index];
+            const Mesh *mesh = get_instance_mesh(app, geometry, &instance);
+            if (!mesh || !is_instance_visible(app, instance_index)) { continue; }
+
+            InstanceState instance_state;
+            VertexLayout vertex_layout;
+            get_instance_state(app, geometry, mesh, &instance, &instance_state, &vertex_layout);
+
+            VkPipeline pipeline = app->mesh_pipelines[vertex_layout];
+            if (pipeline != bound_pipeline) {
+                vk_command_bind_pipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+                bound_pipeline = pipeline;
+            }
 
-        vk_command_push_constants(command_buffer, app->mesh_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, sizeof(InstanceState), &instance_state);
+            vk_command_push_constants(command_buffer, app->mesh_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, sizeof(InstanceState), &instance_state);
 
-        for (const Primitive &primitive: mesh.primitives) {
-            vk_command_bind_index_buffer(command_buffer, mesh.mesh_buffer.index_buffer.handle, primitive.index_offset);
-            vk_command_draw_indexed(command_buffer, primitive.index_count);
+            draw_mesh(app, geometry, mesh, &instance, material_descriptor_sets.data(), &bound_material_descriptor_set, &bound_index_type, command_buffer);
         }
     }
 
@@ -440,63 +1388,65 @@ void draw_geometries(const App *app, VkCommandBuffer command_buffer) {
     //     vk_command_push_constants(command_buffer, app->mesh_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, sizeof(InstanceState), &instance_state);
     //
     //     for (const Primitive &primitive: mesh.primitives) {
-    //         vk_command_bind_index_buffer(command_buffer, mesh.mesh_buffer.index_buffer.handle, primitive.index_offset);
-    //         vk_command_draw_indexed(command_buffer, primitive.index_count);
+    //         vk_command_draw_indexed(command_buffer, primitive.index_count, 1, get_first_index(&mesh.mesh_buffer, primitive.index_type) + primitive.index_offset, primitive.vertex_offset, 0);
     //     }
     // }
 
     // draw wireframe on selected entity
-    vk_command_bind_pipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->wireframe_pipeline);
     {
         float factor = 1.0;
         vkCmdSetDepthBias(command_buffer, factor, 0.0f, factor);
     }
 
-    for (const Mesh &mesh : app->gltf_model_geometry.meshes) {
-        vk_command_set_viewport(command_buffer, 0, 0, extent->width, extent->height);
-        vk_command_set_scissor(command_buffer, 0, 0, extent->width, extent->height);
-        // vkCmdSetDepthBias(command_buffer, 0.5f, 0.0f, 0.5f);
-
-        std::vector<VkDescriptorSet> descriptor_sets; // todo 提前预留空间，防止 resize 导致被其他地方引用的原有元素失效
-        std::deque<VkDescriptorBufferInfo> buffer_infos;
-        std::deque<VkDescriptorImageInfo> image_infos;
-        std::vector<VkWriteDescriptorSet> write_descriptor_sets;
-        {
-            vk_copy_data_to_buffer(app->vk_context, &frame->global_state_buffer, &app->global_state, sizeof(GlobalState));
-
-            VkDescriptorSet descriptor_set;
-            vk_descriptor_allocator_alloc(app->vk_context->device, frame->descriptor_allocator, app->global_state_descriptor_set_layout, &descriptor_set);
-            descriptor_sets.push_back(descriptor_set);
-
-            VkDescriptorBufferInfo descriptor_buffer_info = {};
-            descriptor_buffer_info.buffer = frame->global_state_buffer.handle;
-            descriptor_buffer_info.offset = 0;
-            descriptor_buffer_info.range = sizeof(GlobalState);
-            buffer_infos.push_back(descriptor_buffer_info);
-
-            VkWriteDescriptorSet write_descriptor_set = {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-            write_descriptor_set.dstBinding = 0;
-            write_descriptor_set.dstSet = descriptor_sets.back();
-            write_descriptor_set.descriptorCount = 1;
-            write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            write_descriptor_set.pBufferInfo = &buffer_infos.back();
-            write_descriptor_sets.push_back(write_descriptor_set);
-        }
-        vk_update_descriptor_sets(app->vk_context->device, write_descriptor_sets.size(), write_descriptor_sets.data());
-        vk_command_bind_descriptor_sets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->wireframe_pipeline_layout, descriptor_sets.size(), descriptor_sets.data());
-
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::scale(model, glm::vec3(0.25f, 0.25f, 0.25f)); // todo use model matrix from mesh itself
-
-        InstanceState instance_state{};
-        instance_state.model = model;
-        instance_state.vertex_buffer_device_address = mesh.mesh_buffer.vertex_buffer_device_address;
+    // wireframe 与 mesh 的 pipeline layout 中 set 0 与 push constant 范围相同，已绑定的 global state 保持有效
+    if (app->is_gpu_driven_enabled) {
+        draw_indirect_batches(app, phase, app->indirect_wireframe_pipelines, app->wireframe_pipeline_layout, nullptr, &bound_index_type, command_buffer);
+    } else {
+        for (uint32_t instance_index = 0; instance_index < geometry->instances.size(); ++instance_index) {
+            const MeshInstance &instance = geometry->instances[instance_index];
+            const Mesh *mesh = get_instance_mesh(app, geometry, &instance);
+            if (!mesh || !is_instance_visible(app, instance_index)) { continue; }
+
+            InstanceState instance_state;
+            VertexLayout vertex_layout;
+            get_instance_state(app, geometry, mesh, &instance, &instance_state, &vertex_layout);
+
+            vk_command_bind_pipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->wireframe_pipelines[vertex_layout]);
+            vk_command_set_viewport(command_buffer, 0, 0, extent->width, extent->height);
+            vk_command_set_scissor(command_buffer, 0, 0, extent->width, extent->height);
+            // vkCmdSetDepthBias(command_buffer, 0.5f, 0.0f, 0.5f);
+
+            std::vector<VkDescriptorSet> descriptor_sets; // todo 提前预留空间，防止 resize 导致被其他地方引用的原有元素失效
+            std::deque<VkDescriptorBufferInfo> buffer_infos;
+            std::deque<VkDescriptorImageInfo> image_infos;
+            std::vector<VkWriteDescriptorSet> write_descriptor_sets;
+            {
+                vk_copy_data_to_buffer(app->vk_context, &frame->global_state_buffer, &app->global_state, sizeof(GlobalState));
+
+                VkDescriptorSet descriptor_set;
+                vk_descriptor_allocator_alloc(app->vk_context->device, frame->descriptor_allocator, app->global_state_descriptor_set_layout, &descriptor_set);
+                descriptor_sets.push_back(descriptor_set);
+
+                VkDescriptorBufferInfo descriptor_buffer_info = {};
+                descriptor_buffer_info.buffer = frame->global_state_buffer.handle;
+                descriptor_buffer_info.offset = 0;
+                descriptor_buffer_info.range = sizeof(GlobalState);
+                buffer_infos.push_back(descriptor_buffer_info);
+
+                VkWriteDescriptorSet write_descriptor_set = {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+                write_descriptor_set.dstBinding = 0;
+                write_descriptor_set.dstSet = descriptor_sets.back();
+                write_descriptor_set.descriptorCount = 1;
+                write_descriptor_set.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                write_descriptor_set.pBufferInfo = &buffer_infos.back();
+                write_descriptor_sets.push_back(write_descriptor_set);
+            }
+            vk_update_descriptor_sets(app->vk_context->device, write_descriptor_sets.size(), write_descriptor_sets.data());
+            vk_command_bind_descriptor_sets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->wireframe_pipeline_layout, 0, descriptor_sets.size(), descriptor_sets.data());
 
-        vk_command_push_constants(command_buffer, app->wireframe_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, sizeof(InstanceState), &instance_state);
+            vk_command_push_constants(command_buffer, app->wireframe_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, sizeof(InstanceState), &instance_state);
 
-        for (const Primitive &primitive: mesh.primitives) {
-            vk_command_bind_index_buffer(command_buffer, mesh.mesh_buffer.index_buffer.handle, primitive.index_offset);
-            vk_command_draw_indexed(command_buffer, primitive.index_count);
+            draw_mesh(app, geometry, mesh, &instance, nullptr, nullptr, &bound_index_type, command_buffer);
         }
     }
 
@@ -507,6 +1457,136 @@ void draw_gizmos(const App *app, VkCommandBuffer command_buffer) {}
 
 void draw_gui(const App *app, VkCommandBuffer command_buffer) {}
 
+// 声明每帧的 pass 对各资源的读写，由 frame graph 生成 pass 之间以及跨帧的 barrier
+static void create_frame_graph(App *app) {
+    frame_graph_create(&app->frame_graph);
+    FrameGraph *frame_graph = app->frame_graph;
+
+    app->color_image_resource = frame_graph_import_image(frame_graph, "color_image", VK_IMAGE_ASPECT_COLOR_BIT, true);
+    app->depth_image_resource = frame_graph_import_image(frame_graph, "depth_image", VK_IMAGE_ASPECT_DEPTH_BIT, true);
+    app->swapchain_image_resource = frame_graph_import_image(frame_graph, "swapchain_image", VK_IMAGE_ASPECT_COLOR_BIT, false);
+    // 每帧各有一份，上一次使用已由 in flight fence 等待
+    uint32_t skinned_vertex_buffer = frame_graph_import_buffer(frame_graph, "skinned_vertex_buffer", false);
+    // cluster draw buffer，gpu driven 绘制时为 indirect draw buffer
+    uint32_t draw_command_buffer = frame_graph_import_buffer(frame_graph, "draw_command_buffer", false);
+    // 统计在 fence 之后由 host 读取
+    uint32_t cull_stats_buffer = frame_graph_import_buffer(frame_graph, "cull_stats_buffer", false);
+    // 各帧共用，本帧的第一阶段读取上一帧第二阶段写入的可见性
+    uint32_t visibility_buffer = frame_graph_import_buffer(frame_graph, "visibility_buffer", true);
+    if (app->is_occlusion_culling_enabled) {
+        app->depth_pyramid_resource = frame_graph_import_image(frame_graph, "depth_pyramid", VK_IMAGE_ASPECT_COLOR_BIT, true);
+    }
+    // 交给 present，由 render finished semaphore 在 color attachment output 阶段等待
+    frame_graph_set_output(frame_graph, app->swapchain_image_resource, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE,
+                           VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    uint32_t pass = frame_graph_add_pass(frame_graph, "background", [app](VkCommandBuffer command_buffer) { draw_background(app, command_buffer); });
+    frame_graph_write(frame_graph, pass, app->color_image_resource, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_GENERAL);
+
+    pass = frame_graph_add_pass(frame_graph, "skinning", [app](VkCommandBuffer command_buffer) { skin_instances(app, command_buffer); });
+    frame_graph_write(frame_graph, pass, skinned_vertex_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_UNDEFINED);
+
+    // gpu driven 绘制时先由 cpu 写出实例数据与绘制项，视锥剔除写出可见的命令，cluster culling 再追加；清零与剔除之间的同步在 pass 内部完成
+    pass = frame_graph_add_pass(frame_graph, "draw_commands", [app](VkCommandBuffer command_buffer) {
+        build_draw_batches(app);
+        cull_draws(app, DRAW_PHASE_EARLY, command_buffer);
+        cull_clusters(app, command_buffer);
+    });
+    if (app->is_gpu_driven_enabled) {
+        frame_graph_set_output(frame_graph, cull_stats_buffer, VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+        frame_graph_read(frame_graph, pass, cull_stats_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                         VK_IMAGE_LAYOUT_UNDEFINED);
+        frame_graph_write(frame_graph, pass, cull_stats_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                          VK_IMAGE_LAYOUT_UNDEFINED);
+    }
+    if (app->is_occlusion_culling_enabled) { // 绘制项数变化时在 pass 内部重置
+        frame_graph_read(frame_graph, pass, visibility_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                         VK_IMAGE_LAYOUT_UNDEFINED);
+        frame_graph_write(frame_graph, pass, visibility_buffer, VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                          VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+    }
+    frame_graph_write(frame_graph, pass, draw_command_buffer, VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                      VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+
+    // 开启遮挡剔除时 gizmo 与 gui 在第二阶段之后绘制
+    pass = frame_graph_add_pass(frame_graph, "scene", [app](VkCommandBuffer command_buffer) {
+        draw_geometries(app, DRAW_PHASE_EARLY, command_buffer);
+        if (app->is_occlusion_culling_enabled) { return; }
+        draw_gizmos(app, command_buffer);
+        draw_gui(app, command_buffer);
+    });
+    frame_graph_read(frame_graph, pass, skinned_vertex_buffer, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                     VK_IMAGE_LAYOUT_UNDEFINED);
+    if (app->is_cluster_culling_enabled || app->is_gpu_driven_enabled) { // 否则不读取绘制命令，draw_commands 被剔除
+        frame_graph_read(frame_graph, pass, draw_command_buffer, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                         VK_IMAGE_LAYOUT_UNDEFINED);
+    }
+    frame_graph_read(frame_graph, pass, app->color_image_resource, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT,
+                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    frame_graph_write(frame_graph, pass, app->color_image_resource, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    // depth 每帧清除，只写即可
+    frame_graph_write(frame_graph, pass, app->depth_image_resource, VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                      VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+
+    if (app->is_occlusion_culling_enabled) {
+        pass = frame_graph_add_pass(frame_graph, "depth_pyramid", [app](VkCommandBuffer command_buffer) { build_depth_pyramid(app, command_buffer); });
+        frame_graph_read(frame_graph, pass, app->depth_image_resource, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                         VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL);
+        frame_graph_write(frame_graph, pass, app->depth_pyramid_resource, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                          VK_IMAGE_LAYOUT_GENERAL);
+
+        pass = frame_graph_add_pass(frame_graph, "late_cull", [app](VkCommandBuffer command_buffer) { cull_draws(app, DRAW_PHASE_LATE, command_buffer); });
+        frame_graph_read(frame_graph, pass, app->depth_pyramid_resource, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                         VK_IMAGE_LAYOUT_GENERAL);
+        frame_graph_read(frame_graph, pass, visibility_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                         VK_IMAGE_LAYOUT_UNDEFINED);
+        frame_graph_write(frame_graph, pass, visibility_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                          VK_IMAGE_LAYOUT_UNDEFINED);
+        frame_graph_read(frame_graph, pass, cull_stats_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                         VK_IMAGE_LAYOUT_UNDEFINED);
+        frame_graph_write(frame_graph, pass, cull_stats_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                          VK_IMAGE_LAYOUT_UNDEFINED);
+        // 第二阶段的区域已在第一阶段清零，这里只追加
+        frame_graph_read(frame_graph, pass, draw_command_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                         VK_IMAGE_LAYOUT_UNDEFINED);
+        frame_graph_write(frame_graph, pass, draw_command_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                          VK_IMAGE_LAYOUT_UNDEFINED);
+
+        pass = frame_graph_add_pass(frame_graph, "scene_late", [app](VkCommandBuffer command_buffer) {
+            draw_geometries(app, DRAW_PHASE_LATE, command_buffer);
+            draw_gizmos(app, command_buffer);
+            draw_gui(app, command_buffer);
+        });
+        frame_graph_read(frame_graph, pass, skinned_vertex_buffer, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                         VK_IMAGE_LAYOUT_UNDEFINED);
+        frame_graph_read(frame_graph, pass, draw_command_buffer, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                         VK_IMAGE_LAYOUT_UNDEFINED);
+        frame_graph_read(frame_graph, pass, app->color_image_resource, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT,
+                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        frame_graph_write(frame_graph, pass, app->color_image_resource, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                          VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        // 在第一阶段的深度上继续测试与写入
+        frame_graph_read(frame_graph, pass, app->depth_image_resource, VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                         VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+        frame_graph_write(frame_graph, pass, app->depth_image_resource, VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                          VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+    }
+
+    pass = frame_graph_add_pass(frame_graph, "present_blit", [app](VkCommandBuffer command_buffer) {
+        vk_command_blit_image(command_buffer, app->color_image->image, frame_graph_get_image(app->frame_graph, app->swapchain_image_resource),
+                              app->vk_context->swapchain_extent.width, app->vk_context->swapchain_extent.height);
+    });
+    frame_graph_read(frame_graph, pass, app->color_image_resource, VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    frame_graph_write(frame_graph, pass, app->swapchain_image_resource, VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    frame_graph_compile(frame_graph);
+}
+
 void update_scene(App *app) {
     camera_update(&app->camera);
 
@@ -520,6 +1600,21 @@ void update_scene(App *app) {
     app->global_state.projection = projection;
 
     app->global_state.sunlight_dir = glm::normalize(glm::vec3(1.0f, 1.0f, 1.0f));
+
+    // 只重算局部变换被修改过的子树，异步加载追加的节点在此计算初始的世界矩阵
+    update_transform_hierarchy(&app->gltf_model_geometry.transform_hierarchy);
+    update_transform_hierarchy(&app->quad_geometry.transform_hierarchy);
+
+    // 动画读取关节父节点的世界矩阵，在节点层级更新之后采样
+    uint64_t now = timer_now_ns();
+    float delta_seconds = app->last_update_time_ns > 0 ? (now - app->last_update_time_ns) * 1e-9f : 0.0f;
+    app->last_update_time_ns = now;
+    animation_system_sync(app->animation_system, &app->gltf_model_geometry);
+    animation_system_update(app->animation_system, &app->gltf_model_geometry, delta_seconds);
+
+    select_lods(app);
+    cull_instances(app);
+    request_texture_levels(app);
 }
 
 void app_update(App *app) {
@@ -532,8 +1627,27 @@ void app_update(App *app) {
     vk_wait_fence(app->vk_context->device, frame->in_flight_fence);
     vk_reset_fence(app->vk_context->device, frame->in_flight_fence);
 
+    read_draw_cull_stats(app, frame);
+
     vk_descriptor_allocator_reset(app->vk_context->device, frame->descriptor_allocator);
 
+    // 交接后台导入完成的 mesh，随本帧之前的上传一起提交
+    asset_loader_update(app->asset_loader, ASSET_HANDOFF_BUDGET_BYTES);
+    if (app->gltf_model_request && asset_loader_get_status(app->asset_loader, app->gltf_model_request) >= ASSET_REQUEST_STATUS_COMPLETE) {
+        app->gltf_model_request = 0;
+        geometry_arena_log_stats(app->geometry_arena);
+        upload_engine_log_stats(app->upload_engine);
+        asset_loader_log_stats(app->asset_loader);
+        texture_streamer_log_stats(app->texture_streamer, &app->gltf_model_geometry, app->frame_number);
+    }
+
+    // 按 update_scene 中记录的需求流式加载贴图的 mip，替换的 image 在之后的帧中销毁
+    texture_streamer_update(app->texture_streamer, &app->gltf_model_geometry, app->frame_number);
+
+    // 提交本帧之前录制的上传，并回收已完成批次的 staging 空间
+    upload_engine_flush(app->upload_engine);
+    upload_engine_poll(app->upload_engine);
+
     uint32_t image_index;
     VkResult result = vk_acquire_next_image(app->vk_context, frame->image_acquired_semaphore, &image_index);
     ASSERT(result == VK_SUCCESS);
@@ -546,35 +1660,13 @@ void app_update(App *app) {
     {
         vk_begin_one_flight_command_buffer(command_buffer);
 
-        vk_transition_image_layout(command_buffer, app->color_image->image,
-                                   VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT |
-                                   VK_PIPELINE_STAGE_2_BLIT_BIT, // could be in layout transition or computer shader writing or blit operation of current frame or previous frame
-                                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
-                                   VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT |
-                                   VK_ACCESS_2_TRANSFER_READ_BIT,
-                                   VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
-                                   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
-
-        draw_background(app, command_buffer);
-
-        vk_transition_image_layout(command_buffer, app->color_image->image, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-
-        draw_geometries(app, command_buffer); // draw scene
-        draw_gizmos(app, command_buffer);
-        draw_gui(app, command_buffer);
-
-        vk_transition_image_layout(command_buffer, app->color_image->image,
-                                   VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-                                   VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-                                   VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-                                   VK_ACCESS_2_TRANSFER_READ_BIT,
-                                   VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-
-        vk_transition_image_layout(command_buffer, swapchain_image, VK_PIPELINE_STAGE_2_NONE, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        upload_engine_record_acquire_barriers(app->upload_engine, command_buffer);
 
-        vk_command_blit_image(command_buffer, app->color_image->image, swapchain_image, app->vk_context->swapchain_extent.width, app->vk_context->swapchain_extent.height);
-
-        vk_transition_image_layout(command_buffer, swapchain_image, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        frame_graph_set_image(app->frame_graph, app->color_image_resource, app->color_image->image);
+        frame_graph_set_image(app->frame_graph, app->depth_image_resource, app->depth_image->image);
+        if (app->is_occlusion_culling_enabled) { frame_graph_set_image(app->frame_graph, app->depth_pyramid_resource, app->depth_pyramid->image); }
+        frame_graph_set_image(app->frame_graph, app->swapchain_image_resource, swapchain_image);
+        frame_graph_execute(app->frame_graph, command_buffer);
 
         vk_end_command_buffer(command_buffer);
     }
@@ -617,6 +1709,11 @@ void app_resize(App *app, uint32_t width, uint32_t height) {
 
     create_color_image(app, VK_FORMAT_R16G16B16A16_SFLOAT);
     create_depth_image(app, VK_FORMAT_D32_SFLOAT);
+
+    if (app->is_occlusion_culling_enabled) {
+        destroy_depth_pyramid(app);
+        create_depth_pyramid(app);
+    }
 }
 
 void app_key_up(App *app, Key key) {
@@ -650,6 +1747,14 @@ void app_key_up(App *app, Key key) {
     } else if (key == KEY_RIGHT) {
         Camera *camera = &app->camera;
         camera_yaw(camera, -2.0f);
+    } else if (key == KEY_SPACE) {
+        frustum_cull_benchmark(FRUSTUM_CULL_BENCHMARK_BOX_COUNT, FRUSTUM_CULL_BENCHMARK_ITERATION_COUNT);
+        accessor_decode_benchmark(ACCESSOR_DECODE_BENCHMARK_ELEMENT_COUNT, ACCESSOR_DECODE_BENCHMARK_ITERATION_COUNT);
+        if (app->animation_system->skeletons.empty()) {
+            log_info("animation benchmark skipped, no skeleton loaded");
+            return;
+        }
+        animation_benchmark(app->animation_system, &app->gltf_model_geometry, 0, ANIMATION_BENCHMARK_INSTANCE_COUNT, ANIMATION_BENCHMARK_ITERATION_COUNT);
     }
 }
 
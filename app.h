@@ -1,9 +1,12 @@
 #pragma once
 
+#include "asset_loader.h"
 #include "camera.h"
+#include "frustum_cull.h"
 #include "mesh_loader.h"
 #include "input_system.h"
 #include <cstdint>
+#include <unordered_map>
 #include <volk.h>
 #include <vk_mem_alloc.h>
 
@@ -12,9 +15,34 @@ struct SDL_Window;
 struct ImGuiContext;
 struct Image;
 struct DescriptorAllocator;
+struct ThreadPool;
+struct UploadEngine;
+struct TextureStreamer;
+struct AnimationSystem;
+struct FrameGraph;
 
 #define FRAMES_IN_FLIGHT 2
 
+#define UPLOAD_RING_CAPACITY (64 << 20)
+#define GEOMETRY_ARENA_VERTEX_CAPACITY (256 << 20)
+#define GEOMETRY_ARENA_INDEX_CAPACITY (64 << 20)
+
+#define ASSET_LOADER_MAX_IMPORTING_COUNT 2
+#define ASSET_HANDOFF_BUDGET_BYTES (4 << 20) // 每帧最多交给 upload engine 的字节数，限制主线程拷贝 staging 的耗时
+
+#define TEXTURE_BUDGET_CAP_BYTES (256ull << 20) // 贴图显存上限，支持 VK_EXT_memory_budget 时还受 heap 剩余预算限制
+#define TEXTURE_STREAM_BUDGET_BYTES (4 << 20)   // 每帧流式加载最多拷入 staging 的字节数
+
+#define LOD_ERROR_THRESHOLD_PIXELS 1.0f // lod 简化误差投影到屏幕上的最大像素数
+#define CLUSTER_CULL_GROUP_SIZE 64 // 与 shaders/cluster_cull.comp 中的 local_size_x 对应
+#define SKINNING_GROUP_SIZE 64 // 与 shaders/skinning.comp 中的 local_size_x 对应
+#define DRAW_CULL_GROUP_SIZE 64 // 与 shaders/draw_cull.comp 中的 local_size_x 对应
+#define DEPTH_PYRAMID_GROUP_SIZE 8 // 与 shaders/depth_pyramid.comp 中的 local_size_x/y 对应
+#define ANIMATION_BENCHMARK_INSTANCE_COUNT 1024 // 按空格键时以第一个骨骼构造的实例数
+#define ANIMATION_BENCHMARK_ITERATION_COUNT 100
+
+#define LOD_HYSTERESIS 0.25f            // 切换到更粗的 lod 时要求误差低于阈值的 (1 - LOD_HYSTERESIS)，避免在边界来回切换
+
 struct RenderFrame {
     VkCommandPool command_pool;
     VkCommandBuffer command_buffer;
@@ -26,6 +54,41 @@ struct RenderFrame {
     DescriptorAllocator *descriptor_allocator;
 
     Buffer global_state_buffer;
+
+    // 每个实例一段：u32 绘制数 + 至多 meshlet_count 个 VkDrawIndexedIndirectCommand，由 cluster culling 每帧重写
+    Buffer cluster_draw_buffer;
+    VkDeviceAddress cluster_draw_buffer_device_address;
+    size_t cluster_draw_buffer_size; // 容量，mesh 随异步加载增加时按需扩大
+
+    // 每个蒙皮实例一段与其 mesh 顶点一一对应的 Vertex，由 skinning 每帧重写，各 pass 通过 device address 读取
+    Buffer skinned_vertex_buffer;
+    VkDeviceAddress skinned_vertex_buffer_device_address;
+    size_t skinned_vertex_buffer_size;
+
+    // 各蒙皮实例的关节矩阵，cpu 每帧写入
+    Buffer joint_matrix_buffer;
+    VkDeviceAddress joint_matrix_buffer_device_address;
+    size_t joint_matrix_buffer_size;
+
+    // gpu driven 绘制时每个绘制项一个 InstanceData，着色器以 gl_InstanceIndex（即命令的 firstInstance）读取，cpu 每帧写入
+    Buffer instance_buffer;
+    VkDeviceAddress instance_buffer_device_address;
+    size_t instance_buffer_size;
+
+    // gpu driven 绘制时每个绘制项一个 DrawItem，cpu 每帧写入，由视锥剔除读取
+    Buffer draw_item_buffer;
+    VkDeviceAddress draw_item_buffer_device_address;
+    size_t draw_item_buffer_size;
+
+    // gpu driven 绘制时每个批次一段：u32 绘制数 + 至多 DrawBatch::max_draw_count 个 VkDrawIndexedIndirectCommand
+    // 视锥剔除每帧清零并写入可见绘制项的命令，cluster culling 再追加剔除后的 meshlet
+    Buffer indirect_draw_buffer;
+    VkDeviceAddress indirect_draw_buffer_device_address;
+    size_t indirect_draw_buffer_size;
+
+    // 视锥剔除的统计，host 可见，在该帧的 fence 之后读取
+    Buffer cull_stats_buffer;
+    VkDeviceAddress cull_stats_buffer_device_address;
 };
 
 struct GlobalState {
@@ -35,25 +98,159 @@ struct GlobalState {
     // glm::vec4 sunlight_color; // sunlight color and intensity ( power )
 };
 
+// 每帧 lod 选择的结果
+struct LodStats {
+    uint32_t triangle_count;
+    uint32_t instance_counts[PRIMITIVE_MAX_LOD_COUNT]; // 选择各级 lod 的实例数
+};
+
+// 与 shaders/instance_state.glsl 中的 push constant 布局对应
 struct InstanceState {
     glm::mat4 model;
     VkDeviceAddress vertex_buffer_device_address;
+    VkDeviceAddress position_buffer_device_address; // 为 0 时 wireframe 从完整顶点中读取位置
+    alignas(16) glm::vec4 position_offset; // 压缩顶点的位置还原参数，见 VertexQuantization
+    glm::vec4 position_scale;
+};
+
+// 与 shaders/instance_state.glsl 中 INDIRECT_DRAW 的 InstanceData 对应
+struct InstanceData {
+    glm::mat4 model;
+    VkDeviceAddress vertex_buffer_device_address;
+    VkDeviceAddress position_buffer_device_address;
+    alignas(16) glm::vec4 position_offset;
+    glm::vec4 position_scale;
+    glm::vec4 bounding_sphere; // 模型空间，xyz 为中心，w 为半径，为负时不做视锥与遮挡剔除
+    int32_t material_index; // 绘制项的材质，-1 为默认材质；批次按材质划分，着色器暂不读取
+    uint32_t padding[3];
+};
+
+static_assert(sizeof(InstanceData) == 144, "InstanceData must match the std430 layout in shaders/instance_data.glsl");
+
+// 与 shaders/draw_cull.comp 中的 DrawItem 对应，gpu driven 绘制的一个绘制项，对应实例的一个 primitive
+struct DrawItem {
+    VkDrawIndexedIndirectCommand command; // firstInstance 为绘制项的 InstanceData 下标
+    uint32_t batch_offset;                // 所在批次在 indirect draw buffer 中的字节偏移
+};
+
+static_assert(sizeof(DrawItem) == 24, "DrawItem must match the std430 layout in shaders/draw_cull.comp");
+
+// 开启遮挡剔除时每帧分两个阶段剔除与绘制，各阶段的命令在 indirect draw buffer 中各占 draw_buffer_size 字节
+enum DrawPhase : uint32_t {
+    DRAW_PHASE_EARLY, // 上一帧可见的绘制项，只做视锥剔除；未开启遮挡剔除时为唯一的阶段
+    DRAW_PHASE_LATE,  // 以第一阶段的深度构建 hi-z，测试所有绘制项，补画第一阶段没有绘制的
+};
+
+// 与 shaders/draw_cull.comp 中的 push constant 布局对应
+struct DrawCullState {
+    VkDeviceAddress instance_buffer_device_address;
+    VkDeviceAddress draw_item_buffer_device_address;
+    VkDeviceAddress draw_buffer_device_address; // indirect draw buffer，各批次的区域见 DrawItem::batch_offset
+    VkDeviceAddress cull_stats_buffer_device_address;
+    VkDeviceAddress visibility_buffer_device_address; // 未开启遮挡剔除时为 0
+    uint32_t draw_item_count;
+    uint32_t phase;
+    uint32_t late_draw_offset; // 第二阶段的命令在 indirect draw buffer 中的起始偏移
+    uint32_t depth_pyramid_level_count;
+    glm::vec2 depth_pyramid_size;
+};
+
+static_assert(sizeof(DrawCullState) == 64, "DrawCullState must match the push constant layout in shaders/draw_cull.comp");
+
+// 与 shaders/draw_cull.comp 中的 CullStatsBuffer 对应，开启遮挡剔除时 visible/culled/occluded 为第二阶段的测试结果
+struct DrawCullStats {
+    uint32_t visible_count;
+    uint32_t culled_count;
+    uint32_t occluded_count;
+    uint32_t early_draw_count; // 第一阶段绘制的上一帧可见的绘制项
+    uint32_t late_draw_count;  // 第二阶段补画的绘制项
+};
+
+// 与 shaders/depth_pyramid.comp 中的 push constant 布局对应
+struct DepthPyramidState {
+    glm::uvec2 source_size;
+    glm::uvec2 destination_size;
+    uint32_t is_depth_source;
+};
+
+// 与 shaders/instance_state.glsl 中 INDIRECT_DRAW 的 push constant 布局对应
+struct DrawState {
+    VkDeviceAddress instance_buffer_device_address;
+};
+
+// gpu driven 绘制的一个批次，批次内的绘制共用 pipeline、索引类型与材质，以一次 vkCmdDrawIndexedIndirectCount 提交
+struct DrawBatch {
+    VertexLayout vertex_layout;
+    IndexType index_type;
+    int32_t material_index;
+    uint32_t draw_count;     // 批次内的绘制项数，视锥剔除前
+    uint32_t max_draw_count; // 另含 cluster culling 至多追加的 meshlet 数
+    uint32_t offset;         // 在 indirect draw buffer 中的字节偏移
+};
+
+// 每帧 gpu driven 绘制的规模
+struct DrawStats {
+    uint32_t batch_count;
+    uint32_t draw_count;
+    uint32_t cluster_instance_count;
+};
+
+// 与 shaders/cluster_cull.comp 中的 push constant 布局对应
+struct ClusterCullState {
+    glm::vec4 frustum_planes[5]; // 模型空间，不含远平面
+    glm::vec4 camera_position;   // xyz 为模型空间的相机位置，w 为模型矩阵的最大缩放
+    VkDeviceAddress meshlet_buffer_device_address;
+    VkDeviceAddress draw_buffer_device_address; // 该实例在 cluster draw buffer 中的区域，gpu driven 绘制时为其批次的区域
+    uint32_t meshlet_count;
+    uint32_t first_index; // mesh 在 arena 索引缓冲中的起始位置，以 mesh 的索引类型计
+    uint32_t first_instance; // gpu driven 绘制时为实例的 InstanceData 下标，否则为 0
+};
+
+// 与 shaders/skinning.comp 中的 push constant 布局对应
+struct SkinningState {
+    VkDeviceAddress vertex_buffer_device_address;
+    VkDeviceAddress skin_buffer_device_address;
+    VkDeviceAddress joint_matrix_buffer_device_address; // 该实例在 joint matrix buffer 中的区域
+    VkDeviceAddress skinned_vertex_buffer_device_address; // 该实例在 skinned vertex buffer 中的区域
+    alignas(16) glm::vec4 position_offset;
+    glm::vec4 position_scale;
+    uint32_t vertex_count;
+};
+
+// 每帧 skinning 的规模
+struct SkinningStats {
+    uint32_t instance_count;
+    uint32_t vertex_count;
+    uint32_t joint_count;
 };
 
 struct App {
     SDL_Window *window;
     VkContext *vk_context;
+    ThreadPool *thread_pool;
     uint64_t frame_number;
     uint32_t frame_index;
+    uint64_t last_update_time_ns; // 上一次 update_scene 的时间，0 表示尚未更新
 
     RenderFrame frames[FRAMES_IN_FLIGHT];
 
+    UploadEngine *upload_engine;
+    TextureStreamer *texture_streamer;
+    AnimationSystem *animation_system;
+
     Image *color_image;
     VkImageView color_image_view;
 
     Image *depth_image;
     VkImageView depth_image_view;
 
+    // 每帧的 pass 与资源在创建时声明并编译一次，image 句柄在每帧执行前设置
+    FrameGraph *frame_graph;
+    uint32_t color_image_resource;
+    uint32_t depth_image_resource;
+    uint32_t depth_pyramid_resource; // 仅在开启遮挡剔除时导入
+    uint32_t swapchain_image_resource;
+
     VkDescriptorSetLayout single_storage_image_descriptor_set_layout;
     VkDescriptorSetLayout single_combined_image_sampler_descriptor_set_layout;
     VkDescriptorSetLayout global_state_descriptor_set_layout;
@@ -61,28 +258,76 @@ struct App {
     VkPipelineLayout compute_pipeline_layout;
     VkPipeline compute_pipeline;
 
+    // lod 0 的实例按 meshlet 在 gpu 上做视锥与背面剔除，再以 draw indirect count 绘制
+    bool is_cluster_culling_enabled;
+    VkPipelineLayout cluster_cull_pipeline_layout;
+    VkPipeline cluster_cull_pipeline;
+
+    // 蒙皮实例每帧在 compute 中蒙皮一次，之后所有 pass 都读取蒙皮后的顶点
+    VkPipelineLayout skinning_pipeline_layout;
+    VkPipeline skinning_pipelines[VERTEX_LAYOUT_COUNT]; // 按输入的顶点格式索引
+
     VkPipelineLayout mesh_pipeline_layout;
-    VkPipeline mesh_pipeline;
+    VkPipeline mesh_pipelines[VERTEX_LAYOUT_COUNT]; // 按顶点格式索引
 
     VkPipelineLayout wireframe_pipeline_layout;
-    VkPipeline wireframe_pipeline;
+    VkPipeline wireframe_pipelines[VERTEX_LAYOUT_COUNT];
+
+    // 支持 draw indirect count 与非 0 的 firstInstance 时，场景按批次以 multi draw indirect 提交，录制开销只随批次数增长
+    // 间接绘制的 pipeline 与逐实例的共用 pipeline layout，push constant 只有 DrawState
+    bool is_gpu_driven_enabled;
+    VkPipeline indirect_mesh_pipelines[VERTEX_LAYOUT_COUNT];
+    VkPipeline indirect_wireframe_pipelines[VERTEX_LAYOUT_COUNT];
+    std::vector<DrawBatch> draw_batches; // 本帧的批次，由 build_draw_batches 每帧重建
+    std::unordered_map<uint64_t, uint32_t> draw_batch_indices; // 批次的键到 draw_batches 下标，与 draw_batches 一起重建，clear 后保留桶
+    uint32_t draw_buffer_size;           // 本帧的批次在 indirect draw buffer 中一个阶段占用的字节数
+    VkPipelineLayout draw_cull_pipeline_layout;
+    VkPipeline draw_cull_pipeline;
+
+    // 支持 rg32f 的 storage image 时，gpu driven 绘制以上一帧的可见性与本帧的 hi-z 做两阶段遮挡剔除，见 DrawPhase
+    bool is_occlusion_culling_enabled;
+    Image *depth_pyramid; // r 为最小深度，g 为最大深度，第 0 层为不超过深度图的 2 的幂尺寸，之后逐层减半到 1x1
+    VkImageView depth_pyramid_view; // 所有层，供遮挡测试采样
+    std::vector<VkImageView> depth_pyramid_level_views; // 每层一个，构建时写入该层并作为下一层的源
+    uint32_t depth_pyramid_width;
+    uint32_t depth_pyramid_height;
+    VkDescriptorSetLayout depth_pyramid_descriptor_set_layout;
+    VkPipelineLayout depth_pyramid_pipeline_layout;
+    VkPipeline depth_pyramid_pipeline;
+    Buffer draw_visibility_buffer; // 各绘制项上一帧是否可见，跨帧共用，每帧由第二阶段重写
+    VkDeviceAddress draw_visibility_buffer_device_address;
+    size_t draw_visibility_buffer_size; // 容量
+    uint32_t draw_visibility_count;     // 已初始化的绘制项数，与本帧的绘制项数不同时全部重置为可见
 
     Image *default_gray_image;
+    Image *default_white_image; // 没有 base color 贴图或贴图尚未上传完成时使用
+    VkImageView default_white_image_view;
     Image *default_checkerboard_image;
     VkImageView default_checkerboard_image_view;
     VkSampler default_sampler_nearest;
+    VkSampler default_sampler_linear_mipmap;
 
+    GeometryArena *geometry_arena;
+    AssetLoader *asset_loader;
+    AssetRequestId gltf_model_request; // 加载完成前 gltf_model_geometry 中的 mesh 逐帧增加
     Geometry gltf_model_geometry;
     Geometry quad_geometry;
     std::vector<Geometry *> geometries;
 
     Camera camera;
     GlobalState global_state;
+    LodStats lod_stats;
+    CullBounds instance_bounds; // gltf_model_geometry 各实例的世界空间包围盒，每帧在 update_scene 中重建
+    std::vector<uint64_t> instance_visibility; // 各实例的 cpu 视锥剔除结果，之后交接的实例不在其中，视为可见
+    DrawCullStats instance_cull_stats;
+    SkinningStats skinning_stats;
+    DrawStats draw_stats;
+    DrawCullStats draw_cull_stats; // 读回时已晚 FRAMES_IN_FLIGHT 帧
 
     ImGuiContext *gui_context;
 };
 
-void app_create(SDL_Window *window, App **out_app);
+void app_create(SDL_Window *window, ThreadPool *thread_pool, App **out_app);
 
 void app_destroy(App *app);
 
@@ -0,0 +1,259 @@
+#include "asset_loader.h"
+#include "core/logging.h"
+#include "core/thread_pool.h"
+#include "core/timer.h"
+#include <algorithm>
+
+// 优先级高的在前，相同优先级按提交顺序
+static bool has_higher_priority(const AssetRequest *a, const AssetRequest *b) {
+    if (a->priority != b->priority) { return a->priority > b->priority; }
+    return a->id < b->id;
+}
+
+static void insert_by_priority(std::vector<AssetRequest *> *requests, AssetRequest *request) {
+    requests->insert(std::upper_bound(requests->begin(), requests->end(), request, has_higher_priority), request);
+}
+
+static void remove_request(std::vector<AssetRequest *> *requests, AssetRequest *request) {
+    requests->erase(std::find(requests->begin(), requests->end(), request));
+}
+
+// 记录最终状态并释放请求，需持有锁
+static void finish_request(AssetLoader *asset_loader, AssetRequest *request, AssetRequestStatus status) {
+    asset_loader->finished_statuses[request->id] = status;
+    asset_loader->requests.erase(request->id);
+    if (status == ASSET_REQUEST_STATUS_COMPLETE) {
+        ++asset_loader->stats.complete_count;
+    } else if (status == ASSET_REQUEST_STATUS_CANCELLED) {
+        ++asset_loader->stats.cancelled_count;
+    } else if (status == ASSET_REQUEST_STATUS_FAILED) {
+        ++asset_loader->stats.failed_count;
+    }
+    delete request;
+}
+
+// 交接中途取消的请求，其实例引用的 mesh 不会全部交接，全部禁用；已交接的 mesh 与贴图归 Geometry 所有，随其销毁
+static void disable_imported_instances(AssetRequest *request) {
+    if (!request->is_handoff_started) { return; }
+    std::vector<MeshInstance> &instances = request->geometry->instances;
+    for (uint32_t i = 0; i < request->import_base.instance_count; ++i) { instances[request->import_base.first_instance_index + i].mesh_index = UINT32_MAX; }
+}
+
+// 在工作线程上执行
+static void import_request(AssetLoader *asset_loader, AssetRequest *request) {
+    bool succeed = import_gltf(asset_loader->thread_pool, request->filepath.c_str(), &request->options, &request->gltf_import);
+
+    std::lock_guard<std::mutex> lock(asset_loader->mutex);
+    request->import_end_time = timer_now_ns();
+    --asset_loader->importing_count;
+    if (request->is_cancelled) {
+        finish_request(asset_loader, request, ASSET_REQUEST_STATUS_CANCELLED);
+    } else if (!succeed) {
+        log_error("asset request %llu failed to import %s", (unsigned long long) request->id, request->filepath.c_str());
+        finish_request(asset_loader, request, ASSET_REQUEST_STATUS_FAILED);
+    } else {
+        request->status = ASSET_REQUEST_STATUS_HANDOFF;
+        insert_by_priority(&asset_loader->handoff_requests, request);
+    }
+    asset_loader->import_finished.notify_all();
+}
+
+// 按优先级启动排队的请求，只在主线程上调用；提交在锁外进行，没有工作线程时任务会在当前线程上直接执行
+static void start_imports(AssetLoader *asset_loader) {
+    std::vector<AssetRequest *> requests_to_start;
+    {
+        std::lock_guard<std::mutex> lock(asset_loader->mutex);
+        while (asset_loader->importing_count < asset_loader->max_importing_count && !asset_loader->pending_requests.empty()) {
+            AssetRequest *request = asset_loader->pending_requests.front();
+            asset_loader->pending_requests.erase(asset_loader->pending_requests.begin());
+            request->status = ASSET_REQUEST_STATUS_IMPORTING;
+            ++asset_loader->importing_count;
+            requests_to_start.push_back(request);
+        }
+    }
+    for (AssetRequest *request: requests_to_start) {
+        thread_pool_submit(asset_loader->thread_pool, [asset_loader, request] { import_request(asset_loader, request); });
+    }
+}
+
+void asset_loader_create(ThreadPool *thread_pool, UploadEngine *upload_engine, GeometryArena *arena, uint32_t max_importing_count,
+                         AssetLoader **out_asset_loader) {
+    ASSERT(thread_pool);
+    ASSERT(max_importing_count > 0);
+
+    AssetLoader *asset_loader = new AssetLoader();
+    asset_loader->thread_pool = thread_pool;
+    asset_loader->upload_engine = upload_engine;
+    asset_loader->arena = arena;
+    asset_loader->max_importing_count = max_importing_count;
+    asset_loader->importing_count = 0;
+    asset_loader->next_id = 1;
+    asset_loader->stats = {};
+    *out_asset_loader = asset_loader;
+}
+
+void asset_loader_destroy(AssetLoader *asset_loader) {
+    {
+        std::unique_lock<std::mutex> lock(asset_loader->mutex);
+        for (AssetRequest *request: asset_loader->pending_requests) { finish_request(asset_loader, request, ASSET_REQUEST_STATUS_CANCELLED); }
+        asset_loader->pending_requests.clear();
+
+        for (auto &[id, request]: asset_loader->requests) { request->is_cancelled = true; }
+        asset_loader->import_finished.wait(lock, [asset_loader] { return asset_loader->importing_count == 0; });
+
+        for (AssetRequest *request: asset_loader->handoff_requests) {
+            disable_imported_instances(request);
+            finish_request(asset_loader, request, ASSET_REQUEST_STATUS_CANCELLED);
+        }
+        asset_loader->handoff_requests.clear();
+    }
+    delete asset_loader;
+}
+
+AssetRequestId asset_loader_request_gltf(AssetLoader *asset_loader, const char *filepath, const GltfLoadOptions *options, int32_t priority,
+                                         Geometry *geometry) {
+    AssetRequest *request = new AssetRequest();
+    request->id = asset_loader->next_id++;
+    request->filepath = filepath;
+    request->options = *options;
+    request->priority = priority;
+    request->geometry = geometry;
+    request->status = ASSET_REQUEST_STATUS_PENDING;
+    request->is_cancelled = false;
+    request->next_texture_index = 0;
+    request->next_mesh_index = 0;
+    request->import_base = {};
+    request->is_handoff_started = false;
+    request->request_time = timer_now_ns();
+    request->import_end_time = 0;
+    request->handoff_frame_count = 0;
+
+    AssetRequestId id = request->id;
+    {
+        std::lock_guard<std::mutex> lock(asset_loader->mutex);
+        asset_loader->requests[id] = request;
+        insert_by_priority(&asset_loader->pending_requests, request);
+        ++asset_loader->stats.request_count;
+    }
+    start_imports(asset_loader);
+    return id;
+}
+
+void asset_loader_cancel(AssetLoader *asset_loader, AssetRequestId id) {
+    std::lock_guard<std::mutex> lock(asset_loader->mutex);
+    auto it = asset_loader->requests.find(id);
+    if (it == asset_loader->requests.end()) { return; }
+
+    AssetRequest *request = it->second;
+    if (request->status == ASSET_REQUEST_STATUS_PENDING) {
+        remove_request(&asset_loader->pending_requests, request);
+        finish_request(asset_loader, request, ASSET_REQUEST_STATUS_CANCELLED);
+    } else if (request->status == ASSET_REQUEST_STATUS_IMPORTING) {
+        request->is_cancelled = true;
+    } else if (request->status == ASSET_REQUEST_STATUS_HANDOFF) {
+        remove_request(&asset_loader->handoff_requests, request);
+        disable_imported_instances(request);
+        finish_request(asset_loader, request, ASSET_REQUEST_STATUS_CANCELLED);
+    }
+}
+
+AssetRequestStatus asset_loader_get_status(AssetLoader *asset_loader, AssetRequestId id) {
+    std::lock_guard<std::mutex> lock(asset_loader->mutex);
+    auto it = asset_loader->requests.find(id);
+    if (it != asset_loader->requests.end()) { return it->second->status; }
+    auto finished_it = asset_loader->finished_statuses.find(id);
+    if (finished_it != asset_loader->finished_statuses.end()) { return finished_it->second; }
+    return ASSET_REQUEST_STATUS_UNKNOWN;
+}
+
+uint32_t asset_loader_update(AssetLoader *asset_loader, size_t budget_bytes) {
+    start_imports(asset_loader);
+
+    // 交接中的请求只由主线程访问，工作线程只会向 handoff_requests 中插入，因此只有取出与移除时需要加锁
+    uint32_t handoff_count = 0;
+    size_t handoff_bytes = 0;
+    AssetRequest *last_request = nullptr;
+    while (true) {
+        AssetRequest *request = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(asset_loader->mutex);
+            if (asset_loader->handoff_requests.empty()) { break; }
+            request = asset_loader->handoff_requests.front();
+        }
+
+        // 材质、节点与实例先于贴图和 mesh 创建，尚未交接的贴图绘制时使用默认贴图，引用尚未交接的 mesh 的实例在绘制时跳过
+        if (!request->is_handoff_started) {
+            create_imported_scene(&request->gltf_import, request->geometry, &request->import_base);
+            request->is_handoff_started = true;
+        }
+
+        std::vector<ImportedTexture> &imported_textures = request->gltf_import.textures;
+        std::vector<ImportedMesh> &imported_meshes = request->gltf_import.meshes;
+        if (request->next_texture_index < imported_textures.size()) {
+            ImportedTexture *imported_texture = &imported_textures[request->next_texture_index];
+            size_t texture_size = get_imported_texture_size(imported_texture);
+            if (handoff_count > 0 && handoff_bytes + texture_size > budget_bytes) { break; }
+            if (handoff_count == 0 && texture_size > budget_bytes) { ++asset_loader->stats.budget_exceeded_frame_count; }
+
+            create_imported_texture(asset_loader->upload_engine, imported_texture,
+                                    &request->geometry->textures[request->import_base.first_texture_index + request->next_texture_index]);
+            imported_texture->data = {}; // 数据已拷入 staging 或移入贴图供流式加载，尽早释放
+
+            ++request->next_texture_index;
+            ++handoff_count;
+            handoff_bytes += texture_size;
+            ++asset_loader->stats.texture_handoff_count;
+            asset_loader->stats.bytes_handed_off += texture_size;
+            if (request != last_request) {
+                ++request->handoff_frame_count;
+                last_request = request;
+            }
+        } else if (request->next_mesh_index < imported_meshes.size()) {
+            ImportedMesh *imported_mesh = &imported_meshes[request->next_mesh_index];
+            size_t mesh_size = get_imported_mesh_size(imported_mesh);
+            if (handoff_count > 0 && handoff_bytes + mesh_size > budget_bytes) { break; }
+            if (handoff_count == 0 && mesh_size > budget_bytes) { ++asset_loader->stats.budget_exceeded_frame_count; }
+
+            create_imported_mesh(asset_loader->upload_engine, asset_loader->arena, request->gltf_import.vertex_layout, imported_mesh,
+                                 request->import_base.first_material_index,
+                                 &request->geometry->meshes[request->import_base.first_mesh_index + request->next_mesh_index]);
+            *imported_mesh = {}; // 数据已拷入 staging，尽早释放
+
+            ++request->next_mesh_index;
+            ++handoff_count;
+            handoff_bytes += mesh_size;
+            ++asset_loader->stats.mesh_handoff_count;
+            asset_loader->stats.bytes_handed_off += mesh_size;
+            if (request != last_request) {
+                ++request->handoff_frame_count;
+                last_request = request;
+            }
+        }
+
+        if (request->next_texture_index == imported_textures.size() && request->next_mesh_index == imported_meshes.size()) {
+            log_info("asset %s loaded: %zu meshes, %zu nodes, %zu textures, import %.2f ms, handoff %u frames, total %.2f ms", request->filepath.c_str(),
+                     imported_meshes.size(), request->gltf_import.nodes.size(), imported_textures.size(),
+                     (request->import_end_time - request->request_time) / 1e6, request->handoff_frame_count, timer_elapsed_ms(request->request_time));
+            std::lock_guard<std::mutex> lock(asset_loader->mutex);
+            remove_request(&asset_loader->handoff_requests, request);
+            finish_request(asset_loader, request, ASSET_REQUEST_STATUS_COMPLETE);
+        }
+    }
+    return handoff_count;
+}
+
+bool asset_loader_is_idle(AssetLoader *asset_loader) {
+    std::lock_guard<std::mutex> lock(asset_loader->mutex);
+    return asset_loader->requests.empty();
+}
+
+void asset_loader_log_stats(AssetLoader *asset_loader) {
+    std::lock_guard<std::mutex> lock(asset_loader->mutex);
+    const AssetLoaderStats *stats = &asset_loader->stats;
+    log_info("asset loader: %llu requests, %llu complete, %llu cancelled, %llu failed, %llu meshes, %llu textures, %.2f MB handed off, "
+             "%llu frames over budget",
+             (unsigned long long) stats->request_count, (unsigned long long) stats->complete_count, (unsigned long long) stats->cancelled_count,
+             (unsigned long long) stats->failed_count, (unsigned long long) stats->mesh_handoff_count,
+             (unsigned long long) stats->texture_handoff_count, stats->bytes_handed_off / (1024.0 * 1024.0),
+             (unsigned long long) stats->budget_exceeded_frame_count);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "mesh_loader.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ThreadPool;
+
+// 加载请求的句柄，0 表示无效
+typedef uint64_t AssetRequestId;
+
+// COMPLETE 及之后为结束状态
+enum AssetRequestStatus : uint32_t {
+    ASSET_REQUEST_STATUS_PENDING,   // 排队等待导入
+    ASSET_REQUEST_STATUS_IMPORTING, // 在工作线程上导入
+    ASSET_REQUEST_STATUS_HANDOFF,   // 导入完成，主线程按帧预算逐个贴图、mesh 交给 upload engine
+    ASSET_REQUEST_STATUS_COMPLETE,  // 所有贴图与 mesh 已交接，上传完成后即可见
+    ASSET_REQUEST_STATUS_CANCELLED,
+    ASSET_REQUEST_STATUS_FAILED,
+    ASSET_REQUEST_STATUS_UNKNOWN, // 无效的 id
+};
+
+struct AssetRequest {
+    AssetRequestId id;
+    std::string filepath;
+    GltfLoadOptions options;
+    int32_t priority; // 越大越先导入、先交接，相同优先级按提交顺序
+    Geometry *geometry; // 交接的 mesh 与贴图创建到开始交接时预留的位置，同一 geometry 可以有多个请求交替交接
+    AssetRequestStatus status;
+    bool is_cancelled; // 导入中被取消时由工作线程在完成后丢弃结果
+
+    GltfImport gltf_import;
+    uint32_t next_texture_index; // 下一个待交接的贴图，贴图先于 mesh 交接
+    uint32_t next_mesh_index; // 下一个待交接的 mesh
+    GeometryImportBase import_base; // 开始交接时确定，同时追加材质并创建节点与实例
+    bool is_handoff_started;
+
+    uint64_t request_time;
+    uint64_t import_end_time;
+    uint32_t handoff_frame_count;
+};
+
+struct AssetLoaderStats {
+    uint64_t request_count;
+    uint64_t complete_count;
+    uint64_t cancelled_count;
+    uint64_t failed_count;
+    uint64_t mesh_handoff_count;
+    uint64_t texture_handoff_count;
+    uint64_t bytes_handed_off;
+    uint64_t budget_exceeded_frame_count; // 单个 mesh 或贴图超过预算、只交接了它一个的帧数
+};
+
+// 异步的模型加载服务：导入在线程池上执行，交接（arena 分配与录制上传）在主线程上按帧预算执行
+// 除 thread_pool 外，所有函数只能在创建它的线程（upload engine 所属线程）上调用
+struct AssetLoader {
+    ThreadPool *thread_pool;
+    UploadEngine *upload_engine;
+    GeometryArena *arena;
+    uint32_t max_importing_count; // 同时导入的请求数，导入内部还会并行处理各 primitive
+
+    std::mutex mutex; // 保护以下由工作线程访问的成员
+    std::condition_variable import_finished;
+    std::vector<AssetRequest *> pending_requests;
+    std::vector<AssetRequest *> handoff_requests;
+    uint32_t importing_count;
+    std::unordered_map<AssetRequestId, AssetRequest *> requests; // 尚未结束的请求
+    std::unordered_map<AssetRequestId, AssetRequestStatus> finished_statuses;
+
+    AssetRequestId next_id;
+    AssetLoaderStats stats;
+};
+
+void asset_loader_create(ThreadPool *thread_pool, UploadEngine *upload_engine, GeometryArena *arena, uint32_t max_importing_count,
+                         AssetLoader **out_asset_loader);
+
+// 取消所有排队的请求，等待正在导入的请求结束后销毁；已交接的 mesh 与贴图归 Geometry 所有，不受影响
+void asset_loader_destroy(AssetLoader *asset_loader);
+
+// 提交一个 gltf 加载请求，`geometry` 需在请求结束前保持有效
+AssetRequestId asset_loader_request_gltf(AssetLoader *asset_loader, const char *filepath, const GltfLoadOptions *options, int32_t priority,
+                                         Geometry *geometry);
+
+// 排队中的请求直接移除；导入中的请求在导入结束后丢弃；交接中的请求停止交接剩余的 mesh 与贴图并禁用其实例，已交接的保留
+void asset_loader_cancel(AssetLoader *asset_loader, AssetRequestId id);
+
+AssetRequestStatus asset_loader_get_status(AssetLoader *asset_loader, AssetRequestId id);
+
+// 每帧调用一次，按优先级交接已导入的贴图与 mesh，累计拷入 staging 的字节数达到 `budget_bytes` 后停止
+// 每帧至少交接一项，保证超过预算的 mesh 或贴图也能推进；返回本帧交接的 mesh 与贴图数
+uint32_t asset_loader_update(AssetLoader *asset_loader, size_t budget_bytes);
+
+// 没有排队、导入中或交接中的请求
+bool asset_loader_is_idle(AssetLoader *asset_loader);
+
+void asset_loader_log_stats(AssetLoader *asset_loader);
@@ -1,4 +1,5 @@
 #include "camera.h"
+#include "frustum_cull.h"
 
 bool is_zero(float value) { return abs(value) < glm::epsilon<float>(); }
 
@@ -101,3 +102,7 @@ void camera_update(Camera *camera) {
 
     camera->is_dirty = false;
 }
+
+void camera_get_frustum_planes(const Camera *camera, const glm::mat4 &projection, glm::vec4 planes[6]) {
+    extract_frustum_planes(projection * camera->view_matrix, planes);
+}
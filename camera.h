@@ -34,3 +34,6 @@ void camera_pitch(Camera *camera, float delta_angles);
 void camera_yaw(Camera *camera, float delta_angles);
 
 void camera_update(Camera *camera);
+
+// 由 view_matrix 与 `projection` 提取世界空间的视锥平面，顺序为 left, right, bottom, top, near, far，需在 camera_update() 之后调用
+void camera_get_frustum_planes(const Camera *camera, const glm::mat4 &projection, glm::vec4 planes[6]);
@@ -3,9 +3,21 @@
 set -ex
 
 glslangValidator -V shaders/gradient.comp -o shaders/gradient.comp.spv
+glslangValidator -V shaders/cluster_cull.comp -o shaders/cluster_cull.comp.spv
+glslangValidator -V shaders/draw_cull.comp -o shaders/draw_cull.comp.spv
+glslangValidator -V -DOCCLUSION_CULLING shaders/draw_cull.comp -o shaders/draw_cull.occlusion.comp.spv
+glslangValidator -V shaders/depth_pyramid.comp -o shaders/depth_pyramid.comp.spv
+glslangValidator -V shaders/skinning.comp -o shaders/skinning.comp.spv
+glslangValidator -V -DPACKED_VERTEX shaders/skinning.comp -o shaders/skinning.packed.comp.spv
 glslangValidator -V shaders/colored-triangle.vert -o shaders/colored-triangle.vert.spv
 glslangValidator -V shaders/colored-triangle.frag -o shaders/colored-triangle.frag.spv
 glslangValidator -V shaders/mesh.vert -o shaders/mesh.vert.spv
+glslangValidator -V -DPACKED_VERTEX shaders/mesh.vert -o shaders/mesh.packed.vert.spv
+glslangValidator -V -DINDIRECT_DRAW shaders/mesh.vert -o shaders/mesh.indirect.vert.spv
+glslangValidator -V -DPACKED_VERTEX -DINDIRECT_DRAW shaders/mesh.vert -o shaders/mesh.packed.indirect.vert.spv
 glslangValidator -V shaders/mesh.frag -o shaders/mesh.frag.spv
 glslangValidator -V shaders/wireframe.vert -o shaders/wireframe.vert.spv
+glslangValidator -V -DPACKED_VERTEX shaders/wireframe.vert -o shaders/wireframe.packed.vert.spv
+glslangValidator -V -DINDIRECT_DRAW shaders/wireframe.vert -o shaders/wireframe.indirect.vert.spv
+glslangValidator -V -DPACKED_VERTEX -DINDIRECT_DRAW shaders/wireframe.vert -o shaders/wireframe.packed.indirect.vert.spv
 glslangValidator -V shaders/wireframe.frag -o shaders/wireframe.frag.spv
@@ -1 +1,308 @@
 #include "core/frame_graph.h"
+#include "core/logging.h"
+
+// 编译时每个资源的同步状态
+struct FrameGraphResourceState {
+    VkPipelineStageFlags2 write_stage_mask; // 上一次写入（含布局转换）的 stage 与 access
+    VkAccessFlags2 write_access_mask;
+    VkPipelineStageFlags2 read_stage_mask;    // 上一次写入之后的读取，之后的写入需等待它们完成
+    VkPipelineStageFlags2 visible_stage_mask; // 上一次写入已对这些 stage 与 access 可见
+    VkAccessFlags2 visible_access_mask;
+    VkImageLayout layout;
+};
+
+void frame_graph_create(FrameGraph **out_frame_graph) {
+    FrameGraph *frame_graph = new FrameGraph();
+    frame_graph->is_compiled = false;
+    *out_frame_graph = frame_graph;
+}
+
+void frame_graph_destroy(FrameGraph *frame_graph) { delete frame_graph; }
+
+static uint32_t add_resource(FrameGraph *frame_graph, const char *name, FrameGraphResourceType type, VkImageAspectFlags aspect_mask, bool is_persistent) {
+    ASSERT(!frame_graph->is_compiled);
+    FrameGraphResource resource{};
+    resource.name = name;
+    resource.type = type;
+    resource.aspect_mask = aspect_mask;
+    resource.is_persistent = is_persistent;
+    frame_graph->resources.push_back(resource);
+    return frame_graph->resources.size() - 1;
+}
+
+uint32_t frame_graph_import_image(FrameGraph *frame_graph, const char *name, VkImageAspectFlags aspect_mask, bool is_persistent) {
+    return add_resource(frame_graph, name, FRAME_GRAPH_RESOURCE_IMAGE, aspect_mask, is_persistent);
+}
+
+uint32_t frame_graph_import_buffer(FrameGraph *frame_graph, const char *name, bool is_persistent) {
+    return add_resource(frame_graph, name, FRAME_GRAPH_RESOURCE_BUFFER, 0, is_persistent);
+}
+
+void frame_graph_set_output(FrameGraph *frame_graph, uint32_t resource, VkPipelineStageFlags2 stage_mask, VkAccessFlags2 access_mask, VkImageLayout layout) {
+    ASSERT(!frame_graph->is_compiled && resource < frame_graph->resources.size());
+    FrameGraphResource *output = &frame_graph->resources[resource];
+    output->is_output = true;
+    output->final_stage_mask = stage_mask;
+    output->final_access_mask = access_mask;
+    output->final_layout = layout;
+}
+
+uint32_t frame_graph_add_pass(FrameGraph *frame_graph, const char *name, std::function<void(VkCommandBuffer command_buffer)> execute) {
+    ASSERT(!frame_graph->is_compiled);
+    FrameGraphPass pass{};
+    pass.name = name;
+    pass.execute = std::move(execute);
+    frame_graph->passes.push_back(std::move(pass));
+    return frame_graph->passes.size() - 1;
+}
+
+void frame_graph_set_side_effect(FrameGraph *frame_graph, uint32_t pass) {
+    ASSERT(!frame_graph->is_compiled && pass < frame_graph->passes.size());
+    frame_graph->passes[pass].has_side_effect = true;
+}
+
+static FrameGraphAccess *get_pass_access(FrameGraph *frame_graph, uint32_t pass, uint32_t resource, VkImageLayout layout) {
+    ASSERT(!frame_graph->is_compiled && pass < frame_graph->passes.size() && resource < frame_graph->resources.size());
+    if (frame_graph->resources[resource].type == FRAME_GRAPH_RESOURCE_BUFFER) { layout = VK_IMAGE_LAYOUT_UNDEFINED; }
+
+    std::vector<FrameGraphAccess> &accesses = frame_graph->passes[pass].accesses;
+    for (FrameGraphAccess &access: accesses) {
+        if (access.resource != resource) { continue; }
+        ASSERT_MESSAGE(access.layout == layout, "pass %s uses %s in two layouts", frame_graph->passes[pass].name, frame_graph->resources[resource].name);
+        return &access;
+    }
+    FrameGraphAccess access{};
+    access.resource = resource;
+    access.layout = layout;
+    accesses.push_back(access);
+    return &accesses.back();
+}
+
+void frame_graph_read(FrameGraph *frame_graph, uint32_t pass, uint32_t resource, VkPipelineStageFlags2 stage_mask, VkAccessFlags2 access_mask,
+                      VkImageLayout layout) {
+    ASSERT(stage_mask != 0);
+    FrameGraphAccess *access = get_pass_access(frame_graph, pass, resource, layout);
+    access->read_stage_mask |= stage_mask;
+    access->read_access_mask |= access_mask;
+}
+
+void frame_graph_write(FrameGraph *frame_graph, uint32_t pass, uint32_t resource, VkPipelineStageFlags2 stage_mask, VkAccessFlags2 access_mask,
+                       VkImageLayout layout) {
+    ASSERT(stage_mask != 0);
+    FrameGraphAccess *access = get_pass_access(frame_graph, pass, resource, layout);
+    access->write_stage_mask |= stage_mask;
+    access->write_access_mask |= access_mask;
+}
+
+// 从输出逆序回溯：写入了被需要资源的 pass 保留，其读取的资源随之被需要
+// 跨帧共用的资源可能由下一帧中更早的 pass 读取，逆序回溯看不到这种依赖，只要有 pass 读取就视为被需要
+static void cull_passes(FrameGraph *frame_graph) {
+    std::vector<bool> is_needed(frame_graph->resources.size());
+    for (size_t i = 0; i < frame_graph->resources.size(); ++i) { is_needed[i] = frame_graph->resources[i].is_output; }
+    for (const FrameGraphPass &pass: frame_graph->passes) {
+        for (const FrameGraphAccess &access: pass.accesses) {
+            if (access.read_stage_mask != 0 && frame_graph->resources[access.resource].is_persistent) { is_needed[access.resource] = true; }
+        }
+    }
+
+    for (size_t pass_index = frame_graph->passes.size(); pass_index-- > 0;) {
+        FrameGraphPass *pass = &frame_graph->passes[pass_index];
+        pass->is_culled = !pass->has_side_effect;
+        for (const FrameGraphAccess &access: pass->accesses) {
+            if (access.write_stage_mask != 0 && is_needed[access.resource]) { pass->is_culled = false; }
+        }
+        if (pass->is_culled) { continue; }
+        for (const FrameGraphAccess &access: pass->accesses) {
+            if (access.read_stage_mask != 0) { is_needed[access.resource] = true; }
+        }
+    }
+}
+
+// 按访问更新资源状态，需要同步时填写 `barrier` 并返回 true
+static bool access_resource(const FrameGraphResource *resource, const FrameGraphAccess *access, FrameGraphResourceState *state, FrameGraphBarrier *barrier) {
+    const bool is_read = access->read_stage_mask != 0, is_write = access->write_stage_mask != 0;
+    const bool is_transition = resource->type == FRAME_GRAPH_RESOURCE_IMAGE && access->layout != state->layout;
+    const VkPipelineStageFlags2 stage_mask = access->read_stage_mask | access->write_stage_mask;
+    const VkAccessFlags2 access_mask = access->read_access_mask | access->write_access_mask;
+
+    *barrier = {};
+    barrier->resource = access->resource;
+    barrier->dst_stage_mask = stage_mask;
+    barrier->dst_access_mask = access_mask;
+    barrier->old_layout = access->layout;
+    barrier->new_layout = access->layout;
+
+    bool needs_barrier;
+    if (is_transition || is_write) {
+        // 写入与布局转换需等待之前的读写都完成，WAR 只需执行依赖；只写不读时之前的内容可以丢弃
+        needs_barrier = is_transition || state->write_stage_mask != 0 || state->read_stage_mask != 0;
+        barrier->src_stage_mask = state->write_stage_mask | state->read_stage_mask;
+        barrier->src_access_mask = state->write_access_mask;
+        if (is_transition) { barrier->old_layout = is_write && !is_read ? VK_IMAGE_LAYOUT_UNDEFINED : state->layout; }
+
+        // 只读的布局转换视为在本次访问的 stage 之前完成的写入，已对本次访问可见
+        state->write_stage_mask = is_write ? access->write_stage_mask : stage_mask;
+        state->write_access_mask = access->write_access_mask;
+        state->read_stage_mask = access->read_stage_mask;
+        state->visible_stage_mask = is_write ? 0 : stage_mask;
+        state->visible_access_mask = is_write ? 0 : access_mask;
+    } else {
+        // 读取只需等待上一次写入，写入已对相同的 stage 与 access 可见时无需再同步
+        needs_barrier = state->write_stage_mask != 0 &&
+                        ((stage_mask & ~state->visible_stage_mask) != 0 || (access_mask & ~state->visible_access_mask) != 0);
+        barrier->src_stage_mask = state->write_stage_mask;
+        barrier->src_access_mask = state->write_access_mask;
+        state->read_stage_mask |= stage_mask;
+        if (needs_barrier) {
+            state->visible_stage_mask |= stage_mask;
+            state->visible_access_mask |= access_mask;
+        }
+    }
+    state->layout = access->layout;
+    return needs_barrier;
+}
+
+static void append_barrier_batch(uint32_t pass, uint32_t first_barrier, const std::vector<FrameGraphBarrier> &barriers,
+                                 std::vector<FrameGraphBarrierBatch> *batches) {
+    if (barriers.size() > first_barrier) { batches->push_back({pass, first_barrier, (uint32_t) (barriers.size() - first_barrier)}); }
+}
+
+// 按顺序模拟未剔除的 pass，结束时将输出转换到图外使用的状态
+static void build_barriers(const FrameGraph *frame_graph, std::vector<FrameGraphResourceState> *states, std::vector<FrameGraphBarrier> *barriers,
+                           std::vector<FrameGraphBarrierBatch> *batches) {
+    FrameGraphBarrier barrier;
+    for (uint32_t pass_index = 0; pass_index < frame_graph->passes.size(); ++pass_index) {
+        const FrameGraphPass *pass = &frame_graph->passes[pass_index];
+        if (pass->is_culled) { continue; }
+        uint32_t first_barrier = barriers->size();
+        for (const FrameGraphAccess &access: pass->accesses) {
+            if (access_resource(&frame_graph->resources[access.resource], &access, &(*states)[access.resource], &barrier)) { barriers->push_back(barrier); }
+        }
+        append_barrier_batch(pass_index, first_barrier, *barriers, batches);
+    }
+
+    uint32_t first_barrier = barriers->size();
+    for (uint32_t resource_index = 0; resource_index < frame_graph->resources.size(); ++resource_index) {
+        const FrameGraphResource *resource = &frame_graph->resources[resource_index];
+        if (!resource->is_output) { continue; }
+        FrameGraphAccess access{};
+        access.resource = resource_index;
+        access.read_stage_mask = resource->final_stage_mask;
+        access.read_access_mask = resource->final_access_mask;
+        access.layout = resource->type == FRAME_GRAPH_RESOURCE_IMAGE && resource->final_layout != VK_IMAGE_LAYOUT_UNDEFINED ? resource->final_layout
+                                                                                                                             : (*states)[resource_index].layout;
+        if (access.read_stage_mask == VK_PIPELINE_STAGE_2_NONE && access.layout == (*states)[resource_index].layout) { continue; }
+        if (access_resource(resource, &access, &(*states)[resource_index], &barrier)) { barriers->push_back(barrier); }
+    }
+    append_barrier_batch(frame_graph->passes.size(), first_barrier, *barriers, batches);
+}
+
+void frame_graph_compile(FrameGraph *frame_graph) {
+    ASSERT(!frame_graph->is_compiled);
+    cull_passes(frame_graph);
+
+    // 同一张图每帧执行，跨帧共用的资源以上一帧结束时的状态开始：先模拟一帧得到结束状态，再以此生成 barrier
+    std::vector<FrameGraphResourceState> states(frame_graph->resources.size(), FrameGraphResourceState{});
+    build_barriers(frame_graph, &states, &frame_graph->barriers, &frame_graph->batches);
+    for (size_t i = 0; i < states.size(); ++i) {
+        if (frame_graph->resources[i].is_persistent) {
+            states[i].visible_stage_mask = 0;
+            states[i].visible_access_mask = 0;
+        } else {
+            states[i] = {};
+        }
+    }
+    frame_graph->barriers.clear();
+    frame_graph->batches.clear();
+    build_barriers(frame_graph, &states, &frame_graph->barriers, &frame_graph->batches);
+
+    frame_graph->is_compiled = true;
+    frame_graph_log(frame_graph);
+}
+
+void frame_graph_set_image(FrameGraph *frame_graph, uint32_t resource, VkImage image) {
+    ASSERT(resource < frame_graph->resources.size() && frame_graph->resources[resource].type == FRAME_GRAPH_RESOURCE_IMAGE);
+    frame_graph->resources[resource].image = image;
+}
+
+VkImage frame_graph_get_image(const FrameGraph *frame_graph, uint32_t resource) {
+    ASSERT(resource < frame_graph->resources.size());
+    return frame_graph->resources[resource].image;
+}
+
+// image 各自一个 barrier，buffer 合并为一个全局的 memory barrier
+static void record_barrier_batch(const FrameGraph *frame_graph, const FrameGraphBarrierBatch *batch, VkCommandBuffer command_buffer) {
+    std::vector<VkImageMemoryBarrier2> image_memory_barriers;
+    VkMemoryBarrier2 memory_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+    bool has_memory_barrier = false;
+    for (uint32_t i = batch->first_barrier; i < batch->first_barrier + batch->barrier_count; ++i) {
+        const FrameGraphBarrier *barrier = &frame_graph->barriers[i];
+        const FrameGraphResource *resource = &frame_graph->resources[barrier->resource];
+        if (resource->type == FRAME_GRAPH_RESOURCE_BUFFER) {
+            memory_barrier.srcStageMask |= barrier->src_stage_mask;
+            memory_barrier.srcAccessMask |= barrier->src_access_mask;
+            memory_barrier.dstStageMask |= barrier->dst_stage_mask;
+            memory_barrier.dstAccessMask |= barrier->dst_access_mask;
+            has_memory_barrier = true;
+            continue;
+        }
+
+        ASSERT_MESSAGE(resource->image != VK_NULL_HANDLE, "frame graph image %s is not set", resource->name);
+        VkImageMemoryBarrier2 image_memory_barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+        image_memory_barrier.srcStageMask = barrier->src_stage_mask;
+        image_memory_barrier.srcAccessMask = barrier->src_access_mask;
+        image_memory_barrier.dstStageMask = barrier->dst_stage_mask;
+        image_memory_barrier.dstAccessMask = barrier->dst_access_mask;
+        image_memory_barrier.oldLayout = barrier->old_layout;
+        image_memory_barrier.newLayout = barrier->new_layout;
+        image_memory_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_memory_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_memory_barrier.image = resource->image;
+        image_memory_barrier.subresourceRange = {resource->aspect_mask, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+        image_memory_barriers.push_back(image_memory_barrier);
+    }
+
+    VkDependencyInfo dependency_info{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    dependency_info.memoryBarrierCount = has_memory_barrier ? 1 : 0;
+    dependency_info.pMemoryBarriers = &memory_barrier;
+    dependency_info.imageMemoryBarrierCount = image_memory_barriers.size();
+    dependency_info.pImageMemoryBarriers = image_memory_barriers.data();
+    vkCmdPipelineBarrier2KHR(command_buffer, &dependency_info);
+}
+
+void frame_graph_execute(const FrameGraph *frame_graph, VkCommandBuffer command_buffer) {
+    ASSERT(frame_graph->is_compiled);
+    size_t batch_index = 0;
+    for (uint32_t pass_index = 0; pass_index < frame_graph->passes.size(); ++pass_index) {
+        const FrameGraphPass *pass = &frame_graph->passes[pass_index];
+        if (pass->is_culled) { continue; }
+        if (batch_index < frame_graph->batches.size() && frame_graph->batches[batch_index].pass == pass_index) {
+            record_barrier_batch(frame_graph, &frame_graph->batches[batch_index++], command_buffer);
+        }
+        pass->execute(command_buffer);
+    }
+    if (batch_index < frame_graph->batches.size()) { record_barrier_batch(frame_graph, &frame_graph->batches[batch_index], command_buffer); }
+}
+
+void frame_graph_log(const FrameGraph *frame_graph) {
+    uint32_t culled_pass_count = 0;
+    for (const FrameGraphPass &pass: frame_graph->passes) {
+        if (pass.is_culled) { ++culled_pass_count; }
+    }
+    log_info("frame graph: %zu passes (%u culled), %zu resources, %zu barriers in %zu batches", frame_graph->passes.size(), culled_pass_count,
+             frame_graph->resources.size(), frame_graph->barriers.size(), frame_graph->batches.size());
+
+    for (const FrameGraphPass &pass: frame_graph->passes) {
+        if (pass.is_culled) { log_debug("  pass %s culled", pass.name); }
+    }
+    for (const FrameGraphBarrierBatch &batch: frame_graph->batches) {
+        log_debug("  before %s:", batch.pass < frame_graph->passes.size() ? frame_graph->passes[batch.pass].name : "end of frame");
+        for (uint32_t i = batch.first_barrier; i < batch.first_barrier + batch.barrier_count; ++i) {
+            const FrameGraphBarrier *barrier = &frame_graph->barriers[i];
+            log_debug("    %s: stage 0x%llx -> 0x%llx, access 0x%llx -> 0x%llx, layout %d -> %d", frame_graph->resources[barrier->resource].name,
+                      (unsigned long long) barrier->src_stage_mask, (unsigned long long) barrier->dst_stage_mask,
+                      (unsigned long long) barrier->src_access_mask, (unsigned long long) barrier->dst_access_mask, barrier->old_layout,
+                      barrier->new_layout);
+        }
+    }
+}
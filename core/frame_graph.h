@@ -1 +1,106 @@
 #pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <volk.h>
+
+// 每帧按声明顺序执行的 pass 图：pass 声明对具名资源的读写，编译时剔除输出未被使用的 pass，并按读写关系生成合批的 sync2 barrier
+// 编译只依赖声明，不需要 device，编译结果（barriers 与 batches）可在 cpu 上直接检查；image 的句柄在执行前设置，每帧可以不同
+
+enum FrameGraphResourceType : uint32_t {
+    FRAME_GRAPH_RESOURCE_IMAGE,
+    FRAME_GRAPH_RESOURCE_BUFFER, // 以 VkMemoryBarrier2 同步，不需要句柄
+};
+
+struct FrameGraphResource {
+    const char *name;
+    FrameGraphResourceType type;
+    VkImageAspectFlags aspect_mask;
+    VkImage image;
+    bool is_persistent; // 跨帧共用，每帧的首次访问需等待上一帧的最后一次访问，没有读取时内容可丢弃
+    bool is_output;     // 图结束后由图外使用，写入它的 pass 不会被剔除
+    VkPipelineStageFlags2 final_stage_mask; // 图外使用的 stage 与 access，image 在结束时转换到 final_layout
+    VkAccessFlags2 final_access_mask;
+    VkImageLayout final_layout;
+};
+
+// 一个 pass 对一个资源的所有访问，同一 pass 多次声明同一资源时合并
+struct FrameGraphAccess {
+    uint32_t resource;
+    VkPipelineStageFlags2 read_stage_mask;
+    VkAccessFlags2 read_access_mask;
+    VkPipelineStageFlags2 write_stage_mask;
+    VkAccessFlags2 write_access_mask;
+    VkImageLayout layout; // 仅 image
+};
+
+struct FrameGraphPass {
+    const char *name;
+    std::function<void(VkCommandBuffer command_buffer)> execute;
+    std::vector<FrameGraphAccess> accesses;
+    bool has_side_effect; // 输出不在图中（如只写 host 可见的结果）时保留
+    bool is_culled;
+};
+
+struct FrameGraphBarrier {
+    uint32_t resource;
+    VkPipelineStageFlags2 src_stage_mask;
+    VkAccessFlags2 src_access_mask;
+    VkPipelineStageFlags2 dst_stage_mask;
+    VkAccessFlags2 dst_access_mask;
+    VkImageLayout old_layout; // 仅 image，与 new_layout 相同时不转换布局
+    VkImageLayout new_layout;
+};
+
+// 在 pass 之前以一次 vkCmdPipelineBarrier2 提交的 barrier，pass 为 passes.size() 时在图结束时提交
+struct FrameGraphBarrierBatch {
+    uint32_t pass;
+    uint32_t first_barrier;
+    uint32_t barrier_count;
+};
+
+struct FrameGraph {
+    std::vector<FrameGraphResource> resources;
+    std::vector<FrameGraphPass> passes;
+    std::vector<FrameGraphBarrier> barriers;
+    std::vector<FrameGraphBarrierBatch> batches;
+    bool is_compiled;
+};
+
+void frame_graph_create(FrameGraph **out_frame_graph);
+
+void frame_graph_destroy(FrameGraph *frame_graph);
+
+// 返回资源的下标
+uint32_t frame_graph_import_image(FrameGraph *frame_graph, const char *name, VkImageAspectFlags aspect_mask, bool is_persistent);
+
+uint32_t frame_graph_import_buffer(FrameGraph *frame_graph, const char *name, bool is_persistent);
+
+// 标记资源在图结束后由图外以 `stage_mask`/`access_mask` 使用，image 在结束时转换到 `layout`
+void frame_graph_set_output(FrameGraph *frame_graph, uint32_t resource, VkPipelineStageFlags2 stage_mask, VkAccessFlags2 access_mask, VkImageLayout layout);
+
+// 返回 pass 的下标，pass 按添加顺序执行
+uint32_t frame_graph_add_pass(FrameGraph *frame_graph, const char *name, std::function<void(VkCommandBuffer command_buffer)> execute);
+
+void frame_graph_set_side_effect(FrameGraph *frame_graph, uint32_t pass);
+
+// `layout` 对 buffer 忽略；同一 pass 对同一 image 的读写需使用相同的布局
+void frame_graph_read(FrameGraph *frame_graph, uint32_t pass, uint32_t resource, VkPipelineStageFlags2 stage_mask, VkAccessFlags2 access_mask,
+                      VkImageLayout layout);
+
+// 只写不读的资源视为整体覆盖，之前的内容可以丢弃，image 从 VK_IMAGE_LAYOUT_UNDEFINED 转换
+void frame_graph_write(FrameGraph *frame_graph, uint32_t pass, uint32_t resource, VkPipelineStageFlags2 stage_mask, VkAccessFlags2 access_mask,
+                       VkImageLayout layout);
+
+// 剔除 pass 并生成 barrier，之后不能再修改声明
+void frame_graph_compile(FrameGraph *frame_graph);
+
+void frame_graph_set_image(FrameGraph *frame_graph, uint32_t resource, VkImage image);
+
+VkImage frame_graph_get_image(const FrameGraph *frame_graph, uint32_t resource);
+
+// 依次录制未被剔除的 pass，以及每个 pass 之前的 barrier
+void frame_graph_execute(const FrameGraph *frame_graph, VkCommandBuffer command_buffer);
+
+void frame_graph_log(const FrameGraph *frame_graph);
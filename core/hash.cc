@@ -0,0 +1,30 @@
+#include "core/hash.h"
+#include <cstring>
+
+static constexpr uint64_t HASH_PRIME_0 = 0x9e3779b97f4a7c15ull;
+static constexpr uint64_t HASH_PRIME_1 = 0xff51afd7ed558ccdull;
+
+static uint64_t hash_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= HASH_PRIME_1;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t hash_bytes(const void *data, size_t size, uint64_t seed) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint64_t h = seed ^ (size * HASH_PRIME_0);
+
+    size_t word_count = size / sizeof(uint64_t);
+    for (size_t i = 0; i < word_count; ++i) {
+        uint64_t word;
+        memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+        h = (h ^ hash_mix(word)) * HASH_PRIME_0;
+    }
+
+    uint64_t tail = 0;
+    memcpy(&tail, bytes + word_count * sizeof(uint64_t), size % sizeof(uint64_t));
+    h = (h ^ hash_mix(tail)) * HASH_PRIME_0;
+
+    return hash_mix(h);
+}
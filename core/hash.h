@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64 位非加密哈希，用于资源缓存的 key，按 8 字节分块处理
+uint64_t hash_bytes(const void *data, size_t size, uint64_t seed = 0);
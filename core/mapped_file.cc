@@ -0,0 +1,77 @@
+#include "core/mapped_file.h"
+
+#if defined(PLATFORM_WINDOWS)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(PLATFORM_WINDOWS)
+bool map_file(const char *filepath, MappedFile *mapped_file) {
+    *mapped_file = {};
+    HANDLE file_handle = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) { return false; }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    HANDLE mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_handle) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    void *data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    mapped_file->data = data;
+    mapped_file->size = (size_t) file_size.QuadPart;
+    mapped_file->file_handle = file_handle;
+    mapped_file->mapping_handle = mapping_handle;
+    return true;
+}
+
+void unmap_file(MappedFile *mapped_file) {
+    if (!mapped_file->data) { return; }
+    UnmapViewOfFile(mapped_file->data);
+    CloseHandle(mapped_file->mapping_handle);
+    CloseHandle(mapped_file->file_handle);
+    *mapped_file = {};
+}
+#else
+bool map_file(const char *filepath, MappedFile *mapped_file) {
+    *mapped_file = {};
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) { return false; }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // 映射建立后即可关闭文件描述符
+    if (data == MAP_FAILED) { return false; }
+
+    mapped_file->data = data;
+    mapped_file->size = file_stat.st_size;
+    return true;
+}
+
+void unmap_file(MappedFile *mapped_file) {
+    if (!mapped_file->data) { return; }
+    munmap((void *) mapped_file->data, mapped_file->size);
+    *mapped_file = {};
+}
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+// 只读内存映射文件
+struct MappedFile {
+    const void *data;
+    size_t size;
+#if defined(PLATFORM_WINDOWS)
+    void *file_handle;
+    void *mapping_handle;
+#endif
+};
+
+// 文件不存在或无法映射时返回 false
+bool map_file(const char *filepath, MappedFile *mapped_file);
+
+void unmap_file(MappedFile *mapped_file);
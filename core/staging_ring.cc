@@ -0,0 +1,27 @@
+#include "core/staging_ring.h"
+#include "core/logging.h"
+
+uint64_t staging_ring_get_allocation_head(const StagingRing *ring, size_t size) {
+    ASSERT(size <= ring->capacity);
+    uint64_t head = (ring->head + ring->alignment - 1) & ~(ring->alignment - 1);
+    uint64_t offset = head % ring->capacity;
+    if (offset + size > ring->capacity) { head += ring->capacity - offset; }
+    return head;
+}
+
+bool staging_ring_can_allocate(const StagingRing *ring, uint64_t head, size_t size) {
+    if (ring->tail == ring->head) { return true; }
+    return head + size - ring->tail <= ring->capacity;
+}
+
+uint64_t staging_ring_allocate(StagingRing *ring, uint64_t head, size_t size) {
+    ASSERT(head >= ring->head && staging_ring_can_allocate(ring, head, size));
+    if (ring->tail == ring->head) { ring->tail = head; }
+    ring->head = head + size;
+    return head % ring->capacity;
+}
+
+void staging_ring_release(StagingRing *ring, uint64_t end) {
+    // ring 全部回收后 tail 可能已跳过只使用独立 staging buffer 的批次
+    if (end > ring->tail) { ring->tail = end; }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 环形 staging 空间的位置计算，不持有内存，可在 cpu 上单独测试
+// head 与 tail 单调递增，对 capacity 取模得到实际偏移，[tail, head) 为尚未回收的数据
+struct StagingRing {
+    uint64_t capacity;
+    uint64_t alignment; // 2 的幂
+    uint64_t head;      // 下一次分配的位置
+    uint64_t tail;      // 已回收到的位置
+};
+
+// 分配 `size` 字节的起始位置，按 alignment 对齐且不跨越末尾，放不下时跳到开头，`size` 不能超过 capacity
+uint64_t staging_ring_get_allocation_head(const StagingRing *ring, size_t size);
+
+// 从 `head` 开始分配是否不会覆盖尚未回收的数据，ring 已全部回收时总是成立
+bool staging_ring_can_allocate(const StagingRing *ring, uint64_t head, size_t size);
+
+// 从 `head` 开始分配 `size` 字节，返回实际偏移；ring 已全部回收时 tail 跟随到 `head`，跳过的末尾空间不再计入占用
+uint64_t staging_ring_allocate(StagingRing *ring, uint64_t head, size_t size);
+
+// 回收到 `end` 为止，`end` 落后于 tail 时忽略
+void staging_ring_release(StagingRing *ring, uint64_t end);
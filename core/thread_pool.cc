@@ -0,0 +1,100 @@
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+static void worker_main(ThreadPool *thread_pool) {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(thread_pool->mutex);
+            thread_pool->job_available.wait(lock, [thread_pool] { return thread_pool->is_stopping || !thread_pool->jobs.empty(); });
+            if (thread_pool->is_stopping && thread_pool->jobs.empty()) { return; }
+            job = std::move(thread_pool->jobs.front());
+            thread_pool->jobs.pop_front();
+        }
+        job();
+    }
+}
+
+void thread_pool_create(uint32_t thread_count, ThreadPool **out_thread_pool) {
+    ThreadPool *thread_pool = new ThreadPool();
+    thread_pool->is_stopping = false;
+    thread_pool->workers.reserve(thread_count);
+    for (uint32_t i = 0; i < thread_count; ++i) {
+        thread_pool->workers.emplace_back(worker_main, thread_pool);
+    }
+    *out_thread_pool = thread_pool;
+}
+
+void thread_pool_destroy(ThreadPool *thread_pool) {
+    {
+        std::lock_guard<std::mutex> lock(thread_pool->mutex);
+        thread_pool->is_stopping = true;
+    }
+    thread_pool->job_available.notify_all();
+    for (std::thread &worker: thread_pool->workers) { worker.join(); }
+    delete thread_pool;
+}
+
+void thread_pool_submit(ThreadPool *thread_pool, std::function<void()> job) {
+    if (thread_pool->workers.empty()) {
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(thread_pool->mutex);
+        thread_pool->jobs.push_back(std::move(job));
+    }
+    thread_pool->job_available.notify_one();
+}
+
+struct ParallelForState {
+    std::atomic<uint32_t> next_index;
+    std::atomic<uint32_t> completed_count;
+    uint32_t count;
+    std::function<void(uint32_t)> func;
+    std::mutex mutex;
+    std::condition_variable done;
+};
+
+// 不断领取下一个 index 执行，直到全部领取完毕
+static void parallel_for_drain(ParallelForState *state) {
+    uint32_t index;
+    while ((index = state->next_index.fetch_add(1)) < state->count) {
+        state->func(index);
+        if (state->completed_count.fetch_add(1) + 1 == state->count) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->done.notify_all();
+        }
+    }
+}
+
+void thread_pool_parallel_for(ThreadPool *thread_pool, uint32_t count, const std::function<void(uint32_t index)> &func) {
+    if (count == 0) { return; }
+    if (!thread_pool || thread_pool->workers.empty() || count == 1) {
+        for (uint32_t i = 0; i < count; ++i) { func(i); }
+        return;
+    }
+
+    // 工作线程可能在本函数返回后才开始执行辅助任务，因此状态需由 shared_ptr 持有
+    std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+    state->next_index = 0;
+    state->completed_count = 0;
+    state->count = count;
+    state->func = func;
+
+    uint32_t helper_count = std::min<uint32_t>(thread_pool->workers.size(), count - 1);
+    for (uint32_t i = 0; i < helper_count; ++i) {
+        thread_pool_submit(thread_pool, [state] { parallel_for_drain(state.get()); });
+    }
+
+    parallel_for_drain(state.get());
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state] { return state->completed_count.load() == state->count; });
+}
+
+uint32_t thread_pool_worker_count(const ThreadPool *thread_pool) {
+    return thread_pool ? thread_pool->workers.size() : 0;
+}
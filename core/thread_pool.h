@@ -0,0 +1,31 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定数量工作线程的线程池，用于资源导入等可并行的 cpu 任务
+struct ThreadPool {
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable job_available;
+    bool is_stopping;
+};
+
+// `thread_count` 为 0 时不创建工作线程，所有任务在调用线程上串行执行
+void thread_pool_create(uint32_t thread_count, ThreadPool **out_thread_pool);
+
+void thread_pool_destroy(ThreadPool *thread_pool);
+
+void thread_pool_submit(ThreadPool *thread_pool, std::function<void()> job);
+
+// 并行执行 func(0) ... func(count - 1)，调用线程也参与执行，全部完成后才返回
+// `thread_pool` 可以为 nullptr，此时退化为串行执行
+void thread_pool_parallel_for(ThreadPool *thread_pool, uint32_t count, const std::function<void(uint32_t index)> &func);
+
+uint32_t thread_pool_worker_count(const ThreadPool *thread_pool);
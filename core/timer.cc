@@ -0,0 +1,8 @@
+#include "core/timer.h"
+#include <chrono>
+
+uint64_t timer_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double timer_elapsed_ms(uint64_t start_ns) { return (double) (timer_now_ns() - start_ns) / 1e6; }
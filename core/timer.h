@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+
+// 单调时钟，单位纳秒，仅用于统计耗时
+uint64_t timer_now_ns();
+
+double timer_elapsed_ms(uint64_t start_ns);
@@ -0,0 +1,209 @@
+#include "frustum_cull.h"
+#include "core/logging.h"
+#include "core/timer.h"
+#include <bitset>
+#include <cfloat>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FRUSTUM_CULL_AVX2 1
+#define FRUSTUM_CULL_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FRUSTUM_CULL_SSE2 1
+#endif
+
+void resize_cull_bounds(CullBounds *bounds, uint32_t count) {
+    bounds->count = count;
+    for (uint32_t i = 0; i < 3; ++i) {
+        bounds->centers[i].resize(count, 0.0f);
+        bounds->extents[i].resize(count, 0.0f);
+    }
+}
+
+void set_cull_bounds(CullBounds *bounds, uint32_t index, const glm::mat4 &model, const glm::vec3 &aabb_min, const glm::vec3 &aabb_max) {
+    ASSERT(index < bounds->count);
+    // 中心直接变换，半边长按矩阵各元素的绝对值投影到世界轴上（Arvo）
+    glm::vec3 center = glm::vec3(model * glm::vec4((aabb_min + aabb_max) * 0.5f, 1.0f));
+    glm::vec3 half_size = (aabb_max - aabb_min) * 0.5f;
+    glm::vec3 extent = glm::abs(glm::vec3(model[0])) * half_size.x + glm::abs(glm::vec3(model[1])) * half_size.y + glm::abs(glm::vec3(model[2])) * half_size.z;
+    for (uint32_t i = 0; i < 3; ++i) {
+        bounds->centers[i][index] = center[i];
+        bounds->extents[i][index] = extent[i];
+    }
+}
+
+void set_cull_bounds_unbounded(CullBounds *bounds, uint32_t index) {
+    ASSERT(index < bounds->count);
+    // 半边长乘以平面法线的分量后至多为 inf，不会产生 nan
+    for (uint32_t i = 0; i < 3; ++i) {
+        bounds->centers[i][index] = 0.0f;
+        bounds->extents[i][index] = FLT_MAX;
+    }
+}
+
+void extract_frustum_planes(const glm::mat4 &view_projection, glm::vec4 planes[6]) {
+    glm::vec4 rows[4];
+    for (uint32_t i = 0; i < 4; ++i) { rows[i] = glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]); }
+    planes[0] = rows[3] + rows[0];
+    planes[1] = rows[3] - rows[0];
+    planes[2] = rows[3] + rows[1];
+    planes[3] = rows[3] - rows[1];
+    planes[4] = rows[3] + rows[2];
+    planes[5] = rows[3] - rows[2];
+    for (uint32_t i = 0; i < 6; ++i) { planes[i] /= glm::length(glm::vec3(planes[i])); }
+}
+
+// 包围盒在平面法线上的投影半径 r = dot(extent, abs(n))，中心到平面的距离 d < -r 时完全在外侧
+static bool is_box_visible(const glm::vec4 planes[6], const CullBounds *bounds, uint32_t index) {
+    for (uint32_t i = 0; i < 6; ++i) {
+        float distance = planes[i].x * bounds->centers[0][index] + planes[i].y * bounds->centers[1][index] + planes[i].z * bounds->centers[2][index] + planes[i].w;
+        float radius = std::abs(planes[i].x) * bounds->extents[0][index] + std::abs(planes[i].y) * bounds->extents[1][index] +
+                       std::abs(planes[i].z) * bounds->extents[2][index];
+        if (distance + radius < 0.0f) { return false; }
+    }
+    return true;
+}
+
+static void frustum_cull_scalar(const glm::vec4 planes[6], const CullBounds *bounds, uint32_t begin, uint32_t end, uint64_t *visibility) {
+    for (uint32_t i = begin; i < end; ++i) {
+        if (is_box_visible(planes, bounds, i)) { visibility[i / 64] |= 1ull << (i % 64); }
+    }
+}
+
+#if FRUSTUM_CULL_SSE2
+// 每次处理 4 个包围盒，begin 为 4 的倍数，4 位掩码不会跨越 u64
+static uint32_t frustum_cull_sse2(const glm::vec4 planes[6], const CullBounds *bounds, uint32_t begin, uint32_t end, uint64_t *visibility) {
+    const __m128 zero = _mm_setzero_ps();
+    __m128 normals[6][3], abs_normals[6][3], offsets[6];
+    for (uint32_t p = 0; p < 6; ++p) {
+        for (uint32_t k = 0; k < 3; ++k) {
+            normals[p][k] = _mm_set1_ps(planes[p][k]);
+            abs_normals[p][k] = _mm_set1_ps(std::abs(planes[p][k]));
+        }
+        offsets[p] = _mm_set1_ps(planes[p].w);
+    }
+
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 cx = _mm_loadu_ps(&bounds->centers[0][i]), cy = _mm_loadu_ps(&bounds->centers[1][i]), cz = _mm_loadu_ps(&bounds->centers[2][i]);
+        __m128 ex = _mm_loadu_ps(&bounds->extents[0][i]), ey = _mm_loadu_ps(&bounds->extents[1][i]), ez = _mm_loadu_ps(&bounds->extents[2][i]);
+        __m128 visible = _mm_cmpeq_ps(zero, zero);
+        for (uint32_t p = 0; p < 6; ++p) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normals[p][0], cx), _mm_mul_ps(normals[p][1], cy)),
+                                         _mm_add_ps(_mm_mul_ps(normals[p][2], cz), offsets[p]));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_normals[p][0], ex), _mm_mul_ps(abs_normals[p][1], ey)), _mm_mul_ps(abs_normals[p][2], ez));
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+        }
+        visibility[i / 64] |= (uint64_t) _mm_movemask_ps(visible) << (i % 64);
+    }
+    return i;
+}
+#endif
+
+#if FRUSTUM_CULL_AVX2
+// 每次处理 8 个包围盒，begin 为 8 的倍数
+static uint32_t frustum_cull_avx2(const glm::vec4 planes[6], const CullBounds *bounds, uint32_t begin, uint32_t end, uint64_t *visibility) {
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 normals[6][3], abs_normals[6][3], offsets[6];
+    for (uint32_t p = 0; p < 6; ++p) {
+        for (uint32_t k = 0; k < 3; ++k) {
+            normals[p][k] = _mm256_set1_ps(planes[p][k]);
+            abs_normals[p][k] = _mm256_set1_ps(std::abs(planes[p][k]));
+        }
+        offsets[p] = _mm256_set1_ps(planes[p].w);
+    }
+
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 cx = _mm256_loadu_ps(&bounds->centers[0][i]), cy = _mm256_loadu_ps(&bounds->centers[1][i]), cz = _mm256_loadu_ps(&bounds->centers[2][i]);
+        __m256 ex = _mm256_loadu_ps(&bounds->extents[0][i]), ey = _mm256_loadu_ps(&bounds->extents[1][i]), ez = _mm256_loadu_ps(&bounds->extents[2][i]);
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (uint32_t p = 0; p < 6; ++p) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(normals[p][0], cx), _mm256_mul_ps(normals[p][1], cy)),
+                                            _mm256_add_ps(_mm256_mul_ps(normals[p][2], cz), offsets[p]));
+            __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(abs_normals[p][0], ex), _mm256_mul_ps(abs_normals[p][1], ey)),
+                                          _mm256_mul_ps(abs_normals[p][2], ez));
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+        }
+        visibility[i / 64] |= (uint64_t) _mm256_movemask_ps(visible) << (i % 64);
+    }
+    return i;
+}
+#endif
+
+static uint32_t count_visible(const uint64_t *visibility, uint32_t word_count) {
+    uint32_t visible_count = 0;
+    for (uint32_t i = 0; i < word_count; ++i) { visible_count += std::bitset<64>(visibility[i]).count(); }
+    return visible_count;
+}
+
+uint32_t frustum_cull(const glm::vec4 planes[6], const CullBounds *bounds, uint64_t *visibility) {
+    uint32_t word_count = get_visibility_word_count(bounds->count);
+    memset(visibility, 0, word_count * sizeof(uint64_t));
+
+    uint32_t i = 0;
+#if FRUSTUM_CULL_AVX2
+    i = frustum_cull_avx2(planes, bounds, i, bounds->count, visibility);
+#endif
+#if FRUSTUM_CULL_SSE2
+    i = frustum_cull_sse2(planes, bounds, i, bounds->count, visibility);
+#endif
+    frustum_cull_scalar(planes, bounds, i, bounds->count, visibility);
+    return count_visible(visibility, word_count);
+}
+
+void frustum_cull_benchmark(uint32_t box_count, uint32_t iteration_count) {
+    // 包围盒均匀分布在相机周围，约 1/10 落在视锥内
+    CullBounds bounds{};
+    resize_cull_bounds(&bounds, box_count);
+    uint32_t seed = 1;
+    auto random = [&seed](float min, float max) {
+        seed = seed * 1664525u + 1013904223u;
+        return min + (max - min) * (float) (seed >> 8) / (float) (1u << 24);
+    };
+    for (uint32_t i = 0; i < box_count; ++i) {
+        glm::vec3 center(random(-100.0f, 100.0f), random(-100.0f, 100.0f), random(-100.0f, 100.0f));
+        glm::vec3 half_size(random(0.1f, 2.0f), random(0.1f, 2.0f), random(0.1f, 2.0f));
+        set_cull_bounds(&bounds, i, glm::mat4(1.0f), center - half_size, center + half_size);
+    }
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.01f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::vec4 planes[6];
+    extract_frustum_planes(projection * view, planes);
+
+    uint32_t word_count = get_visibility_word_count(box_count);
+    std::vector<uint64_t> simd_visibility(word_count), scalar_visibility(word_count);
+
+    uint32_t visible_count = 0;
+    uint64_t start_time = timer_now_ns();
+    for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) { visible_count = frustum_cull(planes, &bounds, simd_visibility.data()); }
+    double simd_ms = timer_elapsed_ms(start_time);
+
+    start_time = timer_now_ns();
+    for (uint32_t iteration = 0; iteration < iteration_count; ++iteration) {
+        memset(scalar_visibility.data(), 0, word_count * sizeof(uint64_t));
+        frustum_cull_scalar(planes, &bounds, 0, box_count, scalar_visibility.data());
+    }
+    double scalar_ms = timer_elapsed_ms(start_time);
+
+    ASSERT_MESSAGE(simd_visibility == scalar_visibility, "frustum cull %s result differs from scalar", frustum_cull_simd_name());
+
+    double total_boxes = (double) box_count * iteration_count;
+    log_info("frustum cull benchmark: %u boxes, %u visible, %u iterations, %.1f boxes/us %s, %.1f boxes/us scalar", box_count, visible_count,
+             iteration_count, simd_ms > 0.0 ? total_boxes / (simd_ms * 1e3) : 0.0, frustum_cull_simd_name(),
+             scalar_ms > 0.0 ? total_boxes / (scalar_ms * 1e3) : 0.0);
+}
+
+const char *frustum_cull_simd_name() {
+#if FRUSTUM_CULL_AVX2
+    return "avx2";
+#elif FRUSTUM_CULL_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
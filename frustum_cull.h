@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#define FRUSTUM_CULL_BENCHMARK_BOX_COUNT 131072
+#define FRUSTUM_CULL_BENCHMARK_ITERATION_COUNT 100
+
+// 世界空间的 aabb 以中心与半边长按分量 SoA 存放，各数组的同一下标为同一个包围盒，供 SIMD 批量剔除
+struct CullBounds {
+    uint32_t count;
+    std::vector<float> centers[3]; // x, y, z
+    std::vector<float> extents[3];
+};
+
+// 调整包围盒个数，已有的包围盒保持不变
+void resize_cull_bounds(CullBounds *bounds, uint32_t count);
+
+// 模型空间的 aabb 经 `model` 变换后取其世界空间 aabb，写入 `index`
+void set_cull_bounds(CullBounds *bounds, uint32_t index, const glm::mat4 &model, const glm::vec3 &aabb_min, const glm::vec3 &aabb_max);
+
+// 写入一个总是可见的包围盒，用于没有可靠包围盒的对象（如蒙皮实例）
+void set_cull_bounds_unbounded(CullBounds *bounds, uint32_t index);
+
+// Gribb-Hartmann，从 view projection 矩阵中提取归一化的世界空间视锥平面，顺序为 left, right, bottom, top, near, far
+// 投影矩阵的深度范围为 [-1, 1]，比 vulkan 的 [0, 1] 更宽，剔除结果偏保守
+void extract_frustum_planes(const glm::mat4 &view_projection, glm::vec4 planes[6]);
+
+// 可见性位集需要的 u64 个数
+inline uint32_t get_visibility_word_count(uint32_t count) { return (count + 63) / 64; }
+
+inline bool is_visible(const uint64_t *visibility, uint32_t index) { return (visibility[index / 64] >> (index % 64)) & 1; }
+
+// 每次迭代测试 8 个（avx2）或 4 个（sse2）包围盒，与任一平面完全在外侧的为不可见
+// 结果写入 `visibility` 的前 get_visibility_word_count(bounds->count) 个 u64，第 i 位为 1 表示可见，返回可见的个数
+uint32_t frustum_cull(const glm::vec4 planes[6], const CullBounds *bounds, uint64_t *visibility);
+
+// 以随机分布的包围盒比较 SIMD 与标量实现的吞吐，并校验两者结果一致
+void frustum_cull_benchmark(uint32_t box_count, uint32_t iteration_count);
+
+// 编译时启用的指令集，用于日志输出
+const char *frustum_cull_simd_name();
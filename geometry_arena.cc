@@ -0,0 +1,100 @@
+#include "geometry_arena.h"
+#include "core/logging.h"
+
+// 顶点范围按 16 字节对齐，满足 Vertex 中 alignas(16) 成员在 std430 下的对齐要求
+#define GEOMETRY_ARENA_VERTEX_ALIGNMENT 16
+#define GEOMETRY_ARENA_INDEX_ALIGNMENT 4 // 按最宽的 u32 对齐，各索引类型的 firstIndex 都能由字节偏移整除得到
+
+static void create_virtual_block(size_t size, VmaVirtualBlock *block) {
+    VmaVirtualBlockCreateInfo block_create_info{};
+    block_create_info.size = size;
+    VkResult result = vmaCreateVirtualBlock(&block_create_info, block);
+    ASSERT(result == VK_SUCCESS);
+}
+
+void geometry_arena_create(VkContext *vk_context, size_t vertex_capacity, size_t index_capacity, GeometryArena **out_arena) {
+    GeometryArena *arena = new GeometryArena();
+    arena->vertex_capacity = vertex_capacity;
+    arena->index_capacity = index_capacity;
+
+    vk_create_buffer(vk_context, vertex_capacity,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                     VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY, &arena->vertex_buffer);
+
+    VkBufferDeviceAddressInfo buffer_device_address_info{};
+    buffer_device_address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+    buffer_device_address_info.buffer = arena->vertex_buffer.handle;
+    arena->vertex_buffer_device_address = vkGetBufferDeviceAddress(vk_context->device, &buffer_device_address_info);
+
+    vk_create_buffer(vk_context, index_capacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VMA_MEMORY_USAGE_GPU_ONLY, &arena->index_buffer);
+
+    create_virtual_block(vertex_capacity, &arena->vertex_block);
+    create_virtual_block(index_capacity, &arena->index_block);
+
+    log_info("geometry arena created: vertex %.1f MB, index %.1f MB", vertex_capacity / (1024.0 * 1024.0), index_capacity / (1024.0 * 1024.0));
+
+    *out_arena = arena;
+}
+
+void geometry_arena_destroy(VkContext *vk_context, GeometryArena *arena) {
+    // 未释放的范围会触发 vma 的断言，这里先清空
+    vmaClearVirtualBlock(arena->index_block);
+    vmaClearVirtualBlock(arena->vertex_block);
+    vmaDestroyVirtualBlock(arena->index_block);
+    vmaDestroyVirtualBlock(arena->vertex_block);
+    vk_destroy_buffer(vk_context, &arena->index_buffer);
+    vk_destroy_buffer(vk_context, &arena->vertex_buffer);
+    delete arena;
+}
+
+static bool alloc_range(VmaVirtualBlock block, size_t size, size_t alignment, GeometryRange *range) {
+    VmaVirtualAllocationCreateInfo allocation_create_info{};
+    allocation_create_info.size = size;
+    allocation_create_info.alignment = alignment;
+    VkDeviceSize offset = 0;
+    if (vmaVirtualAllocate(block, &allocation_create_info, &range->allocation, &offset) != VK_SUCCESS) {
+        *range = {};
+        return false;
+    }
+    range->offset = offset;
+    range->size = size;
+    return true;
+}
+
+bool geometry_arena_alloc_vertices(GeometryArena *arena, size_t size, GeometryRange *range) {
+    if (!alloc_range(arena->vertex_block, size, GEOMETRY_ARENA_VERTEX_ALIGNMENT, range)) {
+        log_error("geometry arena out of vertex memory, request %zu bytes, capacity %zu bytes", size, arena->vertex_capacity);
+        return false;
+    }
+    return true;
+}
+
+bool geometry_arena_alloc_indices(GeometryArena *arena, size_t size, GeometryRange *range) {
+    if (!alloc_range(arena->index_block, size, GEOMETRY_ARENA_INDEX_ALIGNMENT, range)) {
+        log_error("geometry arena out of index memory, request %zu bytes, capacity %zu bytes", size, arena->index_capacity);
+        return false;
+    }
+    return true;
+}
+
+void geometry_arena_free_vertices(GeometryArena *arena, GeometryRange *range) {
+    if (range->allocation == VK_NULL_HANDLE) { return; }
+    vmaVirtualFree(arena->vertex_block, range->allocation);
+    *range = {};
+}
+
+void geometry_arena_free_indices(GeometryArena *arena, GeometryRange *range) {
+    if (range->allocation == VK_NULL_HANDLE) { return; }
+    vmaVirtualFree(arena->index_block, range->allocation);
+    *range = {};
+}
+
+void geometry_arena_log_stats(const GeometryArena *arena) {
+    VmaStatistics vertex_stats, index_stats;
+    vmaGetVirtualBlockStatistics(arena->vertex_block, &vertex_stats);
+    vmaGetVirtualBlockStatistics(arena->index_block, &index_stats);
+    log_info("geometry arena: vertex %u ranges, %.2f / %.2f MB; index %u ranges, %.2f / %.2f MB",
+             vertex_stats.allocationCount, vertex_stats.allocationBytes / (1024.0 * 1024.0), arena->vertex_capacity / (1024.0 * 1024.0),
+             index_stats.allocationCount, index_stats.allocationBytes / (1024.0 * 1024.0), arena->index_capacity / (1024.0 * 1024.0));
+}
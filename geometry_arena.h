@@ -0,0 +1,39 @@
+#pragma once
+
+#include "vk_buffer.h"
+
+// 所有 mesh 共用的顶点/索引大缓冲，按范围子分配（vma virtual block，tlsf 算法）
+// 顶点缓冲通过 device address 访问，可存放任意顶点格式与位置流；索引缓冲每帧只需绑定一次
+struct GeometryArena {
+    Buffer vertex_buffer;
+    VkDeviceAddress vertex_buffer_device_address;
+    VmaVirtualBlock vertex_block;
+    size_t vertex_capacity;
+
+    Buffer index_buffer;
+    VmaVirtualBlock index_block;
+    size_t index_capacity;
+};
+
+// arena 中的一段范围，offset 与 size 以字节计
+struct GeometryRange {
+    VmaVirtualAllocation allocation;
+    uint64_t offset;
+    uint64_t size;
+};
+
+void geometry_arena_create(VkContext *vk_context, size_t vertex_capacity, size_t index_capacity, GeometryArena **out_arena);
+
+void geometry_arena_destroy(VkContext *vk_context, GeometryArena *arena);
+
+// 空间不足时返回 false
+bool geometry_arena_alloc_vertices(GeometryArena *arena, size_t size, GeometryRange *range);
+
+bool geometry_arena_alloc_indices(GeometryArena *arena, size_t size, GeometryRange *range);
+
+// 调用方需保证 gpu 已不再访问该范围
+void geometry_arena_free_vertices(GeometryArena *arena, GeometryRange *range);
+
+void geometry_arena_free_indices(GeometryArena *arena, GeometryRange *range);
+
+void geometry_arena_log_stats(const GeometryArena *arena);
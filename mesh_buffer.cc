@@ -1,49 +1,171 @@
 #include "mesh_buffer.h"
-#include "vk_command_buffer.h"
-#include "vk_queue.h"
-#include "vk_fence.h"
+#include "core/logging.h"
+#include <algorithm>
+#include <cmath>
 
-void create_mesh_buffer(VkContext *vk_context, const void *vertices, uint32_t vertex_count, uint32_t vertex_stride,
-                        const void *indices, uint32_t index_count, uint32_t index_stride, MeshBuffer *mesh_buffer) {
+void create_mesh_buffer(UploadEngine *upload_engine, GeometryArena *arena, const void *vertices, uint32_t vertex_count, uint32_t vertex_stride,
+                        const void *positions, uint32_t position_stride, const SkinVertex *skin_vertices,
+                        const void *indices, size_t index_data_size,
+                        const Meshlet *meshlets, uint32_t meshlet_count, MeshBuffer *mesh_buffer) {
     const size_t vertex_buffer_size = vertex_count * vertex_stride;
-    const size_t index_buffer_size = index_count * index_stride;
+    const size_t position_buffer_size = positions ? vertex_count * position_stride : 0;
+    const size_t index_buffer_size = index_data_size;
+    const size_t meshlet_buffer_size = meshlet_count * sizeof(Meshlet);
+    const size_t skin_buffer_size = skin_vertices ? vertex_count * sizeof(SkinVertex) : 0;
 
-    // vertex buffer
-    vk_create_buffer(vk_context, vertex_buffer_size,
-                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-                     VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY, &mesh_buffer->vertex_buffer);
+    *mesh_buffer = {};
+    mesh_buffer->vertex_count = vertex_count;
 
-    VkBufferDeviceAddressInfo buffer_device_address_info{};
-    buffer_device_address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
-    buffer_device_address_info.buffer = mesh_buffer->vertex_buffer.handle;
-    mesh_buffer->vertex_buffer_device_address = vkGetBufferDeviceAddress(vk_context->device,
-                                                                         &buffer_device_address_info);
+    bool succeed = geometry_arena_alloc_vertices(arena, vertex_buffer_size, &mesh_buffer->vertex_range);
+    ASSERT(succeed);
+    mesh_buffer->vertex_buffer_device_address = arena->vertex_buffer_device_address + mesh_buffer->vertex_range.offset;
 
-    // index buffer
-    vk_create_buffer(vk_context, index_buffer_size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                     VMA_MEMORY_USAGE_GPU_ONLY, &mesh_buffer->index_buffer);
+    if (positions) {
+        succeed = geometry_arena_alloc_vertices(arena, position_buffer_size, &mesh_buffer->position_range);
+        ASSERT(succeed);
+        mesh_buffer->position_buffer_device_address = arena->vertex_buffer_device_address + mesh_buffer->position_range.offset;
+    }
 
-    // upload data
-    Buffer staging_buffer;
-    vk_create_buffer(vk_context, vertex_buffer_size + index_buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                     VMA_MEMORY_USAGE_CPU_ONLY, &staging_buffer);
+    // meshlet 与顶点同样通过 device address 读取，放在顶点区域中
+    if (meshlet_count > 0) {
+        succeed = geometry_arena_alloc_vertices(arena, meshlet_buffer_size, &mesh_buffer->meshlet_range);
+        ASSERT(succeed);
+        mesh_buffer->meshlet_buffer_device_address = arena->vertex_buffer_device_address + mesh_buffer->meshlet_range.offset;
+        mesh_buffer->meshlet_count = meshlet_count;
+    }
 
-    VmaAllocationInfo staging_buffer_allocation_info;
-    vmaGetAllocationInfo(vk_context->allocator, staging_buffer.allocation, &staging_buffer_allocation_info);
+    if (skin_vertices) {
+        succeed = geometry_arena_alloc_vertices(arena, skin_buffer_size, &mesh_buffer->skin_range);
+        ASSERT(succeed);
+        mesh_buffer->skin_buffer_device_address = arena->vertex_buffer_device_address + mesh_buffer->skin_range.offset;
+    }
 
-    void *dst = staging_buffer_allocation_info.pMappedData;
-    memcpy(dst, vertices, vertex_buffer_size);
-    memcpy((void *) ((uintptr_t) dst + vertex_buffer_size), indices, index_buffer_size);
+    succeed = geometry_arena_alloc_indices(arena, index_buffer_size, &mesh_buffer->index_range);
+    ASSERT(succeed);
 
-    vk_command_buffer_submit(vk_context, [&](VkCommandBuffer command_buffer) {
-        vk_command_copy_buffer(command_buffer, staging_buffer.handle, mesh_buffer->vertex_buffer.handle, vertex_buffer_size, 0, 0);
-        vk_command_copy_buffer(command_buffer, staging_buffer.handle, mesh_buffer->index_buffer.handle, index_buffer_size, vertex_buffer_size, 0);
-    });
+    upload_buffer(upload_engine, arena->vertex_buffer.handle, mesh_buffer->vertex_range.offset, vertices, vertex_buffer_size);
+    if (positions) { upload_buffer(upload_engine, arena->vertex_buffer.handle, mesh_buffer->position_range.offset, positions, position_buffer_size); }
+    if (meshlet_count > 0) { upload_buffer(upload_engine, arena->vertex_buffer.handle, mesh_buffer->meshlet_range.offset, meshlets, meshlet_buffer_size); }
+    if (skin_vertices) { upload_buffer(upload_engine, arena->vertex_buffer.handle, mesh_buffer->skin_range.offset, skin_vertices, skin_buffer_size); }
+    mesh_buffer->upload_token = upload_buffer(upload_engine, arena->index_buffer.handle, mesh_buffer->index_range.offset, indices, index_buffer_size);
+}
+
+void destroy_mesh_buffer(GeometryArena *arena, MeshBuffer *mesh_buffer) {
+    geometry_arena_free_indices(arena, &mesh_buffer->index_range);
+    geometry_arena_free_vertices(arena, &mesh_buffer->skin_range);
+    geometry_arena_free_vertices(arena, &mesh_buffer->meshlet_range);
+    geometry_arena_free_vertices(arena, &mesh_buffer->position_range);
+    geometry_arena_free_vertices(arena, &mesh_buffer->vertex_range);
+}
+
+uint32_t get_vertex_stride(VertexLayout vertex_layout) {
+    switch (vertex_layout) {
+        case VERTEX_LAYOUT_STANDARD: return sizeof(Vertex);
+        case VERTEX_LAYOUT_PACKED: return sizeof(PackedVertex);
+        default: ASSERT_MESSAGE(false, "unsupported vertex layout - %d", vertex_layout);
+    }
+    return 0;
+}
+
+uint32_t get_index_size(IndexType index_type) {
+    switch (index_type) {
+        case INDEX_TYPE_UINT32: return sizeof(uint32_t);
+        case INDEX_TYPE_UINT16: return sizeof(uint16_t);
+        case INDEX_TYPE_UINT8: return sizeof(uint8_t);
+        default: ASSERT_MESSAGE(false, "unsupported index type - %d", index_type);
+    }
+    return 0;
+}
+
+VkIndexType get_vk_index_type(IndexType index_type) {
+    switch (index_type) {
+        case INDEX_TYPE_UINT32: return VK_INDEX_TYPE_UINT32;
+        case INDEX_TYPE_UINT16: return VK_INDEX_TYPE_UINT16;
+        case INDEX_TYPE_UINT8: return VK_INDEX_TYPE_UINT8_EXT;
+        default: ASSERT_MESSAGE(false, "unsupported index type - %d", index_type);
+    }
+    return VK_INDEX_TYPE_UINT32;
+}
+
+// 未开启 primitive restart，0xff 与 0xffff 也是有效的索引
+IndexType select_index_type(uint32_t vertex_count, bool is_uint8_supported) {
+    if (is_uint8_supported && vertex_count <= 256) { return INDEX_TYPE_UINT8; }
+    if (vertex_count <= 65536) { return INDEX_TYPE_UINT16; }
+    return INDEX_TYPE_UINT32;
+}
 
-    vk_destroy_buffer(vk_context, &staging_buffer);
+uint32_t get_first_index(const MeshBuffer *mesh_buffer, IndexType index_type) {
+    return mesh_buffer->index_range.offset / get_index_size(index_type);
 }
 
-void destroy_mesh_buffer(VkContext *vk_context, MeshBuffer *mesh_buffer) {
-    vk_destroy_buffer(vk_context, &mesh_buffer->index_buffer);
-    vk_destroy_buffer(vk_context, &mesh_buffer->vertex_buffer);
+uint32_t get_position_stride(VertexLayout vertex_layout) {
+    switch (vertex_layout) {
+        case VERTEX_LAYOUT_STANDARD: return sizeof(float) * 3;
+        case VERTEX_LAYOUT_PACKED: return sizeof(PackedPosition);
+        default: ASSERT_MESSAGE(false, "unsupported vertex layout - %d", vertex_layout);
+    }
+    return 0;
+}
+
+void extract_positions(const void *vertices, uint32_t vertex_count, VertexLayout vertex_layout, void *positions) {
+    if (vertex_layout == VERTEX_LAYOUT_PACKED) {
+        const PackedVertex *packed_vertices = (const PackedVertex *) vertices;
+        PackedPosition *packed_positions = (PackedPosition *) positions;
+        for (uint32_t i = 0; i < vertex_count; ++i) {
+            memcpy(packed_positions[i].pos, packed_vertices[i].pos, sizeof(packed_positions[i].pos));
+            packed_positions[i].padding = 0;
+        }
+    } else {
+        const Vertex *standard_vertices = (const Vertex *) vertices;
+        float *float_positions = (float *) positions;
+        for (uint32_t i = 0; i < vertex_count; ++i) {
+            memcpy(float_positions + i * 3, standard_vertices[i].pos, sizeof(float) * 3);
+        }
+    }
+}
+
+// 八面体映射，结果在 [-1, 1]^2
+static glm::vec2 encode_octahedral(glm::vec3 normal) {
+    float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length == 0.0f) { return glm::vec2(0.0f, 0.0f); }
+    normal = normal / length;
+    if (normal.z < 0.0f) {
+        float x = (1.0f - std::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f);
+        float y = (1.0f - std::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f);
+        return glm::vec2(x, y);
+    }
+    return glm::vec2(normal.x, normal.y);
+}
+
+static uint16_t quantize_unorm16(float value) {
+    return (uint16_t) std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f);
+}
+
+void pack_vertices(const Vertex *vertices, uint32_t vertex_count, PackedVertex *packed_vertices, VertexQuantization *quantization) {
+    glm::vec3 aabb_min(0.0f), aabb_max(0.0f);
+    if (vertex_count > 0) {
+        aabb_min = aabb_max = glm::vec3(vertices[0].pos[0], vertices[0].pos[1], vertices[0].pos[2]);
+    }
+    for (uint32_t i = 1; i < vertex_count; ++i) {
+        glm::vec3 pos(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]);
+        aabb_min = glm::min(aabb_min, pos);
+        aabb_max = glm::max(aabb_max, pos);
+    }
+
+    glm::vec3 extent = aabb_max - aabb_min;
+    quantization->position_offset = aabb_min;
+    quantization->position_scale = extent;
+
+    for (uint32_t i = 0; i < vertex_count; ++i) {
+        const Vertex *vertex = &vertices[i];
+        PackedVertex *packed_vertex = &packed_vertices[i];
+        for (uint32_t axis = 0; axis < 3; ++axis) {
+            float t = extent[axis] > 0.0f ? (vertex->pos[axis] - aabb_min[axis]) / extent[axis] : 0.0f;
+            packed_vertex->pos[axis] = quantize_unorm16(t);
+        }
+        packed_vertex->padding = 0;
+        packed_vertex->normal = glm::packSnorm2x16(encode_octahedral(glm::vec3(vertex->normal[0], vertex->normal[1], vertex->normal[2])));
+        packed_vertex->tex_coord = glm::packHalf2x16(glm::vec2(vertex->tex_coord[0], vertex->tex_coord[1]));
+        packed_vertex->color = glm::packUnorm4x8(glm::vec4(vertex->color[0], vertex->color[1], vertex->color[2], vertex->color[3]));
+    }
 }
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "geometry_arena.h"
+#include "upload_engine.h"
 #include "vk_context.h"
-#include "vk_buffer.h"
 #include <glm/glm.hpp>
 
+// Vertex 结构变化时需递增，已烘焙的 mesh 缓存随之失效
+#define VERTEX_LAYOUT_VERSION 2
+
 // 顶点结构，手动构造 mesh 或加载 gltf/glb 模型时，顶点数据需遵循此结构
 struct Vertex {
     alignas(16) float pos[3];
@@ -12,13 +16,110 @@ struct Vertex {
     alignas(16) float color[4] = {1.0f, 1.0f, 1.0f, 1.0f}; // 默认白色
 };
 
+enum VertexLayout : uint32_t {
+    VERTEX_LAYOUT_STANDARD, // Vertex
+    VERTEX_LAYOUT_PACKED,   // PackedVertex
+    VERTEX_LAYOUT_COUNT,
+};
+
+// 压缩顶点，20 字节：位置相对 mesh aabb 量化为 unorm16，法线为八面体编码的 snorm16x2，uv 为 half2，颜色为 unorm8x4
+// 着色器中的解码见 shaders/vertex.glsl
+struct PackedVertex {
+    uint16_t pos[3];
+    uint16_t padding;
+    uint32_t normal;
+    uint32_t tex_coord;
+    uint32_t color;
+};
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex must match the std430 layout in shaders/vertex.glsl");
+
+// 索引类型按 primitive 的顶点数选择，索引相对于 primitive 的首个顶点，不超过 vertex_count - 1
+enum IndexType : uint32_t {
+    INDEX_TYPE_UINT32,
+    INDEX_TYPE_UINT16, // vertex_count <= 65536
+    INDEX_TYPE_UINT8,  // vertex_count <= 256，需要 VK_EXT_index_type_uint8
+    INDEX_TYPE_COUNT,
+};
+
+// 压缩位置的还原参数：pos = position_offset + unorm16(quantized_pos) * position_scale
+struct VertexQuantization {
+    glm::vec3 position_offset;
+    glm::vec3 position_scale;
+};
+
+// 仅含位置的顶点流，与顶点格式对应：standard 为 float3，packed 为 unorm16x3 加 16 位填充
+struct PackedPosition {
+    uint16_t pos[3];
+    uint16_t padding;
+};
+
+// 蒙皮顶点流，与顶点一一对应：4 个关节在所属 skin 中的下标与 unorm16 权重，权重之和为 1
+// 与 shaders/skinning.comp 中的 SkinVertex 对应
+struct SkinVertex {
+    uint16_t joints[4];
+    uint16_t weights[4];
+};
+static_assert(sizeof(SkinVertex) == 16, "SkinVertex must match the std430 layout in shaders/skinning.comp");
+
+// 一组相邻三角形及其包围球与法线锥，与 shaders/meshlet.glsl 中的 Meshlet 对应，坐标均在模型空间
+// 每个 meshlet 对应 lod 0 中一段连续的索引，可直接作为一次 indexed draw
+struct Meshlet {
+    glm::vec3 center;
+    float radius;
+    glm::vec3 cone_apex;
+    float cone_cutoff; // 视线方向与 cone_axis 的夹角余弦不小于该值时整个 meshlet 背向相机
+    glm::vec3 cone_axis;
+    uint32_t index_offset; // 相对于 mesh 首个索引，以所属 primitive 的索引类型计
+    uint32_t index_count;
+    uint32_t vertex_offset; // 所属 primitive 的 vertex_offset
+    uint32_t padding[2];
+};
+static_assert(sizeof(Meshlet) == 64, "Meshlet must match the std430 layout in shaders/meshlet.glsl");
+
+// mesh 在 geometry arena 中占用的范围
 struct MeshBuffer {
-    Buffer vertex_buffer;
-    Buffer index_buffer;
+    GeometryRange vertex_range;
+    GeometryRange position_range; // 可选，仅需位置的 pass（wireframe、depth）只读取此流
+    GeometryRange index_range;
+    GeometryRange meshlet_range; // 可选，供 cluster culling 读取
+    GeometryRange skin_range; // 可选，蒙皮 mesh 的 SkinVertex 流，供 skinning 读取
     VkDeviceAddress vertex_buffer_device_address;
+    VkDeviceAddress position_buffer_device_address; // 没有位置流时为 0
+    VkDeviceAddress meshlet_buffer_device_address;  // 没有 meshlet 时为 0
+    VkDeviceAddress skin_buffer_device_address;     // 不是蒙皮 mesh 时为 0
+    uint32_t vertex_count;
+    uint32_t meshlet_count;
+    VertexLayout vertex_layout;
+    VertexQuantization quantization; // 仅 VERTEX_LAYOUT_PACKED 有效
+    UploadToken upload_token;
 };
 
-void create_mesh_buffer(VkContext *vk_context, const void *vertices, uint32_t vertex_count, uint32_t vertex_stride,
-                        const void *indices, uint32_t index_count, uint32_t index_stride, MeshBuffer *mesh_buffer);
+uint32_t get_vertex_stride(VertexLayout vertex_layout);
+
+uint32_t get_index_size(IndexType index_type);
+
+VkIndexType get_vk_index_type(IndexType index_type);
+
+// `vertex_count` 个顶点可用的最窄索引类型
+IndexType select_index_type(uint32_t vertex_count, bool is_uint8_supported);
+
+// mesh 的索引在 arena 索引缓冲中的起始位置，以 `index_type` 的索引个数计，arena 按 4 字节对齐分配，各类型都能整除
+uint32_t get_first_index(const MeshBuffer *mesh_buffer, IndexType index_type);
+
+uint32_t get_position_stride(VertexLayout vertex_layout);
+
+// 从 `vertex_layout` 格式的顶点中提取位置流，`positions` 需容纳 vertex_count * get_position_stride(vertex_layout) 字节
+void extract_positions(const void *vertices, uint32_t vertex_count, VertexLayout vertex_layout, void *positions);
+
+// 以顶点的 aabb 作为量化范围压缩顶点
+void pack_vertices(const Vertex *vertices, uint32_t vertex_count, PackedVertex *packed_vertices, VertexQuantization *quantization);
+
+// 在 arena 中分配范围并录制上传，`positions` 为 nullptr 时不创建位置流，`skin_vertices` 为 nullptr 时不创建蒙皮流，`meshlet_count` 为 0 时不上传 meshlet
+// `indices` 为各 primitive 按各自索引类型排列的 `index_data_size` 字节
+// 上传随 upload engine 的下一次 flush 提交，之后提交的绘制命令即可使用
+void create_mesh_buffer(UploadEngine *upload_engine, GeometryArena *arena, const void *vertices, uint32_t vertex_count, uint32_t vertex_stride,
+                        const void *positions, uint32_t position_stride, const SkinVertex *skin_vertices,
+                        const void *indices, size_t index_data_size,
+                        const Meshlet *meshlets, uint32_t meshlet_count, MeshBuffer *mesh_buffer);
 
-void destroy_mesh_buffer(VkContext *vk_context, MeshBuffer *mesh_buffer);
+void destroy_mesh_buffer(GeometryArena *arena, MeshBuffer *mesh_buffer);
@@ -0,0 +1,464 @@
+#include "mesh_cache.h"
+#include "core/hash.h"
+#include "core/logging.h"
+#include "core/mapped_file.h"
+#include "core/timer.h"
+#include <filesystem>
+#include <type_traits>
+
+#define MESH_CACHE_MAGIC 0x4853454d // "MESH"
+#define MESH_CACHE_FORMAT_VERSION 14 // 导入结果或文件布局变化时递增
+#define MESH_CACHE_DATA_ALIGNMENT 16
+#define MESH_CACHE_MAX_URI_LENGTH 256
+
+// 文件布局：header | dependency 表 | mesh 表 | primitive 表 | node 表 | skin 表 | joint 表 | animation 表 | animation track 表 | animation key 表 | material 表 | texture 表 | 各 mesh 的顶点、蒙皮、索引与 meshlet 数据（按 16 字节对齐）
+struct MeshCacheHeader {
+    uint32_t magic;
+    uint32_t format_version;
+    uint32_t vertex_layout_version;
+    uint32_t vertex_layout;
+    uint32_t vertex_stride;
+    uint32_t dependency_count;
+    uint32_t mesh_count;
+    uint32_t primitive_count;
+    uint32_t node_count;
+    uint32_t skin_count;
+    uint32_t joint_count;
+    uint32_t animation_count;
+    uint32_t animation_track_count;
+    uint32_t animation_key_count;
+    uint32_t material_count;
+    uint32_t texture_count;
+    uint32_t import_flags;
+    uint64_t source_hash;
+};
+
+struct MeshCacheDependency {
+    char uri[MESH_CACHE_MAX_URI_LENGTH];
+    uint64_t hash;
+};
+
+struct MeshCacheMeshRecord {
+    uint32_t first_primitive;
+    uint32_t primitive_count;
+    uint32_t vertex_count;
+    uint32_t index_data_size; // 字节数，各 primitive 按各自的索引类型存放
+    uint32_t meshlet_count;
+    uint32_t skin_vertex_count; // 0 或 vertex_count
+    uint64_t vertex_data_offset;
+    uint64_t skin_vertex_data_offset;
+    uint64_t index_data_offset;
+    uint64_t meshlet_data_offset;
+    VertexQuantization quantization;
+    Aabb aabb;
+    BoundingSphere bounding_sphere;
+};
+
+// clip 的轨道与关键帧分别为 track 表与 key 表中连续的一段，轨道的 first_key 相对于 clip
+struct MeshCacheAnimationRecord {
+    float duration;
+    uint32_t first_track;
+    uint32_t track_count;
+    uint32_t first_key;
+    uint32_t key_count;
+};
+
+// 贴图的烘焙结果单独缓存（见 texture_cache），这里只记录查找缓存所需的 key
+struct MeshCacheTextureRecord {
+    uint64_t source_hash;
+    uint32_t usage;
+    uint32_t padding;
+};
+
+static_assert(std::is_trivially_copyable<Primitive>::value, "primitive table is stored as raw bytes");
+static_assert(std::is_trivially_copyable<Meshlet>::value, "meshlet data is stored as raw bytes");
+static_assert(std::is_trivially_copyable<ImportedNode>::value, "node table is stored as raw bytes");
+static_assert(std::is_trivially_copyable<ImportedSkin>::value, "skin table is stored as raw bytes");
+static_assert(std::is_trivially_copyable<ImportedJoint>::value, "joint table is stored as raw bytes");
+static_assert(std::is_trivially_copyable<AnimationTrack>::value, "animation track table is stored as raw bytes");
+static_assert(std::is_trivially_copyable<AnimationKey>::value, "animation key table is stored as raw bytes");
+static_assert(std::is_trivially_copyable<SkinVertex>::value, "skin vertex data is stored as raw bytes");
+static_assert(std::is_trivially_copyable<Material>::value, "material table is stored as raw bytes");
+
+static std::string get_cache_filepath(uint64_t source_hash, uint32_t import_flags) {
+    char filename[64];
+    snprintf(filename, sizeof(filename), "%016llx-v%u-%x.mesh", (unsigned long long) source_hash, VERTEX_LAYOUT_VERSION, import_flags);
+    return (std::filesystem::path(MESH_CACHE_DIRECTORY) / filename).string();
+}
+
+static std::string get_dependency_filepath(const char *filepath, const char *uri) {
+    return (std::filesystem::path(filepath).parent_path() / uri).string();
+}
+
+static size_t align_up(size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+bool mesh_cache_hash_file(const char *filepath, uint64_t *out_hash) {
+    MappedFile mapped_file;
+    if (!map_file(filepath, &mapped_file)) { return false; }
+    *out_hash = hash_bytes(mapped_file.data, mapped_file.size);
+    unmap_file(&mapped_file);
+    return true;
+}
+
+// 以 `index_type` 的索引个数计的范围需落在 mesh 的索引数据内
+static bool is_index_range_valid(IndexType index_type, uint32_t index_offset, uint32_t index_count, uint32_t index_data_size) {
+    return ((uint64_t) index_offset + index_count) * get_index_size(index_type) <= index_data_size;
+}
+
+// primitive 与 meshlet 引用的索引与顶点范围需落在所属 mesh 的数据段内，否则加载时会越过 mmap 的范围读取或上传
+static bool validate_mesh_ranges(const MeshCacheMeshRecord *record, const Primitive *primitives, const Meshlet *meshlets) {
+    for (uint32_t i = 0; i < record->primitive_count; ++i) {
+        const Primitive *primitive = &primitives[i];
+        if (primitive->index_type >= INDEX_TYPE_COUNT || (uint64_t) primitive->vertex_offset + primitive->vertex_count > record->vertex_count ||
+            !is_index_range_valid(primitive->index_type, primitive->index_offset, primitive->index_count, record->index_data_size) ||
+            primitive->lod_count == 0 || primitive->lod_count > PRIMITIVE_MAX_LOD_COUNT) {
+            return false;
+        }
+        for (uint32_t lod_index = 0; lod_index < primitive->lod_count; ++lod_index) {
+            const PrimitiveLod *lod = &primitive->lods[lod_index];
+            if (!is_index_range_valid(primitive->index_type, lod->index_offset, lod->index_count, record->index_data_size)) { return false; }
+        }
+    }
+
+    // meshlet 以所属 primitive 的索引类型计，按 vertex_offset 找到所属 primitive
+    for (uint32_t i = 0; i < record->meshlet_count; ++i) {
+        const Meshlet *meshlet = &meshlets[i];
+        const Primitive *owner = nullptr;
+        for (uint32_t j = 0; j < record->primitive_count && !owner; ++j) {
+            if (primitives[j].vertex_offset == meshlet->vertex_offset) { owner = &primitives[j]; }
+        }
+        if (!owner || !is_index_range_valid(owner->index_type, meshlet->index_offset, meshlet->index_count, record->index_data_size)) { return false; }
+    }
+    return true;
+}
+
+static bool validate_cache(const char *filepath, uint64_t source_hash, uint32_t import_flags, VertexLayout vertex_layout, const MappedFile *mapped_file) {
+    if (mapped_file->size < sizeof(MeshCacheHeader)) { return false; }
+
+    const MeshCacheHeader *header = (const MeshCacheHeader *) mapped_file->data;
+    if (header->magic != MESH_CACHE_MAGIC || header->format_version != MESH_CACHE_FORMAT_VERSION ||
+        header->vertex_layout_version != VERTEX_LAYOUT_VERSION || header->vertex_layout != vertex_layout ||
+        header->vertex_stride != get_vertex_stride(vertex_layout) ||
+        header->import_flags != import_flags || header->source_hash != source_hash) {
+        return false;
+    }
+
+    size_t tables_size = sizeof(MeshCacheHeader) + header->dependency_count * sizeof(MeshCacheDependency) +
+                         header->mesh_count * sizeof(MeshCacheMeshRecord) + header->primitive_count * sizeof(Primitive) +
+                         header->node_count * sizeof(ImportedNode) + header->skin_count * sizeof(ImportedSkin) +
+                         header->joint_count * sizeof(ImportedJoint) + header->animation_count * sizeof(MeshCacheAnimationRecord) +
+                         header->animation_track_count * sizeof(AnimationTrack) + header->animation_key_count * sizeof(AnimationKey) +
+                         header->material_count * sizeof(Material) +
+                         header->texture_count * sizeof(MeshCacheTextureRecord);
+    if (mapped_file->size < tables_size) { return false; }
+
+    const MeshCacheDependency *dependencies = (const MeshCacheDependency *) (header + 1);
+    for (uint32_t i = 0; i < header->dependency_count; ++i) {
+        uint64_t dependency_hash;
+        if (!mesh_cache_hash_file(get_dependency_filepath(filepath, dependencies[i].uri).c_str(), &dependency_hash) ||
+            dependency_hash != dependencies[i].hash) {
+            return false;
+        }
+    }
+
+    const MeshCacheMeshRecord *mesh_records = (const MeshCacheMeshRecord *) (dependencies + header->dependency_count);
+    const Primitive *primitives = (const Primitive *) (mesh_records + header->mesh_count);
+    for (uint32_t i = 0; i < header->mesh_count; ++i) {
+        const MeshCacheMeshRecord *record = &mesh_records[i];
+        // 先限制偏移，之后的偏移加长度不会溢出
+        if (record->vertex_data_offset > mapped_file->size || record->skin_vertex_data_offset > mapped_file->size ||
+            record->index_data_offset > mapped_file->size || record->meshlet_data_offset > mapped_file->size) {
+            return false;
+        }
+        if ((uint64_t) record->first_primitive + record->primitive_count > header->primitive_count ||
+            record->vertex_data_offset + (uint64_t) record->vertex_count * header->vertex_stride > mapped_file->size ||
+            (record->skin_vertex_count != 0 && record->skin_vertex_count != record->vertex_count) ||
+            record->skin_vertex_data_offset + (uint64_t) record->skin_vertex_count * sizeof(SkinVertex) > mapped_file->size ||
+            record->index_data_offset + record->index_data_size > mapped_file->size ||
+            record->meshlet_data_offset + (uint64_t) record->meshlet_count * sizeof(Meshlet) > mapped_file->size) {
+            return false;
+        }
+        const Meshlet *meshlets = (const Meshlet *) ((const uint8_t *) mapped_file->data + record->meshlet_data_offset);
+        if (!validate_mesh_ranges(record, primitives + record->first_primitive, meshlets)) { return false; }
+    }
+
+    for (uint32_t i = 0; i < header->primitive_count; ++i) {
+        if (primitives[i].material_index >= (int32_t) header->material_count || primitives[i].index_type >= INDEX_TYPE_COUNT) { return false; }
+    }
+
+    const ImportedNode *nodes = (const ImportedNode *) (primitives + header->primitive_count);
+    for (uint32_t i = 0; i < header->node_count; ++i) {
+        if (nodes[i].parent >= (int32_t) i || nodes[i].mesh_index >= (int32_t) header->mesh_count || nodes[i].skin_index >= (int32_t) header->skin_count) {
+            return false;
+        }
+    }
+
+    const ImportedSkin *skins = (const ImportedSkin *) (nodes + header->node_count);
+    for (uint32_t i = 0; i < header->skin_count; ++i) {
+        if ((uint64_t) skins[i].first_joint + skins[i].joint_count > header->joint_count) { return false; }
+    }
+
+    const ImportedJoint *joints = (const ImportedJoint *) (skins + header->skin_count);
+    for (uint32_t i = 0; i < header->joint_count; ++i) {
+        if (joints[i].node < 0 || joints[i].node >= (int32_t) header->node_count) { return false; }
+    }
+
+    const MeshCacheAnimationRecord *animation_records = (const MeshCacheAnimationRecord *) (joints + header->joint_count);
+    const AnimationTrack *animation_tracks = (const AnimationTrack *) (animation_records + header->animation_count);
+    for (uint32_t i = 0; i < header->animation_count; ++i) {
+        const MeshCacheAnimationRecord *record = &animation_records[i];
+        if ((uint64_t) record->first_track + record->track_count > header->animation_track_count ||
+            (uint64_t) record->first_key + record->key_count > header->animation_key_count) {
+            return false;
+        }
+        for (uint32_t j = record->first_track; j < record->first_track + record->track_count; ++j) {
+            const AnimationTrack *track = &animation_tracks[j];
+            if (track->node >= header->node_count || track->type >= ANIMATION_TRACK_TYPE_COUNT || track->key_count == 0 ||
+                (uint64_t) track->first_key + track->key_count > record->key_count) {
+                return false;
+            }
+        }
+    }
+
+    const AnimationKey *animation_keys = (const AnimationKey *) (animation_tracks + header->animation_track_count);
+    const Material *materials = (const Material *) (animation_keys + header->animation_key_count);
+    for (uint32_t i = 0; i < header->material_count; ++i) {
+        if (materials[i].base_color_texture >= (int32_t) header->texture_count || materials[i].normal_texture >= (int32_t) header->texture_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool mesh_cache_load(const char *filepath, uint64_t source_hash, uint32_t import_flags, VertexLayout vertex_layout, bool position_stream,
+                     GltfImport *gltf_import) {
+    uint64_t start_time = timer_now_ns();
+
+    std::string cache_filepath = get_cache_filepath(source_hash, import_flags);
+    MappedFile mapped_file;
+    if (!map_file(cache_filepath.c_str(), &mapped_file)) { return false; }
+
+    if (!validate_cache(filepath, source_hash, import_flags, vertex_layout, &mapped_file)) {
+        log_warning("mesh cache %s is stale or corrupted, reimporting %s", cache_filepath.c_str(), filepath);
+        unmap_file(&mapped_file);
+        return false;
+    }
+
+    const uint8_t *base = (const uint8_t *) mapped_file.data;
+    const MeshCacheHeader *header = (const MeshCacheHeader *) base;
+    const MeshCacheDependency *dependencies = (const MeshCacheDependency *) (header + 1);
+    const MeshCacheMeshRecord *mesh_records = (const MeshCacheMeshRecord *) (dependencies + header->dependency_count);
+    const Primitive *primitives = (const Primitive *) (mesh_records + header->mesh_count);
+    const ImportedNode *nodes = (const ImportedNode *) (primitives + header->primitive_count);
+    const ImportedSkin *skins = (const ImportedSkin *) (nodes + header->node_count);
+    const ImportedJoint *joints = (const ImportedJoint *) (skins + header->skin_count);
+    const MeshCacheAnimationRecord *animation_records = (const MeshCacheAnimationRecord *) (joints + header->joint_count);
+    const AnimationTrack *animation_tracks = (const AnimationTrack *) (animation_records + header->animation_count);
+    const AnimationKey *animation_keys = (const AnimationKey *) (animation_tracks + header->animation_track_count);
+    const Material *materials = (const Material *) (animation_keys + header->animation_key_count);
+    const MeshCacheTextureRecord *texture_records = (const MeshCacheTextureRecord *) (materials + header->material_count);
+
+    gltf_import->vertex_layout = vertex_layout;
+    gltf_import->nodes.assign(nodes, nodes + header->node_count);
+    gltf_import->skins.assign(skins, skins + header->skin_count);
+    gltf_import->joints.assign(joints, joints + header->joint_count);
+    gltf_import->animations.resize(header->animation_count);
+    for (uint32_t i = 0; i < header->animation_count; ++i) {
+        const MeshCacheAnimationRecord *record = &animation_records[i];
+        AnimationClip *animation = &gltf_import->animations[i];
+        animation->duration = record->duration;
+        animation->tracks.assign(animation_tracks + record->first_track, animation_tracks + record->first_track + record->track_count);
+        animation->keys.assign(animation_keys + record->first_key, animation_keys + record->first_key + record->key_count);
+    }
+    gltf_import->materials.assign(materials, materials + header->material_count);
+    gltf_import->textures.resize(header->texture_count);
+    for (uint32_t i = 0; i < header->texture_count; ++i) {
+        ImportedTexture *imported_texture = &gltf_import->textures[i];
+        imported_texture->source_hash = texture_records[i].source_hash;
+        imported_texture->usage = (TextureUsage) texture_records[i].usage;
+        imported_texture->level_count = 0;
+        imported_texture->data.clear();
+    }
+    gltf_import->meshes.resize(header->mesh_count);
+    for (uint32_t mesh_index = 0; mesh_index < header->mesh_count; ++mesh_index) {
+        const MeshCacheMeshRecord *record = &mesh_records[mesh_index];
+        ImportedMesh *imported_mesh = &gltf_import->meshes[mesh_index];
+        imported_mesh->primitives.assign(primitives + record->first_primitive, primitives + record->first_primitive + record->primitive_count);
+
+        const uint8_t *vertices = base + record->vertex_data_offset;
+        imported_mesh->vertex_count = record->vertex_count;
+        imported_mesh->vertices.assign(vertices, vertices + (size_t) record->vertex_count * header->vertex_stride);
+        if (position_stream) {
+            imported_mesh->positions.resize(record->vertex_count * get_position_stride(vertex_layout));
+            extract_positions(vertices, record->vertex_count, vertex_layout, imported_mesh->positions.data());
+        }
+        const SkinVertex *skin_vertices = (const SkinVertex *) (base + record->skin_vertex_data_offset);
+        imported_mesh->skin_vertices.assign(skin_vertices, skin_vertices + record->skin_vertex_count);
+
+        const uint8_t *indices = base + record->index_data_offset;
+        imported_mesh->indices.assign(indices, indices + record->index_data_size);
+        const Meshlet *meshlets = (const Meshlet *) (base + record->meshlet_data_offset);
+        imported_mesh->meshlets.assign(meshlets, meshlets + record->meshlet_count);
+        imported_mesh->quantization = record->quantization;
+        imported_mesh->aabb = record->aabb;
+        imported_mesh->bounding_sphere = record->bounding_sphere;
+    }
+
+    log_info("load mesh cache %s for %s: %u meshes, %u primitives, %u nodes, %u skins, %u animations, %u textures, %zu bytes, %.2f ms", cache_filepath.c_str(),
+             filepath, header->mesh_count, header->primitive_count, header->node_count, header->skin_count, header->animation_count, header->texture_count,
+             mapped_file.size, timer_elapsed_ms(start_time));
+
+    unmap_file(&mapped_file);
+    return true;
+}
+
+void mesh_cache_write(const char *filepath, uint64_t source_hash, uint32_t import_flags, const std::vector<std::string> &dependency_uris,
+                      const GltfImport *gltf_import) {
+    const VertexLayout vertex_layout = gltf_import->vertex_layout;
+    const std::vector<ImportedMesh> &meshes = gltf_import->meshes;
+
+    MeshCacheHeader header{};
+    header.magic = MESH_CACHE_MAGIC;
+    header.format_version = MESH_CACHE_FORMAT_VERSION;
+    header.vertex_layout_version = VERTEX_LAYOUT_VERSION;
+    header.vertex_layout = vertex_layout;
+    header.vertex_stride = get_vertex_stride(vertex_layout);
+    header.dependency_count = dependency_uris.size();
+    header.mesh_count = meshes.size();
+    header.import_flags = import_flags;
+    header.source_hash = source_hash;
+
+    std::vector<MeshCacheDependency> dependencies(dependency_uris.size());
+    for (size_t i = 0; i < dependency_uris.size(); ++i) {
+        if (dependency_uris[i].size() >= MESH_CACHE_MAX_URI_LENGTH ||
+            !mesh_cache_hash_file(get_dependency_filepath(filepath, dependency_uris[i].c_str()).c_str(), &dependencies[i].hash)) {
+            log_warning("skip writing mesh cache for %s, unsupported dependency %s", filepath, dependency_uris[i].c_str());
+            return;
+        }
+        strncpy(dependencies[i].uri, dependency_uris[i].c_str(), MESH_CACHE_MAX_URI_LENGTH);
+    }
+
+    std::vector<MeshCacheMeshRecord> mesh_records(meshes.size());
+    std::vector<Primitive> primitives;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        mesh_records[i].first_primitive = primitives.size();
+        mesh_records[i].primitive_count = meshes[i].primitives.size();
+        mesh_records[i].vertex_count = meshes[i].vertex_count;
+        mesh_records[i].index_data_size = meshes[i].indices.size();
+        mesh_records[i].meshlet_count = meshes[i].meshlets.size();
+        mesh_records[i].skin_vertex_count = meshes[i].skin_vertices.size();
+        mesh_records[i].quantization = meshes[i].quantization;
+        mesh_records[i].aabb = meshes[i].aabb;
+        mesh_records[i].bounding_sphere = meshes[i].bounding_sphere;
+        primitives.insert(primitives.end(), meshes[i].primitives.begin(), meshes[i].primitives.end());
+    }
+    header.primitive_count = primitives.size();
+    header.node_count = gltf_import->nodes.size();
+    header.skin_count = gltf_import->skins.size();
+    header.joint_count = gltf_import->joints.size();
+    header.animation_count = gltf_import->animations.size();
+    header.material_count = gltf_import->materials.size();
+    header.texture_count = gltf_import->textures.size();
+
+    std::vector<MeshCacheAnimationRecord> animation_records(gltf_import->animations.size());
+    std::vector<AnimationTrack> animation_tracks;
+    std::vector<AnimationKey> animation_keys;
+    for (size_t i = 0; i < animation_records.size(); ++i) {
+        const AnimationClip *animation = &gltf_import->animations[i];
+        animation_records[i].duration = animation->duration;
+        animation_records[i].first_track = animation_tracks.size();
+        animation_records[i].track_count = animation->tracks.size();
+        animation_records[i].first_key = animation_keys.size();
+        animation_records[i].key_count = animation->keys.size();
+        animation_tracks.insert(animation_tracks.end(), animation->tracks.begin(), animation->tracks.end());
+        animation_keys.insert(animation_keys.end(), animation->keys.begin(), animation->keys.end());
+    }
+    header.animation_track_count = animation_tracks.size();
+    header.animation_key_count = animation_keys.size();
+
+    std::vector<MeshCacheTextureRecord> texture_records(gltf_import->textures.size());
+    for (size_t i = 0; i < texture_records.size(); ++i) {
+        texture_records[i].source_hash = gltf_import->textures[i].source_hash;
+        texture_records[i].usage = gltf_import->textures[i].usage;
+    }
+
+    size_t offset = sizeof(MeshCacheHeader) + dependencies.size() * sizeof(MeshCacheDependency) +
+                    mesh_records.size() * sizeof(MeshCacheMeshRecord) + primitives.size() * sizeof(Primitive) +
+                    gltf_import->nodes.size() * sizeof(ImportedNode) + gltf_import->skins.size() * sizeof(ImportedSkin) +
+                    gltf_import->joints.size() * sizeof(ImportedJoint) + animation_records.size() * sizeof(MeshCacheAnimationRecord) +
+                    animation_tracks.size() * sizeof(AnimationTrack) + animation_keys.size() * sizeof(AnimationKey) +
+                    gltf_import->materials.size() * sizeof(Material) +
+                    texture_records.size() * sizeof(MeshCacheTextureRecord);
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        offset = align_up(offset, MESH_CACHE_DATA_ALIGNMENT);
+        mesh_records[i].vertex_data_offset = offset;
+        offset += meshes[i].vertices.size();
+        offset = align_up(offset, MESH_CACHE_DATA_ALIGNMENT);
+        mesh_records[i].skin_vertex_data_offset = offset;
+        offset += meshes[i].skin_vertices.size() * sizeof(SkinVertex);
+        offset = align_up(offset, MESH_CACHE_DATA_ALIGNMENT);
+        mesh_records[i].index_data_offset = offset;
+        offset += meshes[i].indices.size();
+        offset = align_up(offset, MESH_CACHE_DATA_ALIGNMENT);
+        mesh_records[i].meshlet_data_offset = offset;
+        offset += meshes[i].meshlets.size() * sizeof(Meshlet);
+    }
+
+    std::error_code error_code;
+    std::filesystem::create_directories(MESH_CACHE_DIRECTORY, error_code);
+
+    // 先写临时文件再重命名，避免进程中断留下不完整的缓存
+    std::string cache_filepath = get_cache_filepath(source_hash, import_flags);
+    std::string temp_filepath = cache_filepath + ".tmp";
+    FILE *file = fopen(temp_filepath.c_str(), "wb");
+    if (!file) {
+        log_warning("failed to create mesh cache %s", temp_filepath.c_str());
+        return;
+    }
+
+    static const uint8_t padding[MESH_CACHE_DATA_ALIGNMENT] = {};
+    size_t written = 0;
+    auto write = [&](const void *data, size_t size) {
+        fwrite(data, 1, size, file);
+        written += size;
+    };
+    auto pad_to = [&](size_t target) { write(padding, target - written); };
+
+    write(&header, sizeof(header));
+    write(dependencies.data(), dependencies.size() * sizeof(MeshCacheDependency));
+    write(mesh_records.data(), mesh_records.size() * sizeof(MeshCacheMeshRecord));
+    write(primitives.data(), primitives.size() * sizeof(Primitive));
+    write(gltf_import->nodes.data(), gltf_import->nodes.size() * sizeof(ImportedNode));
+    write(gltf_import->skins.data(), gltf_import->skins.size() * sizeof(ImportedSkin));
+    write(gltf_import->joints.data(), gltf_import->joints.size() * sizeof(ImportedJoint));
+    write(animation_records.data(), animation_records.size() * sizeof(MeshCacheAnimationRecord));
+    write(animation_tracks.data(), animation_tracks.size() * sizeof(AnimationTrack));
+    write(animation_keys.data(), animation_keys.size() * sizeof(AnimationKey));
+    write(gltf_import->materials.data(), gltf_import->materials.size() * sizeof(Material));
+    write(texture_records.data(), texture_records.size() * sizeof(MeshCacheTextureRecord));
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        pad_to(mesh_records[i].vertex_data_offset);
+        write(meshes[i].vertices.data(), meshes[i].vertices.size());
+        pad_to(mesh_records[i].skin_vertex_data_offset);
+        write(meshes[i].skin_vertices.data(), meshes[i].skin_vertices.size() * sizeof(SkinVertex));
+        pad_to(mesh_records[i].index_data_offset);
+        write(meshes[i].indices.data(), meshes[i].indices.size());
+        pad_to(mesh_records[i].meshlet_data_offset);
+        write(meshes[i].meshlets.data(), meshes[i].meshlets.size() * sizeof(Meshlet));
+    }
+
+    bool is_ok = ferror(file) == 0;
+    is_ok = fclose(file) == 0 && is_ok;
+    if (!is_ok) {
+        log_warning("failed to write mesh cache %s", temp_filepath.c_str());
+        std::filesystem::remove(temp_filepath, error_code);
+        return;
+    }
+
+    std::filesystem::rename(temp_filepath, cache_filepath, error_code);
+    if (error_code) {
+        log_warning("failed to rename mesh cache %s: %s", temp_filepath.c_str(), error_code.message().c_str());
+        return;
+    }
+    log_info("write mesh cache %s for %s, %zu bytes", cache_filepath.c_str(), filepath, written);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "mesh_loader.h"
+#include <string>
+
+// 烘焙后的 mesh 缓存目录，相对于工作目录
+#define MESH_CACHE_DIRECTORY "cache/meshes"
+
+// 计算源文件内容的哈希，文件无法读取时返回 false
+bool mesh_cache_hash_file(const char *filepath, uint64_t *out_hash);
+
+// 命中缓存时从映射的烘焙文件读出导入结果并返回 true；未命中或缓存失效时返回 false，不访问 gpu，可在工作线程上执行
+// `import_flags` 为影响导入结果的选项，不同选项的烘焙结果分别缓存
+// 位置流不写入缓存，`position_stream` 为 true 时加载时从顶点中提取
+// 贴图只恢复 source_hash 与 usage，烘焙数据需另行从贴图缓存读取
+bool mesh_cache_load(const char *filepath, uint64_t source_hash, uint32_t import_flags, VertexLayout vertex_layout, bool position_stream,
+                     GltfImport *gltf_import);
+
+// `dependency_uris` 为 gltf 引用的外部文件（相对于源文件目录），其内容哈希一并写入，加载时校验
+void mesh_cache_write(const char *filepath, uint64_t source_hash, uint32_t import_flags, const std::vector<std::string> &dependency_uris,
+                      const GltfImport *gltf_import);
@@ -1,96 +1,823 @@
 #include "mesh_loader.h"
+#include "accessor_decode.h"
+#include "mesh_cache.h"
+#include "mesh_optimize.h"
 #include "core/logging.h"
+#include "core/mapped_file.h"
+#include "core/thread_pool.h"
+#include "core/timer.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <glm/gtc/type_ptr.hpp>
 
-void load_gltf(VkContext *vk_context, const char *filepath, Geometry *geometry) {
-    cgltf_options options = {};
+// 单个 primitive 解码后的 cpu 端数据，索引相对于该 primitive 自身的顶点
+struct PrimitiveData {
+    std::vector<Vertex> vertices;
+    std::vector<SkinVertex> skin_vertices; // 没有 JOINTS_0/WEIGHTS_0 时为空
+    std::vector<uint32_t> indices;
+    MeshOptimizeStats optimize_stats;
+    std::vector<MeshLodLevel> lods;
+    std::vector<Meshlet> meshlets;
+};
+
+// cgltf 通过 file 回调映射的文件，cgltf_free 时逐个释放
+struct GltfMappedFiles {
+    std::vector<MappedFile> mapped_files;
+};
+
+static cgltf_result read_mapped_file(const cgltf_memory_options *memory_options, const cgltf_file_options *file_options, const char *path,
+                                     cgltf_size *size, void **data) {
+    GltfMappedFiles *gltf_mapped_files = (GltfMappedFiles *) file_options->user_data;
+    MappedFile mapped_file;
+    if (!map_file(path, &mapped_file)) { return cgltf_result_file_not_found; }
+    gltf_mapped_files->mapped_files.push_back(mapped_file);
+    if (size) { *size = mapped_file.size; }
+    *data = (void *) mapped_file.data; // 只读映射，cgltf 不会写入文件或 buffer 的内容
+    return cgltf_result_success;
+}
+
+static void release_mapped_file(const cgltf_memory_options *memory_options, const cgltf_file_options *file_options, void *data) {
+    GltfMappedFiles *gltf_mapped_files = (GltfMappedFiles *) file_options->user_data;
+    std::vector<MappedFile> &mapped_files = gltf_mapped_files->mapped_files;
+    for (size_t i = 0; i < mapped_files.size(); ++i) {
+        if (mapped_files[i].data != data) { continue; }
+        unmap_file(&mapped_files[i]);
+        mapped_files.erase(mapped_files.begin() + i);
+        return;
+    }
+}
+
+// 关节下标与权重解码为 SkinVertex，权重归一化后量化为 unorm16，舍入误差补到最大的权重上，保证之和为 1
+static void decode_skin_vertices(const cgltf_accessor *joints, const cgltf_accessor *weights, SkinVertex *skin_vertices) {
+    std::vector<glm::vec4> joint_values(joints->count, glm::vec4(0.0f)), weight_values(joints->count, glm::vec4(0.0f));
+    decode_accessor_floats(joints, &joint_values[0].x, 4, sizeof(glm::vec4));
+    decode_accessor_floats(weights, &weight_values[0].x, 4, sizeof(glm::vec4));
+
+    for (size_t i = 0; i < joint_values.size(); ++i) {
+        float weight_sum = weight_values[i].x + weight_values[i].y + weight_values[i].z + weight_values[i].w;
+        SkinVertex *skin_vertex = &skin_vertices[i];
+        int32_t quantized_sum = 0;
+        uint32_t max_component = 0;
+        for (uint32_t c = 0; c < 4; ++c) {
+            skin_vertex->joints[c] = (uint16_t) joint_values[i][c];
+            float weight = weight_sum > 0.0f ? weight_values[i][c] / weight_sum : (c == 0 ? 1.0f : 0.0f);
+            skin_vertex->weights[c] = (uint16_t) std::lround(weight * 65535.0f);
+            quantized_sum += skin_vertex->weights[c];
+            if (skin_vertex->weights[c] > skin_vertex->weights[max_component]) { max_component = c; }
+        }
+        skin_vertex->weights[max_component] = (uint16_t) (skin_vertex->weights[max_component] + 65535 - quantized_sum);
+    }
+}
+
+// 解码 primitive 的顶点属性并将索引统一扩展为 u32 供优化与简化使用，合并时再按顶点数收窄，可在工作线程上执行
+static void decode_primitive(const cgltf_primitive *primitive, PrimitiveData *primitive_data) {
+    ASSERT(primitive->indices);
+
+    uint32_t vertex_count = primitive->attributes[0].data->count; // 假设同一 primitive 的所有 attribute 的 count 相同
+    primitive_data->vertices.resize(vertex_count);
+    primitive_data->indices.resize(primitive->indices->count);
+
+    Vertex *vertices = primitive_data->vertices.data();
+    const cgltf_accessor *joints = nullptr, *weights = nullptr;
+
+    for (size_t attribute_index = 0; attribute_index < primitive->attributes_count; ++attribute_index) {
+        const cgltf_attribute *attribute = &primitive->attributes[attribute_index];
+        ASSERT(attribute->data->count == vertex_count);
+
+        if (attribute->type == cgltf_attribute_type_position) {
+            decode_accessor_floats(attribute->data, vertices[0].pos, 3, sizeof(Vertex));
+        } else if (attribute->type == cgltf_attribute_type_texcoord && attribute->index == 0) {
+            decode_accessor_floats(attribute->data, vertices[0].tex_coord, 2, sizeof(Vertex));
+        } else if (attribute->type == cgltf_attribute_type_normal) {
+            decode_accessor_floats(attribute->data, vertices[0].normal, 3, sizeof(Vertex));
+        } else if (attribute->type == cgltf_attribute_type_color && attribute->index == 0) {
+            decode_accessor_floats(attribute->data, vertices[0].color, 4, sizeof(Vertex)); // vec3 颜色保留默认的 alpha
+        } else if (attribute->type == cgltf_attribute_type_joints && attribute->index == 0) {
+            joints = attribute->data;
+        } else if (attribute->type == cgltf_attribute_type_weights && attribute->index == 0) {
+            weights = attribute->data;
+        }
+    }
+
+    // 只支持一组关节，JOINTS_1/WEIGHTS_1 中的影响被忽略
+    if (joints && weights) {
+        primitive_data->skin_vertices.resize(vertex_count);
+        decode_skin_vertices(joints, weights, primitive_data->skin_vertices.data());
+    }
+
+    decode_accessor_indices(primitive->indices, primitive_data->indices.data());
+}
+
+// 节点的局部变换拆分为 TRS，矩阵形式的变换按列长度提取缩放，不支持切变
+static void get_node_transform(const cgltf_node *gltf_node, ImportedNode *node) {
+    if (!gltf_node->has_matrix) {
+        const float *translation = gltf_node->has_translation ? gltf_node->translation : nullptr;
+        const float *rotation = gltf_node->has_rotation ? gltf_node->rotation : nullptr;
+        const float *scale = gltf_node->has_scale ? gltf_node->scale : nullptr;
+        for (uint32_t i = 0; i < 3; ++i) { node->translation[i] = translation ? translation[i] : 0.0f; }
+        for (uint32_t i = 0; i < 4; ++i) { node->rotation[i] = rotation ? rotation[i] : (i == 3 ? 1.0f : 0.0f); }
+        for (uint32_t i = 0; i < 3; ++i) { node->scale[i] = scale ? scale[i] : 1.0f; }
+        return;
+    }
+
+    const float *matrix = gltf_node->matrix; // 列主序
+    glm::vec3 columns[3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        columns[i] = glm::vec3(matrix[i * 4 + 0], matrix[i * 4 + 1], matrix[i * 4 + 2]);
+        node->scale[i] = glm::length(columns[i]);
+        node->translation[i] = matrix[12 + i];
+    }
+    if (glm::dot(glm::cross(columns[0], columns[1]), columns[2]) < 0.0f) { node->scale[0] = -node->scale[0]; } // 镜像变换
+
+    glm::mat4 rotation_matrix(1.0f);
+    for (uint32_t i = 0; i < 3; ++i) {
+        if (node->scale[i] != 0.0f) { rotation_matrix[i] = glm::vec4(columns[i] / node->scale[i], 0.0f); }
+    }
+    glm::quat rotation = glm::quat_cast(rotation_matrix);
+    node->rotation[0] = rotation.x;
+    node->rotation[1] = rotation.y;
+    node->rotation[2] = rotation.z;
+    node->rotation[3] = rotation.w;
+}
+
+// 将 `source` 收窄为 `index_type` 后追加到 `indices` 末尾，`indices` 的长度需已按索引大小对齐，返回以该类型索引个数计的起始位置
+static uint32_t append_indices(const std::vector<uint32_t> &source, IndexType index_type, std::vector<uint8_t> *indices) {
+    uint32_t index_size = get_index_size(index_type);
+    ASSERT(indices->size() % index_size == 0);
+    uint32_t index_offset = indices->size() / index_size;
+    indices->resize(indices->size() + source.size() * index_size);
+    uint8_t *destination = indices->data() + (size_t) index_offset * index_size;
+    switch (index_type) {
+        case INDEX_TYPE_UINT32: memcpy(destination, source.data(), source.size() * sizeof(uint32_t)); break;
+        case INDEX_TYPE_UINT16: std::copy(source.begin(), source.end(), (uint16_t *) destination); break;
+        case INDEX_TYPE_UINT8: std::copy(source.begin(), source.end(), destination); break;
+        default: ASSERT_MESSAGE(false, "unsupported index type - %d", index_type);
+    }
+    return index_offset;
+}
+
+// 按先序展开默认场景（没有场景时为所有根节点）的节点层级，不含节点的文件为每个 mesh 生成一个单位变换的根节点
+static void import_nodes(const cgltf_data *data, std::vector<ImportedNode> *nodes, std::vector<int32_t> *node_indices) {
+    nodes->clear();
+    node_indices->assign(data->nodes_count, -1); // glTF 节点在 `nodes` 中的下标，不在场景中的为 -1
+
+    std::vector<std::pair<const cgltf_node *, int32_t>> stack; // 节点与其父节点在 `nodes` 中的下标
+    const cgltf_scene *scene = data->scene ? data->scene : (data->scenes_count > 0 ? &data->scenes[0] : nullptr);
+    if (scene) {
+        for (size_t i = scene->nodes_count; i-- > 0;) { stack.emplace_back(scene->nodes[i], -1); }
+    } else {
+        for (size_t i = data->nodes_count; i-- > 0;) {
+            if (!data->nodes[i].parent) { stack.emplace_back(&data->nodes[i], -1); }
+        }
+    }
+
+    while (!stack.empty()) {
+        auto [gltf_node, parent] = stack.back();
+        stack.pop_back();
+
+        ImportedNode node{};
+        node.parent = parent;
+        node.mesh_index = gltf_node->mesh ? (int32_t) (gltf_node->mesh - data->meshes) : -1;
+        node.skin_index = gltf_node->skin ? (int32_t) cgltf_skin_index(data, gltf_node->skin) : -1;
+        get_node_transform(gltf_node, &node);
+
+        int32_t node_index = nodes->size();
+        (*node_indices)[cgltf_node_index(data, gltf_node)] = node_index;
+        nodes->push_back(node);
+        for (size_t i = gltf_node->children_count; i-- > 0;) { stack.emplace_back(gltf_node->children[i], node_index); } // 逆序压栈，保持子节点顺序
+    }
+
+    if (data->nodes_count == 0) {
+        for (size_t mesh_index = 0; mesh_index < data->meshes_count; ++mesh_index) {
+            nodes->push_back({-1, (int32_t) mesh_index, -1, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 1.0f, 1.0f}});
+        }
+    }
+}
+
+// 关节需在导入的节点层级中，否则该 skin 没有关节，引用它的节点不蒙皮；没有 inverse bind matrix 时为单位矩阵
+static void import_skins(const cgltf_data *data, const std::vector<int32_t> &node_indices, std::vector<ImportedNode> *nodes,
+                         std::vector<ImportedSkin> *skins, std::vector<ImportedJoint> *joints) {
+    skins->assign(data->skins_count, ImportedSkin{});
+    joints->clear();
+    for (size_t skin_index = 0; skin_index < data->skins_count; ++skin_index) {
+        const cgltf_skin *gltf_skin = &data->skins[skin_index];
+        bool is_valid = true;
+        for (size_t i = 0; i < gltf_skin->joints_count && is_valid; ++i) { is_valid = node_indices[cgltf_node_index(data, gltf_skin->joints[i])] >= 0; }
+        if (!is_valid) {
+            log_warning("skin %zu has joints outside the imported scene, ignored", skin_index);
+            continue;
+        }
+
+        ImportedSkin *skin = &(*skins)[skin_index];
+        skin->first_joint = joints->size();
+        skin->joint_count = gltf_skin->joints_count;
+        for (size_t i = 0; i < gltf_skin->joints_count; ++i) {
+            ImportedJoint joint{};
+            joint.node = node_indices[cgltf_node_index(data, gltf_skin->joints[i])];
+            const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+            if (!gltf_skin->inverse_bind_matrices || !cgltf_accessor_read_float(gltf_skin->inverse_bind_matrices, i, joint.inverse_bind_matrix, 16)) {
+                memcpy(joint.inverse_bind_matrix, identity, sizeof(identity));
+            }
+            joints->push_back(joint);
+        }
+    }
+
+    for (ImportedNode &node: *nodes) {
+        if (node.skin_index >= 0 && (*skins)[node.skin_index].joint_count == 0) { node.skin_index = -1; }
+    }
+}
+
+// 材质引用的一张图片及其用途，同一图片以不同用途引用时分别烘焙
+struct TextureSource {
+    const cgltf_image *image;
+    TextureUsage usage;
+};
+
+static int32_t add_texture_source(const cgltf_data *data, const cgltf_texture_view *texture_view, TextureUsage usage, std::vector<int32_t> *texture_indices,
+                                  std::vector<TextureSource> *texture_sources) {
+    if (!texture_view->texture || !texture_view->texture->image) { return -1; }
+    size_t key = cgltf_image_index(data, texture_view->texture->image) * 2 + usage;
+    if ((*texture_indices)[key] < 0) {
+        (*texture_indices)[key] = texture_sources->size();
+        texture_sources->push_back({texture_view->texture->image, usage});
+    }
+    return (*texture_indices)[key];
+}
+
+// 按 glTF 中的顺序导入材质，`import_textures` 为 false 时所有材质都使用默认贴图
+static void import_materials(const cgltf_data *data, bool import_textures, std::vector<Material> *materials, std::vector<TextureSource> *texture_sources) {
+    std::vector<int32_t> texture_indices(data->images_count * 2, -1);
+    materials->resize(data->materials_count);
+    for (size_t material_index = 0; material_index < data->materials_count; ++material_index) {
+        const cgltf_material *gltf_material = &data->materials[material_index];
+        Material *material = &(*materials)[material_index];
+        material->base_color_texture = -1;
+        material->normal_texture = -1;
+        if (!import_textures) { continue; }
+        if (gltf_material->has_pbr_metallic_roughness) {
+            material->base_color_texture = add_texture_source(data, &gltf_material->pbr_metallic_roughness.base_color_texture, TEXTURE_USAGE_COLOR,
+                                                              &texture_indices, texture_sources);
+        }
+        material->normal_texture = add_texture_source(data, &gltf_material->normal_texture, TEXTURE_USAGE_NORMAL, &texture_indices, texture_sources);
+    }
+}
+
+// 每个 channel 转为一条轨道，目标不在导入场景中的 channel 与 morph target 权重被忽略，各 clip 并行压缩
+static void import_animations(ThreadPool *thread_pool, const cgltf_data *data, const std::vector<int32_t> &node_indices,
+                              std::vector<AnimationClip> *animations) {
+    std::vector<std::vector<RawAnimationTrack>> raw_clips;
+    for (size_t animation_index = 0; animation_index < data->animations_count; ++animation_index) {
+        const cgltf_animation *gltf_animation = &data->animations[animation_index];
+        std::vector<RawAnimationTrack> raw_tracks;
+        for (size_t channel_index = 0; channel_index < gltf_animation->channels_count; ++channel_index) {
+            const cgltf_animation_channel *channel = &gltf_animation->channels[channel_index];
+            if (!channel->target_node || node_indices[cgltf_node_index(data, channel->target_node)] < 0) { continue; }
+
+            RawAnimationTrack track;
+            track.node = node_indices[cgltf_node_index(data, channel->target_node)];
+            if (channel->target_path == cgltf_animation_path_type_translation) {
+                track.type = ANIMATION_TRACK_TRANSLATION;
+            } else if (channel->target_path == cgltf_animation_path_type_rotation) {
+                track.type = ANIMATION_TRACK_ROTATION;
+            } else if (channel->target_path == cgltf_animation_path_type_scale) {
+                track.type = ANIMATION_TRACK_SCALE;
+            } else {
+                continue;
+            }
+
+            const cgltf_animation_sampler *sampler = channel->sampler;
+            track.interpolation = sampler->interpolation == cgltf_interpolation_type_step          ? ANIMATION_INTERPOLATION_STEP
+                                  : sampler->interpolation == cgltf_interpolation_type_cubic_spline ? ANIMATION_INTERPOLATION_CUBIC_SPLINE
+                                                                                                    : ANIMATION_INTERPOLATION_LINEAR;
+            size_t value_count = sampler->input->count * (track.interpolation == ANIMATION_INTERPOLATION_CUBIC_SPLINE ? 3 : 1);
+            if (sampler->input->count == 0 || sampler->output->count != value_count) {
+                log_warning("animation %zu channel %zu has mismatched sampler accessors, ignored", animation_index, channel_index);
+                continue;
+            }
+
+            track.times.resize(sampler->input->count);
+            for (size_t i = 0; i < track.times.size(); ++i) { cgltf_accessor_read_float(sampler->input, i, &track.times[i], 1); }
+            track.values.resize(value_count, glm::vec4(0.0f));
+            for (size_t i = 0; i < value_count; ++i) {
+                cgltf_accessor_read_float(sampler->output, i, &track.values[i][0], track.type == ANIMATION_TRACK_ROTATION ? 4 : 3);
+            }
+            raw_tracks.push_back(std::move(track));
+        }
+        if (!raw_tracks.empty()) { raw_clips.push_back(std::move(raw_tracks)); }
+    }
+
+    animations->resize(raw_clips.size());
+    std::vector<AnimationCompressStats> stats(raw_clips.size());
+    thread_pool_parallel_for(thread_pool, raw_clips.size(), [&](uint32_t index) { compress_animation_clip(raw_clips[index], &(*animations)[index], &stats[index]); });
+
+    if (raw_clips.empty()) { return; }
+    AnimationCompressStats total_stats{};
+    for (const AnimationCompressStats &clip_stats: stats) { accumulate_animation_compress_stats(&total_stats, &clip_stats); }
+    log_info("animations: %zu clips, keys %llu -> %llu, %.1f -> %.1f KB", raw_clips.size(), (unsigned long long) total_stats.raw_key_count,
+             (unsigned long long) total_stats.key_count, total_stats.raw_bytes / 1024.0, total_stats.compressed_bytes / 1024.0);
+}
+
+// 编码的图片数据，位于 glb 的 buffer、外部文件或 data uri 中
+struct EncodedImage {
+    const uint8_t *data;
+    size_t size;
+    MappedFile mapped_file; // 外部文件的映射，data 为空时表示未映射
+    void *decoded_data;     // data uri 的解码结果
+};
+
+static bool read_encoded_image(const char *filepath, const cgltf_image *image, EncodedImage *encoded_image) {
+    *encoded_image = {};
+    if (image->buffer_view) {
+        const cgltf_buffer_view *buffer_view = image->buffer_view;
+        if (!buffer_view->buffer->data) { return false; }
+        encoded_image->data = (const uint8_t *) buffer_view->buffer->data + buffer_view->offset;
+        encoded_image->size = buffer_view->size;
+        return true;
+    }
+    if (!image->uri) { return false; }
+
+    if (strncmp(image->uri, "data:", 5) == 0) {
+        const char *base64 = strstr(image->uri, ";base64,");
+        if (!base64) { return false; }
+        base64 += 8;
+        size_t base64_length = strlen(base64);
+        size_t size = base64_length / 4 * 3;
+        for (size_t i = base64_length; i > 0 && base64[i - 1] == '='; --i) { --size; }
+        cgltf_options gltf_options = {};
+        if (cgltf_load_buffer_base64(&gltf_options, size, base64, &encoded_image->decoded_data) != cgltf_result_success) { return false; }
+        encoded_image->data = (const uint8_t *) encoded_image->decoded_data;
+        encoded_image->size = size;
+        return true;
+    }
+
+    std::string uri = image->uri;
+    uri.resize(cgltf_decode_uri(uri.data()));
+    std::string image_filepath = (std::filesystem::path(filepath).parent_path() / uri).string();
+    if (!map_file(image_filepath.c_str(), &encoded_image->mapped_file)) { return false; }
+    encoded_image->data = (const uint8_t *) encoded_image->mapped_file.data;
+    encoded_image->size = encoded_image->mapped_file.size;
+    return true;
+}
+
+static void release_encoded_image(EncodedImage *encoded_image) {
+    if (encoded_image->mapped_file.data) { unmap_file(&encoded_image->mapped_file); }
+    free(encoded_image->decoded_data);
+    *encoded_image = {};
+}
+
+// 从贴图缓存读取 mesh 缓存中记录的所有贴图，导入失败的贴图（source_hash 为 0）保持为空，有贴图未命中时返回 false
+static bool load_cached_textures(ThreadPool *thread_pool, bool compress, std::vector<ImportedTexture> *textures) {
+    std::atomic<uint32_t> miss_count{0};
+    thread_pool_parallel_for(thread_pool, textures->size(), [&](uint32_t index) {
+        ImportedTexture *imported_texture = &(*textures)[index];
+        if (imported_texture->source_hash != 0 && !load_cached_texture(compress, imported_texture)) { ++miss_count; }
+    });
+    return miss_count == 0;
+}
+
+// 影响导入结果的选项，参与缓存 key；贴图压缩只影响贴图缓存，不参与
+static uint32_t get_import_flags(const GltfLoadOptions *options) {
+    uint32_t import_flags = 0;
+    if (options->optimize) { import_flags |= 1u << 0; }
+    import_flags |= options->vertex_layout << 1; // bit 1..3
+    if (options->generate_lods) { import_flags |= 1u << 4; }
+    if (options->build_meshlets) { import_flags |= 1u << 5; }
+    if (options->import_textures) { import_flags |= 1u << 6; }
+    if (options->uint8_indices) { import_flags |= 1u << 7; }
+    return import_flags;
+}
+
+bool import_gltf(ThreadPool *thread_pool, const char *filepath, const GltfLoadOptions *options, GltfImport *gltf_import) {
+    uint64_t start_time = timer_now_ns();
+
+    gltf_import->vertex_layout = options->vertex_layout;
+    gltf_import->meshes.clear();
+    gltf_import->nodes.clear();
+    gltf_import->skins.clear();
+    gltf_import->joints.clear();
+    gltf_import->animations.clear();
+    gltf_import->materials.clear();
+    gltf_import->textures.clear();
+
+    uint32_t import_flags = get_import_flags(options);
+    uint64_t source_hash = 0;
+    bool is_source_hashed = mesh_cache_hash_file(filepath, &source_hash);
+    if (is_source_hashed && mesh_cache_load(filepath, source_hash, import_flags, options->vertex_layout, options->position_stream, gltf_import)) {
+        if (load_cached_textures(thread_pool, options->compress_textures, &gltf_import->textures)) { return true; }
+
+        log_warning("texture cache of %s is incomplete, reimporting", filepath);
+        gltf_import->meshes.clear();
+        gltf_import->nodes.clear();
+        gltf_import->skins.clear();
+        gltf_import->joints.clear();
+        gltf_import->animations.clear();
+        gltf_import->materials.clear();
+        gltf_import->textures.clear();
+    }
+
+    // glb 的二进制块在 cgltf_load_buffers 中直接引用文件数据，映射后 accessor 解码直接读取映射的内存
+    GltfMappedFiles gltf_mapped_files;
+    cgltf_options gltf_options = {};
+    if (options->map_files) {
+        gltf_options.file.read = read_mapped_file;
+        gltf_options.file.release = release_mapped_file;
+        gltf_options.file.user_data = &gltf_mapped_files;
+    }
     cgltf_data *data = nullptr;
-    cgltf_result result = cgltf_parse_file(&options, filepath, &data);
-    ASSERT(result == cgltf_result_success);
+    cgltf_result result = cgltf_parse_file(&gltf_options, filepath, &data);
+    if (result != cgltf_result_success) {
+        log_error("failed to parse gltf %s: %d", filepath, result);
+        return false;
+    }
+
+    double parse_ms = timer_elapsed_ms(start_time);
+    uint64_t stage_start_time = timer_now_ns();
+
+    result = cgltf_load_buffers(&gltf_options, data, filepath);
+    if (result != cgltf_result_success) {
+        log_error("failed to load buffers of gltf %s: %d", filepath, result);
+        cgltf_free(data);
+        return false;
+    }
+
+    double load_buffers_ms = timer_elapsed_ms(stage_start_time);
+    stage_start_time = timer_now_ns();
+
+    // 将所有 primitive 展平，按 glTF 中的顺序编号，作为并行解码的任务单元
+    std::vector<const cgltf_primitive *> primitives;
+    std::vector<uint32_t> first_primitive_indices(data->meshes_count);
+    for (size_t mesh_index = 0; mesh_index < data->meshes_count; ++mesh_index) {
+        first_primitive_indices[mesh_index] = primitives.size();
+        const cgltf_mesh *gltf_mesh = &data->meshes[mesh_index];
+        for (size_t primitive_index = 0; primitive_index < gltf_mesh->primitives_count; ++primitive_index) {
+            primitives.push_back(&gltf_mesh->primitives[primitive_index]);
+        }
+    }
+
+    std::vector<PrimitiveData> primitive_datas(primitives.size());
+    thread_pool_parallel_for(thread_pool, primitives.size(), [&](uint32_t index) {
+        decode_primitive(primitives[index], &primitive_datas[index]);
+    });
+
+    double decode_ms = timer_elapsed_ms(stage_start_time);
+    size_t decoded_bytes = 0;
+    for (const PrimitiveData &primitive_data: primitive_datas) {
+        decoded_bytes += primitive_data.vertices.size() * sizeof(Vertex) + primitive_data.indices.size() * sizeof(uint32_t);
+    }
+    stage_start_time = timer_now_ns();
 
-    result = cgltf_load_buffers(&options, data, filepath);
-    ASSERT(result == cgltf_result_success);
+    double optimize_ms = 0.0;
+    if (options->optimize) {
+        thread_pool_parallel_for(thread_pool, primitives.size(), [&](uint32_t index) {
+            PrimitiveData *primitive_data = &primitive_datas[index];
+            optimize_primitive(&primitive_data->vertices, &primitive_data->skin_vertices, &primitive_data->indices, &primitive_data->optimize_stats);
+        });
+        optimize_ms = timer_elapsed_ms(stage_start_time);
 
-    geometry->meshes.resize(data->meshes_count);
+        MeshOptimizeStats total_optimize_stats{};
+        for (const PrimitiveData &primitive_data: primitive_datas) { accumulate_mesh_optimize_stats(&total_optimize_stats, &primitive_data.optimize_stats); }
+        log_mesh_optimize_stats(filepath, &total_optimize_stats);
+    }
+    stage_start_time = timer_now_ns();
 
+    double lod_ms = 0.0;
+    if (options->generate_lods) {
+        thread_pool_parallel_for(thread_pool, primitives.size(), [&](uint32_t index) {
+            PrimitiveData *primitive_data = &primitive_datas[index];
+            generate_primitive_lods(primitive_data->vertices, primitive_data->indices, PRIMITIVE_MAX_LOD_COUNT, &primitive_data->lods);
+        });
+        lod_ms = timer_elapsed_ms(stage_start_time);
+
+        size_t lod_triangle_counts[PRIMITIVE_MAX_LOD_COUNT] = {};
+        for (const PrimitiveData &primitive_data: primitive_datas) {
+            for (size_t lod_index = 0; lod_index < primitive_data.lods.size(); ++lod_index) { lod_triangle_counts[lod_index] += primitive_data.lods[lod_index].indices.size() / 3; }
+        }
+        for (uint32_t lod_index = 0; lod_index < PRIMITIVE_MAX_LOD_COUNT && lod_triangle_counts[lod_index] > 0; ++lod_index) {
+            log_info("lod %u of %s: %zu triangles", lod_index, filepath, lod_triangle_counts[lod_index]);
+        }
+    }
+    stage_start_time = timer_now_ns();
+
+    double meshlet_ms = 0.0;
+    if (options->build_meshlets) {
+        thread_pool_parallel_for(thread_pool, primitives.size(), [&](uint32_t index) {
+            PrimitiveData *primitive_data = &primitive_datas[index];
+            build_primitive_meshlets(primitive_data->vertices, &primitive_data->indices, &primitive_data->meshlets);
+        });
+        meshlet_ms = timer_elapsed_ms(stage_start_time);
+
+        size_t meshlet_count = 0;
+        for (const PrimitiveData &primitive_data: primitive_datas) { meshlet_count += primitive_data.meshlets.size(); }
+        log_info("meshlets of %s: %zu", filepath, meshlet_count);
+    }
+    stage_start_time = timer_now_ns();
+
+    // 每张贴图内部再按块行并行编码
+    std::vector<TextureSource> texture_sources;
+    import_materials(data, options->import_textures, &gltf_import->materials, &texture_sources);
+    gltf_import->textures.resize(texture_sources.size());
+    thread_pool_parallel_for(thread_pool, texture_sources.size(), [&](uint32_t index) {
+        ImportedTexture *imported_texture = &gltf_import->textures[index];
+        EncodedImage encoded_image;
+        if (!read_encoded_image(filepath, texture_sources[index].image, &encoded_image)) {
+            log_error("failed to read image %s of %s", texture_sources[index].image->uri ? texture_sources[index].image->uri : "<buffer>", filepath);
+            *imported_texture = {};
+            return;
+        }
+        import_texture(thread_pool, encoded_image.data, encoded_image.size, texture_sources[index].usage, options->compress_textures, imported_texture);
+        release_encoded_image(&encoded_image);
+    });
+    double texture_ms = timer_elapsed_ms(stage_start_time);
+    stage_start_time = timer_now_ns();
+
+    gltf_import->meshes.resize(data->meshes_count);
+
+    // 按固定顺序合并，结果与线程调度无关
+    uint32_t index_type_counts[INDEX_TYPE_COUNT] = {};
+    size_t index_bytes = 0, u32_index_bytes = 0;
     for (size_t mesh_index = 0; mesh_index < data->meshes_count; ++mesh_index) {
         const cgltf_mesh *gltf_mesh = &data->meshes[mesh_index];
+        ImportedMesh *mesh = &gltf_import->meshes[mesh_index];
 
         log_debug("mesh index: %d, name: %s", mesh_index, gltf_mesh->name);
 
-        geometry->meshes[mesh_index].primitives.resize(gltf_mesh->primitives_count);
+        mesh->primitives.resize(gltf_mesh->primitives_count);
+
+        size_t vertex_count = 0, index_count = 0;
+        bool is_skinned = false;
+        for (size_t primitive_index = 0; primitive_index < gltf_mesh->primitives_count; ++primitive_index) {
+            const PrimitiveData &primitive_data = primitive_datas[first_primitive_indices[mesh_index] + primitive_index];
+            is_skinned = is_skinned || !primitive_data.skin_vertices.empty();
+            vertex_count += primitive_data.vertices.size();
+            index_count += primitive_data.indices.size();
+            for (size_t lod_index = 1; lod_index < primitive_data.lods.size(); ++lod_index) { index_count += primitive_data.lods[lod_index].indices.size(); }
+        }
+        u32_index_bytes += index_count * sizeof(uint32_t);
 
-        std::vector<Vertex> vertices;
-        std::vector<uint32_t> indices;// 暂时只支持 u32 索引类型
+        // Vertex 格式直接合并到导入结果中，其他格式先合并为 Vertex 再转换
+        std::vector<Vertex> merged_vertices;
+        Vertex *vertices;
+        if (options->vertex_layout == VERTEX_LAYOUT_STANDARD) {
+            mesh->vertices.resize(vertex_count * sizeof(Vertex));
+            vertices = (Vertex *) mesh->vertices.data();
+        } else {
+            merged_vertices.resize(vertex_count);
+            vertices = merged_vertices.data();
+        }
+        uint32_t merged_vertex_count = 0;
+        if (is_skinned) { mesh->skin_vertices.resize(vertex_count); }
+        std::vector<uint8_t> &indices = mesh->indices;
+        std::vector<Meshlet> &meshlets = mesh->meshlets;
+        indices.reserve(index_count * sizeof(uint32_t));
 
         for (size_t primitive_index = 0; primitive_index < gltf_mesh->primitives_count; ++primitive_index) {
-            const cgltf_primitive *primitive = &gltf_mesh->primitives[primitive_index];
-
-            log_debug("primitive index: %zu", primitive_index);
-
-            geometry->meshes[mesh_index].primitives[primitive_index].index_offset = indices.size();
-            ASSERT(primitive->indices);
-            geometry->meshes[mesh_index].primitives[primitive_index].index_count = primitive->indices->count;
-
-            uint32_t vertex_offset = vertices.size();
-            uint32_t index_offset = indices.size();
-
-            uint32_t vertex_count = primitive->attributes[0].data->count; // 假设同一 primitive 的所有 attribute 的 count 相同
-            vertices.resize(vertex_offset + vertex_count);
-            indices.resize(index_offset + primitive->indices->count);
-
-            for (size_t attribute_index = 0; attribute_index < primitive->attributes_count; ++attribute_index) {
-                const cgltf_attribute *attribute = &primitive->attributes[attribute_index];
-
-                log_debug("attribute name: %s", attribute->name);
-
-                if (strcmp(attribute->name, "POSITION") == 0) {
-                    for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
-                        void *pos = (void *) ((uintptr_t) attribute->data->buffer_view->buffer->data +
-                                              attribute->data->buffer_view->offset +
-                                              vertex_index * attribute->data->stride);
-                        memcpy(vertices[vertex_offset + vertex_index].pos, pos, attribute->data->stride);
-                    }
-                } else if (strcmp(attribute->name, "TEXCOORD_0") == 0) {
-                    for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
-                        void *tex_coord = (void *) ((uintptr_t) attribute->data->buffer_view->buffer->data + attribute->data->buffer_view->offset + vertex_index * attribute->data->stride);
-                        memcpy(vertices[vertex_offset + vertex_index].tex_coord, tex_coord, attribute->data->stride);
-                    }
-                } else if (strcmp(attribute->name, "NORMAL") == 0) {
-                    for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
-                        void *normal = (void *) ((uintptr_t) attribute->data->buffer_view->buffer->data + attribute->data->buffer_view->offset + vertex_index * attribute->data->stride);
-                        memcpy(vertices[vertex_offset + vertex_index].normal, normal, attribute->data->stride);
-                    }
-                }
+            PrimitiveData &primitive_data = primitive_datas[first_primitive_indices[mesh_index] + primitive_index];
+
+            // 同一 primitive 各级 lod 的索引类型相同，只需在 primitive 起始处对齐
+            Primitive *primitive = &mesh->primitives[primitive_index];
+            primitive->index_type = select_index_type(primitive_data.vertices.size(), options->uint8_indices);
+            uint32_t index_size = get_index_size(primitive->index_type);
+            indices.resize((indices.size() + index_size - 1) / index_size * index_size);
+            ++index_type_counts[primitive->index_type];
+            primitive->index_offset = append_indices(primitive_data.indices, primitive->index_type, &indices);
+            primitive->index_count = primitive_data.indices.size();
+            primitive->vertex_offset = merged_vertex_count;
+            primitive->vertex_count = primitive_data.vertices.size();
+            const cgltf_material *gltf_material = gltf_mesh->primitives[primitive_index].material;
+            primitive->material_index = gltf_material ? (int32_t) cgltf_material_index(data, gltf_material) : -1;
+
+            // 同一 mesh 的所有 primitive 共用一段顶点范围，索引保持相对于 primitive，绘制时通过 vertexOffset 偏移
+            memcpy(vertices + merged_vertex_count, primitive_data.vertices.data(), primitive_data.vertices.size() * sizeof(Vertex));
+            primitive->aabb = compute_aabb(vertices + merged_vertex_count, primitive->vertex_count);
+            primitive->bounding_sphere = compute_bounding_sphere(vertices + merged_vertex_count, primitive->vertex_count);
+            if (!primitive_data.skin_vertices.empty()) {
+                std::copy(primitive_data.skin_vertices.begin(), primitive_data.skin_vertices.end(), mesh->skin_vertices.begin() + merged_vertex_count);
+            } else if (is_skinned) {
+                // 同一 mesh 中没有蒙皮属性的 primitive 完全跟随第一个关节
+                std::fill_n(mesh->skin_vertices.begin() + merged_vertex_count, primitive_data.vertices.size(), SkinVertex{{0, 0, 0, 0}, {65535, 0, 0, 0}});
+            }
+            merged_vertex_count += primitive_data.vertices.size();
+
+            for (Meshlet meshlet: primitive_data.meshlets) {
+                meshlet.index_offset += primitive->index_offset;
+                meshlet.vertex_offset = primitive->vertex_offset;
+                meshlets.push_back(meshlet);
             }
 
-            for (uint32_t index = 0; index < primitive->indices->count; ++index) {
-                void *idx = (void *) ((uintptr_t) primitive->indices->buffer_view->buffer->data +
-                                      primitive->indices->buffer_view->offset +
-                                      index * primitive->indices->stride);
-                if (primitive->indices->component_type == cgltf_component_type_r_8u) {
-                    indices[index_offset + index] = *(uint8_t *) idx;
-                } else if (primitive->indices->component_type == cgltf_component_type_r_16u) {
-                    indices[index_offset + index] = *(uint16_t *) idx;
-                } else if (primitive->indices->component_type == cgltf_component_type_r_32u) {
-                    indices[index_offset + index] = *(uint32_t *) idx;
-                } else {
-                    ASSERT_MESSAGE(false, "unsupported index component type - %d", primitive->indices->component_type);
-                }
+            // 各级 lod 的索引紧跟在 lod 0 之后
+            primitive->lod_count = 1;
+            primitive->lods[0] = {primitive->index_offset, primitive->index_count, 0.0f};
+            for (size_t lod_index = 1; lod_index < primitive_data.lods.size(); ++lod_index) {
+                const MeshLodLevel &lod = primitive_data.lods[lod_index];
+                uint32_t lod_index_offset = append_indices(lod.indices, primitive->index_type, &indices);
+                primitive->lods[primitive->lod_count++] = {lod_index_offset, (uint32_t) lod.indices.size(), lod.error};
             }
-        } // end looping primitives
 
-        Mesh *mesh = &geometry->meshes[mesh_index];
+            primitive_data = {}; // 合并后立即释放，降低大模型导入时的内存峰值
+        }
 
-        // todo parse node transform
+        mesh->aabb = compute_aabb(vertices, vertex_count);
+        mesh->bounding_sphere = compute_bounding_sphere(vertices, vertex_count);
+        index_bytes += indices.size();
 
-        create_mesh_buffer(vk_context, vertices.data(), vertices.size(), sizeof(Vertex), indices.data(), indices.size(), sizeof(uint32_t), &mesh->mesh_buffer);
+        // 转换为导入时的顶点格式，之后的上传只需整块拷贝
+        mesh->vertex_count = vertex_count;
+        mesh->quantization = {};
+        if (options->vertex_layout == VERTEX_LAYOUT_PACKED) {
+            mesh->vertices.resize(vertex_count * get_vertex_stride(options->vertex_layout));
+            pack_vertices(vertices, vertex_count, (PackedVertex *) mesh->vertices.data(), &mesh->quantization);
+        }
+
+        if (options->position_stream) {
+            mesh->positions.resize(vertex_count * get_position_stride(options->vertex_layout));
+            extract_positions(mesh->vertices.data(), vertex_count, options->vertex_layout, mesh->positions.data());
+        }
     } // end looping meshes
 
+    std::vector<int32_t> node_indices;
+    import_nodes(data, &gltf_import->nodes, &node_indices);
+    import_skins(data, node_indices, &gltf_import->nodes, &gltf_import->skins, &gltf_import->joints);
+    import_animations(thread_pool, data, node_indices, &gltf_import->animations);
+
+    double merge_ms = timer_elapsed_ms(stage_start_time);
+
+    // 外部 buffer 文件的内容也参与缓存校验，内嵌的 data uri 已包含在源文件哈希中
+    std::vector<std::string> dependency_uris;
+    for (size_t buffer_index = 0; buffer_index < data->buffers_count; ++buffer_index) {
+        const char *uri = data->buffers[buffer_index].uri;
+        if (uri && strncmp(uri, "data:", 5) != 0) { dependency_uris.push_back(uri); }
+    }
+    for (const TextureSource &texture_source: texture_sources) {
+        const char *uri = texture_source.image->uri;
+        if (uri && strncmp(uri, "data:", 5) != 0) {
+            std::string decoded_uri = uri;
+            decoded_uri.resize(cgltf_decode_uri(decoded_uri.data()));
+            if (std::find(dependency_uris.begin(), dependency_uris.end(), decoded_uri) == dependency_uris.end()) { dependency_uris.push_back(decoded_uri); }
+        }
+    }
+
     cgltf_free(data);
+
+    if (is_source_hashed) { mesh_cache_write(filepath, source_hash, import_flags, dependency_uris, gltf_import); }
+
+    log_info("import gltf %s: %zu meshes, %zu primitives, %zu nodes, %zu materials, %zu textures, %u workers, %s decode", filepath,
+             gltf_import->meshes.size(), primitives.size(), gltf_import->nodes.size(), gltf_import->materials.size(), gltf_import->textures.size(),
+             thread_pool_worker_count(thread_pool), accessor_decode_simd_name());
+    log_info("  parse %.2f ms, load buffers %.2f ms, decode %.2f ms (%.1f MB/s), optimize %.2f ms, lod %.2f ms, meshlet %.2f ms, texture %.2f ms, merge %.2f ms, "
+             "total %.2f ms",
+             parse_ms, load_buffers_ms, decode_ms, decode_ms > 0.0 ? decoded_bytes / (decode_ms * 1e3) : 0.0, optimize_ms, lod_ms, meshlet_ms, texture_ms,
+             merge_ms, timer_elapsed_ms(start_time));
+    log_info("  indices: %u u32 / %u u16 / %u u8 primitives, %.1f KB (%.1f KB as u32)", index_type_counts[INDEX_TYPE_UINT32],
+             index_type_counts[INDEX_TYPE_UINT16], index_type_counts[INDEX_TYPE_UINT8], index_bytes / 1024.0, u32_index_bytes / 1024.0);
+    return true;
+}
+
+void create_imported_mesh(UploadEngine *upload_engine, GeometryArena *arena, VertexLayout vertex_layout, const ImportedMesh *imported_mesh,
+                          uint32_t first_material_index, Mesh *mesh) {
+    mesh->primitives = imported_mesh->primitives;
+    for (Primitive &primitive: mesh->primitives) {
+        if (primitive.material_index >= 0) { primitive.material_index += first_material_index; }
+    }
+    create_mesh_buffer(upload_engine, arena, imported_mesh->vertices.data(), imported_mesh->vertex_count, get_vertex_stride(vertex_layout),
+                       imported_mesh->positions.empty() ? nullptr : imported_mesh->positions.data(), get_position_stride(vertex_layout),
+                       imported_mesh->skin_vertices.empty() ? nullptr : imported_mesh->skin_vertices.data(),
+                       imported_mesh->indices.data(), imported_mesh->indices.size(),
+                       imported_mesh->meshlets.data(), imported_mesh->meshlets.size(), &mesh->mesh_buffer);
+    mesh->mesh_buffer.vertex_layout = vertex_layout;
+    mesh->mesh_buffer.quantization = imported_mesh->quantization;
+    mesh->aabb = imported_mesh->aabb;
+    mesh->bounding_sphere = imported_mesh->bounding_sphere;
+}
+
+// 蒙皮流中引用的关节数，即最大的关节下标加 1；权重为 0 的分量着色器同样会读取，一并统计
+static uint32_t get_referenced_joint_count(const ImportedMesh *imported_mesh) {
+    uint32_t joint_count = 0;
+    for (const SkinVertex &skin_vertex: imported_mesh->skin_vertices) {
+        for (uint32_t c = 0; c < 4; ++c) { joint_count = std::max(joint_count, (uint32_t) skin_vertex.joints[c] + 1); }
+    }
+    return joint_count;
+}
+
+void create_imported_scene(const GltfImport *gltf_import, Geometry *geometry, GeometryImportBase *import_base) {
+    import_base->first_mesh_index = geometry->meshes.size();
+    import_base->first_material_index = geometry->materials.size();
+    import_base->first_texture_index = geometry->textures.size();
+    import_base->first_skin_index = geometry->skins.size();
+    import_base->first_instance_index = geometry->instances.size();
+
+    for (Material material: gltf_import->materials) {
+        if (material.base_color_texture >= 0) { material.base_color_texture += import_base->first_texture_index; }
+        if (material.normal_texture >= 0) { material.normal_texture += import_base->first_texture_index; }
+        geometry->materials.push_back(material);
+    }
+    geometry->textures.resize(import_base->first_texture_index + gltf_import->textures.size(), Texture{});
+
+    // 实例引用的 mesh 下标在此确定，mesh 整段预留，交接前不可用
+    Mesh pending_mesh{};
+    pending_mesh.mesh_buffer.upload_token = UPLOAD_TOKEN_NEVER;
+    geometry->meshes.resize(import_base->first_mesh_index + gltf_import->meshes.size(), pending_mesh);
+
+    const uint32_t first_mesh_index = import_base->first_mesh_index;
+    const std::vector<ImportedNode> &nodes = gltf_import->nodes;
+    std::vector<int32_t> parents(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) { parents[i] = nodes[i].parent; }
+
+    // 蒙皮着色器按关节下标直接读取关节矩阵，不做边界检查，下标超出 skin 关节数的实例不蒙皮
+    std::vector<uint32_t> referenced_joint_counts(gltf_import->meshes.size());
+    for (size_t i = 0; i < gltf_import->meshes.size(); ++i) { referenced_joint_counts[i] = get_referenced_joint_count(&gltf_import->meshes[i]); }
+
+    TransformHierarchy *transform_hierarchy = &geometry->transform_hierarchy;
+    uint32_t first_node = add_transform_nodes(transform_hierarchy, parents.data(), parents.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const ImportedNode *node = &nodes[i];
+        set_local_transform(transform_hierarchy, first_node + i, glm::vec3(node->translation[0], node->translation[1], node->translation[2]),
+                            glm::quat(node->rotation[3], node->rotation[0], node->rotation[1], node->rotation[2]),
+                            glm::vec3(node->scale[0], node->scale[1], node->scale[2]));
+        if (node->mesh_index >= 0) {
+            int32_t skin_index = node->skin_index >= 0 ? (int32_t) import_base->first_skin_index + node->skin_index : -1;
+            if (skin_index >= 0 && referenced_joint_counts[node->mesh_index] > gltf_import->skins[node->skin_index].joint_count) {
+                log_warning("node %zu references joint %u of skin %d with %u joints, skinning disabled", i, referenced_joint_counts[node->mesh_index] - 1,
+                            node->skin_index, gltf_import->skins[node->skin_index].joint_count);
+                skin_index = -1;
+            }
+            geometry->instances.push_back({first_mesh_index + node->mesh_index, (uint32_t) (first_node + i), 0, 0, skin_index, 0, 0});
+        }
+    }
+    import_base->instance_count = geometry->instances.size() - import_base->first_instance_index;
+
+    for (const ImportedSkin &imported_skin: gltf_import->skins) {
+        Skin skin;
+        for (uint32_t i = 0; i < imported_skin.joint_count; ++i) {
+            const ImportedJoint *joint = &gltf_import->joints[imported_skin.first_joint + i];
+            skin.joint_nodes.push_back(first_node + joint->node);
+            skin.inverse_bind_matrices.push_back(glm::make_mat4(joint->inverse_bind_matrix));
+        }
+        geometry->skins.push_back(std::move(skin));
+    }
+
+    for (AnimationClip animation: gltf_import->animations) {
+        for (AnimationTrack &track: animation.tracks) { track.node += first_node; }
+        geometry->animations.push_back(std::move(animation));
+    }
+}
+
+size_t get_imported_mesh_size(const ImportedMesh *imported_mesh) {
+    return imported_mesh->vertices.size() + imported_mesh->positions.size() + imported_mesh->indices.size() +
+           imported_mesh->meshlets.size() * sizeof(Meshlet);
+}
+
+void load_gltf(UploadEngine *upload_engine, GeometryArena *arena, ThreadPool *thread_pool, const char *filepath, const GltfLoadOptions *options,
+               Geometry *geometry) {
+    GltfImport gltf_import;
+    bool succeed = import_gltf(thread_pool, filepath, options, &gltf_import);
+    ASSERT_MESSAGE(succeed, "failed to import gltf %s", filepath);
+
+    GeometryImportBase import_base;
+    create_imported_scene(&gltf_import, geometry, &import_base);
+    for (size_t texture_index = 0; texture_index < gltf_import.textures.size(); ++texture_index) {
+        create_imported_texture(upload_engine, &gltf_import.textures[texture_index], &geometry->textures[import_base.first_texture_index + texture_index]);
+    }
+    for (size_t mesh_index = 0; mesh_index < gltf_import.meshes.size(); ++mesh_index) {
+        create_imported_mesh(upload_engine, arena, gltf_import.vertex_layout, &gltf_import.meshes[mesh_index], import_base.first_material_index,
+                             &geometry->meshes[import_base.first_mesh_index + mesh_index]);
+    }
+    upload_engine_flush(upload_engine);
+}
+
+Aabb compute_aabb(const Vertex *vertices, uint32_t vertex_count) {
+    Aabb aabb{glm::vec3(0.0f), glm::vec3(0.0f)};
+    if (vertex_count == 0) { return aabb; }
+
+    aabb.min = aabb.max = glm::vec3(vertices[0].pos[0], vertices[0].pos[1], vertices[0].pos[2]);
+    for (uint32_t i = 1; i < vertex_count; ++i) {
+        glm::vec3 pos(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]);
+        aabb.min = glm::min(aabb.min, pos);
+        aabb.max = glm::max(aabb.max, pos);
+    }
+    return aabb;
+}
+
+BoundingSphere compute_bounding_sphere(const Vertex *vertices, uint32_t vertex_count) {
+    BoundingSphere bounding_sphere{glm::vec3(0.0f), 0.0f};
+    if (vertex_count == 0) { return bounding_sphere; }
+
+    Aabb aabb = compute_aabb(vertices, vertex_count);
+    bounding_sphere.center = (aabb.min + aabb.max) * 0.5f;
+
+    float radius_squared = 0.0f;
+    for (uint32_t i = 0; i < vertex_count; ++i) {
+        glm::vec3 offset = glm::vec3(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]) - bounding_sphere.center;
+        radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+    }
+    bounding_sphere.radius = std::sqrt(radius_squared);
+    return bounding_sphere;
 }
 
-void destroy_geometry(VkContext *vk_context, Geometry *geometry) {
-    for (Mesh &mesh: geometry->meshes) { destroy_mesh(vk_context, &mesh); }
+void destroy_geometry(VkContext *vk_context, GeometryArena *arena, Geometry *geometry) {
+    for (Mesh &mesh: geometry->meshes) { destroy_mesh(arena, &mesh); }
+    for (Texture &texture: geometry->textures) { destroy_texture(vk_context, &texture); }
 }
 
-void destroy_mesh(VkContext *vk_context, Mesh *mesh) { destroy_mesh_buffer(vk_context, &mesh->mesh_buffer); }
+void destroy_mesh(GeometryArena *arena, Mesh *mesh) { destroy_mesh_buffer(arena, &mesh->mesh_buffer); }
@@ -1,29 +1,184 @@
 #pragma once
 
+#include "animation_clip.h"
 #include "mesh_buffer.h"
+#include "texture_import.h"
+#include "transform_hierarchy.h"
 #include <cgltf.h>
 
+struct ThreadPool;
+
+#define PRIMITIVE_MAX_LOD_COUNT 8
+
+// 一级 lod 在 mesh 索引中的范围，各级共用 primitive 的顶点
+struct PrimitiveLod {
+    uint32_t index_offset; // 相对于 mesh 首个索引，以 primitive 的索引类型计
+    uint32_t index_count;
+    float error; // 相对于 lod 0 的最大几何误差，模型空间距离
+};
+
+struct Aabb {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+struct BoundingSphere {
+    glm::vec3 center;
+    float radius;
+};
+
+// 索引相对于 primitive 的首个顶点，绘制时以 index_type 绑定索引缓冲，firstIndex = get_first_index(index_type) + index_offset，vertexOffset = vertex_offset
+// 同一 mesh 的 primitive 可以使用不同的索引类型，各自的索引数据按索引大小对齐
 struct Primitive {
-    uint32_t index_offset;
+    IndexType index_type;
+    uint32_t index_offset; // lod 0，相对于 mesh 首个索引，以 index_type 的索引个数计
     uint32_t index_count;
+    uint32_t vertex_offset; // 相对于 mesh 首个顶点
+    uint32_t vertex_count;
+    int32_t material_index; // 在 Geometry::materials 中的下标，-1 为默认材质
+    uint32_t lod_count; // 至少为 1，lods[0] 与 index_offset/index_count 相同
+    PrimitiveLod lods[PRIMITIVE_MAX_LOD_COUNT];
+    Aabb aabb; // 模型空间，蒙皮 mesh 为绑定姿态下的
+    BoundingSphere bounding_sphere;
 };
 
 struct Mesh {
     uint32_t id;
     std::vector<Primitive> primitives;
     MeshBuffer mesh_buffer;
+    Aabb aabb; // 模型空间，包含所有 primitive
+    BoundingSphere bounding_sphere;
+};
+
+// 贴图下标为 -1 时使用默认贴图
+struct Material {
+    int32_t base_color_texture; // 在 Geometry::textures 中的下标
+    int32_t normal_texture;
+};
+
+// 引用 mesh 的节点，同一 mesh 可被多个节点实例化，lod 与剔除都按实例进行
+// 关节为 Geometry::transform_hierarchy 中的节点，蒙皮矩阵 = 关节世界矩阵 * inverse_bind_matrix
+struct Skin {
+    std::vector<uint32_t> joint_nodes;
+    std::vector<glm::mat4> inverse_bind_matrices;
+};
 
-    glm::vec3 translation;
-    glm::vec3 euler_angles; // in degrees, not radians
-    glm::vec3 scale;
+struct MeshInstance {
+    uint32_t mesh_index;          // 超出 Geometry::meshes 范围时不绘制，取消加载的实例以此禁用
+    uint32_t node_index;          // 在 Geometry::transform_hierarchy 中的下标
+    uint32_t lod_level;           // 当前选择的 lod，换挡时用于滞后判断
+    uint32_t cluster_draw_offset; // 在每帧 cluster draw buffer 中的字节偏移，gpu driven 绘制时为其批次在 indirect draw buffer 中的偏移，由 app 分配
+    int32_t skin_index;           // 在 Geometry::skins 中的下标，mesh 有蒙皮流时才生效，-1 为不蒙皮
+    uint32_t skinned_vertex_offset; // 在每帧 skinned vertex buffer 中的字节偏移，由 app 分配
+    uint32_t instance_data_index;   // gpu driven 绘制时 cluster culling 写出的命令引用的 InstanceData 下标，由 app 分配
 };
 
 struct Geometry {
-    std::vector<Mesh> meshes;
+    std::vector<Mesh> meshes; // 异步加载时在开始交接时整段预留，尚未交接的 upload_token 为 UPLOAD_TOKEN_NEVER
+    std::vector<Material> materials;
+    std::vector<Texture> textures; // 异步加载时逐个创建，尚未创建的为空
+    std::vector<Skin> skins;
+    std::vector<AnimationClip> animations; // 轨道的目标为 transform_hierarchy 中的节点
+    TransformHierarchy transform_hierarchy;
+    std::vector<MeshInstance> instances; // 异步加载时可能引用尚未交接的 mesh
 };
 
-void load_gltf(VkContext *vk_context, const char *filepath, Geometry *geometry);
+struct GltfLoadOptions {
+    bool optimize; // 导入后对每个 primitive 执行 meshoptimizer 优化，并输出 acmr/atvr 统计
+    VertexLayout vertex_layout;
+    bool position_stream; // 额外创建仅含位置的顶点流，供 wireframe 等只需位置的 pass 使用
+    bool generate_lods;   // 为每个 primitive 生成简化的 lod 链
+    bool build_meshlets;  // 将 lod 0 划分为 meshlet 并按 meshlet 重排索引，供 cluster culling 使用
+    bool import_textures; // 导入材质引用的 base color 与法线贴图
+    bool compress_textures; // 贴图编码为块压缩格式，设备不支持时应关闭
+    bool map_files; // gltf/glb 与外部 buffer 以内存映射读取，glb 的二进制块直接在映射的内存上解码，不再整块读入堆
+    bool uint8_indices; // 顶点数不超过 256 的 primitive 使用 u8 索引，设备不支持 VK_EXT_index_type_uint8 时应关闭，否则使用 u16
+};
+
+// 导入完成、尚未上传的单个 mesh，数据已按导入时的顶点格式排列，可直接拷入 staging
+struct ImportedMesh {
+    std::vector<Primitive> primitives;
+    uint32_t vertex_count;
+    std::vector<uint8_t> vertices;  // vertex_count * get_vertex_stride(vertex_layout) 字节
+    std::vector<uint8_t> positions; // 可选的位置流，为空时不创建
+    std::vector<SkinVertex> skin_vertices; // 蒙皮 mesh 每个顶点一个，否则为空
+    std::vector<uint8_t> indices; // 各 primitive 按各自的 index_type 存放
+    std::vector<Meshlet> meshlets;
+    VertexQuantization quantization;
+    Aabb aabb;
+    BoundingSphere bounding_sphere;
+};
+
+// 导入的场景节点，按先序深度优先排列，父节点总在子节点之前
+struct ImportedNode {
+    int32_t parent;     // 根节点为 -1
+    int32_t mesh_index; // 不引用 mesh 时为 -1
+    int32_t skin_index; // 不蒙皮时为 -1
+    float translation[3];
+    float rotation[4]; // 四元数 x, y, z, w
+    float scale[3];
+};
+
+// 关节节点为 ImportedNode 的下标
+struct ImportedJoint {
+    int32_t node;
+    float inverse_bind_matrix[16]; // 列主序
+};
+
+// 一个 skin 的关节为 GltfImport::joints 中连续的一段
+struct ImportedSkin {
+    uint32_t first_joint;
+    uint32_t joint_count;
+};
+
+struct GltfImport {
+    VertexLayout vertex_layout;
+    std::vector<ImportedMesh> meshes;
+    std::vector<ImportedNode> nodes;
+    std::vector<ImportedSkin> skins;
+    std::vector<ImportedJoint> joints;
+    std::vector<AnimationClip> animations; // 已压缩，轨道的目标为 nodes 的下标
+    std::vector<Material> materials; // 贴图下标相对于 textures
+    std::vector<ImportedTexture> textures;
+};
+
+// 一次导入追加到 Geometry 时各表的起始下标，导入结果中的下标均相对于这些位置
+struct GeometryImportBase {
+    uint32_t first_mesh_index;
+    uint32_t first_material_index;
+    uint32_t first_texture_index;
+    uint32_t first_skin_index;
+    uint32_t first_instance_index;
+    uint32_t instance_count;
+};
+
+// 顶点数为 0 时为原点处的空包围盒
+Aabb compute_aabb(const Vertex *vertices, uint32_t vertex_count);
+
+// 以 aabb 中心为球心的包围球
+BoundingSphere compute_bounding_sphere(const Vertex *vertices, uint32_t vertex_count);
+
+// cpu 阶段：解析、解码、优化并生成 lod 与 meshlet，烘焙贴图，命中缓存时直接读取烘焙结果，文件无法解析时返回 false
+// 不访问 gpu，可在工作线程上执行；`thread_pool` 用于并行处理各 primitive，可以为 nullptr
+bool import_gltf(ThreadPool *thread_pool, const char *filepath, const GltfLoadOptions *options, GltfImport *gltf_import);
+
+// gpu 阶段：在 `arena` 中分配范围并录制上传，只能在 upload engine 所属的线程上调用
+// 上传随下一次 flush 提交，可通过 Mesh::mesh_buffer.upload_token 查询是否完成
+// primitive 的材质下标加上 `first_material_index`
+void create_imported_mesh(UploadEngine *upload_engine, GeometryArena *arena, VertexLayout vertex_layout, const ImportedMesh *imported_mesh,
+                          uint32_t first_material_index, Mesh *mesh);
+
+// 在交接 mesh 与贴图之前调用：追加材质并为 mesh 与贴图预留位置，将导入的节点追加到 `geometry` 的节点层级并为引用 mesh 的节点创建实例
+// 之后的 mesh 与贴图创建到预留的位置，预留的 mesh 在创建前不可用，多个导入可以交替交接
+void create_imported_scene(const GltfImport *gltf_import, Geometry *geometry, GeometryImportBase *import_base);
+
+// 上传该 mesh 需要拷入 staging 的字节数
+size_t get_imported_mesh_size(const ImportedMesh *imported_mesh);
+
+// 同步导入并创建所有 mesh，返回时上传已 flush；异步加载见 asset_loader.h
+void load_gltf(UploadEngine *upload_engine, GeometryArena *arena, ThreadPool *thread_pool, const char *filepath, const GltfLoadOptions *options,
+               Geometry *geometry);
 
-void destroy_geometry(VkContext *vk_context, Geometry *geometry);
+void destroy_geometry(VkContext *vk_context, GeometryArena *arena, Geometry *geometry);
 
-void destroy_mesh(VkContext *vk_context, Mesh *mesh);
+void destroy_mesh(GeometryArena *arena, Mesh *mesh);
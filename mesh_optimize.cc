@@ -0,0 +1,158 @@
+#include "mesh_optimize.h"
+#include "core/logging.h"
+#include <algorithm>
+#include <meshoptimizer.h>
+
+#define MESH_OPTIMIZE_CACHE_SIZE 16
+#define MESH_OPTIMIZE_OVERDRAW_THRESHOLD 1.05f // 允许顶点缓存效率最多变差 5% 以换取更少的 overdraw
+#define MESH_LOD_REDUCTION 0.5f                // 每级 lod 的目标三角形数比例
+#define MESH_LOD_MIN_REDUCTION 0.85f           // 简化后的三角形数超过上一级的该比例时认为无法继续简化
+#define MESH_LOD_MAX_ERROR 0.1f                // 相对于网格尺寸的最大误差
+#define MESH_LOD_MIN_TRIANGLE_COUNT 64
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124           // 与 MESHLET_MAX_VERTICES 一起满足常见 mesh shader 的输出上限
+#define MESHLET_CONE_WEIGHT 0.25f           // 划分时兼顾法线锥的紧凑程度，提高背面剔除率
+
+static void analyze(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t *vertices_transformed, uint32_t *bytes_fetched) {
+    meshopt_VertexCacheStatistics cache_stats = meshopt_analyzeVertexCache(indices.data(), indices.size(), vertices.size(), MESH_OPTIMIZE_CACHE_SIZE, 0, 0);
+    meshopt_VertexFetchStatistics fetch_stats = meshopt_analyzeVertexFetch(indices.data(), indices.size(), vertices.size(), sizeof(Vertex));
+    *vertices_transformed = cache_stats.vertices_transformed;
+    *bytes_fetched = fetch_stats.bytes_fetched;
+}
+
+void optimize_primitive(std::vector<Vertex> *vertices, std::vector<SkinVertex> *skin_vertices, std::vector<uint32_t> *indices, MeshOptimizeStats *stats) {
+    *stats = {};
+    stats->triangle_count = indices->size() / 3;
+    stats->vertex_count_before = vertices->size();
+    stats->vertex_count_after = vertices->size();
+    if (vertices->empty() || indices->empty()) { return; }
+    analyze(*vertices, *indices, &stats->vertices_transformed_before, &stats->bytes_fetched_before);
+
+    // 只比较有效字段，Vertex 中因对齐产生的填充字节不参与去重
+    const bool is_skinned = !skin_vertices->empty();
+    const meshopt_Stream streams[] = {
+            {&(*vertices)[0].pos, sizeof(Vertex::pos), sizeof(Vertex)},
+            {&(*vertices)[0].tex_coord, sizeof(Vertex::tex_coord), sizeof(Vertex)},
+            {&(*vertices)[0].normal, sizeof(Vertex::normal), sizeof(Vertex)},
+            {&(*vertices)[0].color, sizeof(Vertex::color), sizeof(Vertex)},
+            {is_skinned ? skin_vertices->data() : nullptr, sizeof(SkinVertex), sizeof(SkinVertex)},
+    };
+    std::vector<uint32_t> remap(vertices->size());
+    size_t unique_vertex_count = meshopt_generateVertexRemapMulti(remap.data(), indices->data(), indices->size(), vertices->size(),
+                                                                  streams, sizeof(streams) / sizeof(streams[0]) - (is_skinned ? 0 : 1));
+
+    std::vector<Vertex> unique_vertices(unique_vertex_count);
+    meshopt_remapVertexBuffer(unique_vertices.data(), vertices->data(), vertices->size(), sizeof(Vertex), remap.data());
+    std::vector<SkinVertex> unique_skin_vertices(is_skinned ? unique_vertex_count : 0);
+    if (is_skinned) { meshopt_remapVertexBuffer(unique_skin_vertices.data(), skin_vertices->data(), skin_vertices->size(), sizeof(SkinVertex), remap.data()); }
+    meshopt_remapIndexBuffer(indices->data(), indices->data(), indices->size(), remap.data());
+
+    meshopt_optimizeVertexCache(indices->data(), indices->data(), indices->size(), unique_vertex_count);
+    meshopt_optimizeOverdraw(indices->data(), indices->data(), indices->size(), unique_vertices[0].pos, unique_vertex_count,
+                             sizeof(Vertex), MESH_OPTIMIZE_OVERDRAW_THRESHOLD);
+
+    // 按首次被索引的顺序重排顶点，蒙皮顶点流使用同一映射；未被索引引用的顶点会被丢弃
+    size_t fetched_vertex_count = meshopt_optimizeVertexFetchRemap(remap.data(), indices->data(), indices->size(), unique_vertex_count);
+    meshopt_remapIndexBuffer(indices->data(), indices->data(), indices->size(), remap.data());
+    vertices->resize(fetched_vertex_count);
+    meshopt_remapVertexBuffer(vertices->data(), unique_vertices.data(), unique_vertex_count, sizeof(Vertex), remap.data());
+    if (is_skinned) {
+        skin_vertices->resize(fetched_vertex_count);
+        meshopt_remapVertexBuffer(skin_vertices->data(), unique_skin_vertices.data(), unique_vertex_count, sizeof(SkinVertex), remap.data());
+    }
+
+    stats->vertex_count_after = vertices->size();
+    analyze(*vertices, *indices, &stats->vertices_transformed_after, &stats->bytes_fetched_after);
+}
+
+void generate_primitive_lods(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t max_lod_count,
+                             std::vector<MeshLodLevel> *lods) {
+    lods->clear();
+    lods->push_back({indices, 0.0f});
+    if (vertices.empty() || indices.empty()) { return; }
+
+    // meshopt_simplify 返回的误差相对于网格尺寸，乘以 scale 得到模型空间距离
+    float scale = meshopt_simplifyScale(vertices[0].pos, vertices.size(), sizeof(Vertex));
+
+    while (lods->size() < max_lod_count) {
+        const MeshLodLevel &previous = lods->back();
+        size_t previous_index_count = previous.indices.size();
+        if (previous_index_count / 3 <= MESH_LOD_MIN_TRIANGLE_COUNT) { break; }
+
+        size_t target_index_count = (size_t) (previous_index_count * MESH_LOD_REDUCTION) / 3 * 3;
+        std::vector<uint32_t> lod_indices(previous_index_count);
+        float result_error = 0.0f;
+        // 从上一级继续简化，相对 lod 0 的误差不超过各级误差之和
+        size_t lod_index_count = meshopt_simplify(lod_indices.data(), previous.indices.data(), previous_index_count, vertices[0].pos,
+                                                  vertices.size(), sizeof(Vertex), target_index_count, MESH_LOD_MAX_ERROR, 0, &result_error);
+        if (lod_index_count == 0 || lod_index_count > previous_index_count * MESH_LOD_MIN_REDUCTION) { break; }
+
+        lod_indices.resize(lod_index_count);
+        meshopt_optimizeVertexCache(lod_indices.data(), lod_indices.data(), lod_indices.size(), vertices.size());
+
+        float error = previous.error + result_error * scale;
+        lods->push_back({std::move(lod_indices), error});
+    }
+}
+
+void build_primitive_meshlets(const std::vector<Vertex> &vertices, std::vector<uint32_t> *indices, std::vector<Meshlet> *meshlets) {
+    meshlets->clear();
+    if (vertices.empty() || indices->empty()) { return; }
+
+    size_t max_meshlet_count = meshopt_buildMeshletsBound(indices->size(), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+    std::vector<meshopt_Meshlet> meshopt_meshlets(max_meshlet_count);
+    std::vector<uint32_t> meshlet_vertices(max_meshlet_count * MESHLET_MAX_VERTICES);
+    std::vector<uint8_t> meshlet_triangles(max_meshlet_count * MESHLET_MAX_TRIANGLES * 3);
+    size_t meshlet_count = meshopt_buildMeshlets(meshopt_meshlets.data(), meshlet_vertices.data(), meshlet_triangles.data(), indices->data(),
+                                                 indices->size(), vertices[0].pos, vertices.size(), sizeof(Vertex), MESHLET_MAX_VERTICES,
+                                                 MESHLET_MAX_TRIANGLES, MESHLET_CONE_WEIGHT);
+
+    // meshlet 覆盖全部三角形，按 meshlet 顺序展开回 primitive 内的局部索引
+    std::vector<uint32_t> meshlet_indices;
+    meshlet_indices.reserve(indices->size());
+    meshlets->resize(meshlet_count);
+    for (size_t i = 0; i < meshlet_count; ++i) {
+        const meshopt_Meshlet &meshopt_meshlet = meshopt_meshlets[i];
+        meshopt_Bounds bounds = meshopt_computeMeshletBounds(&meshlet_vertices[meshopt_meshlet.vertex_offset], &meshlet_triangles[meshopt_meshlet.triangle_offset],
+                                                             meshopt_meshlet.triangle_count, vertices[0].pos, vertices.size(), sizeof(Vertex));
+
+        Meshlet *meshlet = &(*meshlets)[i];
+        *meshlet = {};
+        meshlet->center = glm::vec3(bounds.center[0], bounds.center[1], bounds.center[2]);
+        meshlet->radius = bounds.radius;
+        meshlet->cone_apex = glm::vec3(bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]);
+        meshlet->cone_cutoff = bounds.cone_cutoff;
+        meshlet->cone_axis = glm::vec3(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]);
+        meshlet->index_offset = meshlet_indices.size();
+        meshlet->index_count = meshopt_meshlet.triangle_count * 3;
+
+        for (uint32_t j = 0; j < meshopt_meshlet.triangle_count * 3; ++j) {
+            meshlet_indices.push_back(meshlet_vertices[meshopt_meshlet.vertex_offset + meshlet_triangles[meshopt_meshlet.triangle_offset + j]]);
+        }
+    }
+    ASSERT(meshlet_indices.size() == indices->size());
+    *indices = std::move(meshlet_indices);
+}
+
+void accumulate_mesh_optimize_stats(MeshOptimizeStats *total, const MeshOptimizeStats *stats) {
+    total->triangle_count += stats->triangle_count;
+    total->vertex_count_before += stats->vertex_count_before;
+    total->vertex_count_after += stats->vertex_count_after;
+    total->vertices_transformed_before += stats->vertices_transformed_before;
+    total->vertices_transformed_after += stats->vertices_transformed_after;
+    total->bytes_fetched_before += stats->bytes_fetched_before;
+    total->bytes_fetched_after += stats->bytes_fetched_after;
+}
+
+void log_mesh_optimize_stats(const char *name, const MeshOptimizeStats *stats) {
+    if (stats->triangle_count == 0) { return; }
+    float acmr_before = (float) stats->vertices_transformed_before / stats->triangle_count;
+    float acmr_after = (float) stats->vertices_transformed_after / stats->triangle_count;
+    float atvr_before = stats->vertex_count_before ? (float) stats->vertices_transformed_before / stats->vertex_count_before : 0.0f;
+    float atvr_after = stats->vertex_count_after ? (float) stats->vertices_transformed_after / stats->vertex_count_after : 0.0f;
+    float overfetch_before = stats->vertex_count_before ? (float) stats->bytes_fetched_before / (stats->vertex_count_before * sizeof(Vertex)) : 0.0f;
+    float overfetch_after = stats->vertex_count_after ? (float) stats->bytes_fetched_after / (stats->vertex_count_after * sizeof(Vertex)) : 0.0f;
+    log_info("optimize %s: %u triangles, vertices %u -> %u, acmr %.3f -> %.3f, atvr %.3f -> %.3f, overfetch %.3f -> %.3f", name,
+             stats->triangle_count, stats->vertex_count_before, stats->vertex_count_after, acmr_before, acmr_after, atvr_before, atvr_after,
+             overfetch_before, overfetch_after);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "mesh_buffer.h"
+#include <vector>
+
+// 顶点缓存与顶点读取的统计，优化前后各一份
+struct MeshOptimizeStats {
+    uint32_t triangle_count;
+    uint32_t vertex_count_before;
+    uint32_t vertex_count_after;
+    uint32_t vertices_transformed_before; // 按 fifo 顶点缓存模拟的顶点着色器调用次数
+    uint32_t vertices_transformed_after;
+    uint32_t bytes_fetched_before;
+    uint32_t bytes_fetched_after;
+};
+
+// 对单个 primitive 依次执行顶点去重、顶点缓存优化、overdraw 优化与顶点读取优化，原地修改顶点与索引
+// `skin_vertices` 不为空时与顶点一起参与去重并按同样的顺序重排；索引为 primitive 内的局部索引，可在工作线程上执行
+void optimize_primitive(std::vector<Vertex> *vertices, std::vector<SkinVertex> *skin_vertices, std::vector<uint32_t> *indices, MeshOptimizeStats *stats);
+
+// 一级 lod 的索引，`error` 为相对于原始网格的最大几何误差，模型空间距离
+struct MeshLodLevel {
+    std::vector<uint32_t> indices;
+    float error;
+};
+
+// 以 `indices` 为 lod 0，逐级将三角形数减半生成至多 `max_lod_count` 级（含 lod 0），简化无法继续时提前停止
+// 各级共用同一组顶点，可在工作线程上执行
+void generate_primitive_lods(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t max_lod_count,
+                             std::vector<MeshLodLevel> *lods);
+
+// 将 lod 0 划分为 meshlet，并按 meshlet 顺序原地重排 `indices`，每个 meshlet 对应其中一段连续的索引
+// meshlet 的 index_offset 相对于 `indices` 起始，vertex_offset 为 0，合并到 mesh 时再加上 primitive 的偏移
+// 只改变三角形的顺序，不影响已生成的 lod，可在工作线程上执行
+void build_primitive_meshlets(const std::vector<Vertex> &vertices, std::vector<uint32_t> *indices, std::vector<Meshlet> *meshlets);
+
+void accumulate_mesh_optimize_stats(MeshOptimizeStats *total, const MeshOptimizeStats *stats);
+
+// acmr: 每个三角形的平均顶点变换次数；atvr: 顶点变换次数与顶点数之比，1 为最优
+void log_mesh_optimize_stats(const char *name, const MeshOptimizeStats *stats);
@@ -1,6 +1,7 @@
 #include "platform.h"
 #include "app.h"
 #include "core/logging.h"
+#include "core/thread_pool.h"
 #include "event_system.h"
 #include "input_system.h"
 #include <SDL3/SDL.h>
@@ -23,8 +24,10 @@ void platform_init(PlatformContext *platform_context) {
     {
         unsigned int cpu_processors = std::thread::hardware_concurrency();
         log_debug("number of cpu processors: %d", cpu_processors);
+        // 主线程也会参与并行任务，因此工作线程数比 cpu 核数少一个
+        thread_pool_create(cpu_processors > 1 ? cpu_processors - 1 : 0, &platform_context->thread_pool);
     }
-    app_create(platform_context->window, &platform_context->app);
+    app_create(platform_context->window, platform_context->thread_pool, &platform_context->app);
 }
 
 static Key sdl_key_to_key(SDL_Keycode key) {
@@ -81,6 +84,7 @@ void platform_main_loop(PlatformContext *platform_context) {
 
 void platform_terminate(PlatformContext *platform_context) {
     app_destroy(platform_context->app);
+    thread_pool_destroy(platform_context->thread_pool);
     input_system_destroy(platform_context->input_system_state);
     event_system_destroy(platform_context->event_system_state);
     SDL_DestroyWindow(platform_context->window);
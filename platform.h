@@ -4,11 +4,13 @@ struct SDL_Window;
 struct EventSystemState;
 struct InputSystemState;
 struct App;
+struct ThreadPool;
 
 struct PlatformContext {
     SDL_Window *window;
     EventSystemState *event_system_state;
     InputSystemState *input_system_state;
+    ThreadPool *thread_pool;
     App *app;
 };
 
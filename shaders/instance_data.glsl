@@ -0,0 +1,16 @@
+// 需要先 include vertex.glsl，并启用 GL_EXT_buffer_reference
+
+// gpu driven 绘制时每个绘制项的实例数据，与 app.h 中的 InstanceData 对应
+struct InstanceData {
+    mat4 model;
+    VertexBuffer vertex_buffer;
+    PositionBuffer position_buffer; // 可选的位置流，为 0 时从 vertex_buffer 中读取
+    vec4 position_offset; // 压缩顶点的位置还原参数，xyz 有效
+    vec4 position_scale;
+    vec4 bounding_sphere; // 模型空间，xyz 为中心，w 为半径，为负时不做视锥与遮挡剔除
+    int material_index;
+};
+
+layout (buffer_reference, std430, buffer_reference_align = 16) readonly buffer InstanceBuffer {
+    InstanceData instances[];
+};
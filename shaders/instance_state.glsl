@@ -0,0 +1,46 @@
+// 需要先 include vertex.glsl，并启用 GL_EXT_buffer_reference_uvec2
+// 定义 INDIRECT_DRAW 时实例数据从 instance buffer 中按 gl_InstanceIndex 读取，需在 main 的开头调用 load_instance_state
+
+#ifdef INDIRECT_DRAW
+#include "instance_data.glsl"
+
+// 与 app.h 中的 DrawState 对应
+layout (push_constant) uniform DrawState {
+    InstanceBuffer instance_buffer;
+} draw_state;
+
+InstanceData instance_state;
+
+void load_instance_state() {
+    instance_state = draw_state.instance_buffer.instances[gl_InstanceIndex];
+}
+#else
+layout (push_constant) uniform InstanceState {
+    mat4 model;
+    VertexBuffer vertex_buffer; // actually it's a u64 handle
+    PositionBuffer position_buffer; // 可选的位置流，为 0 时从 vertex_buffer 中读取
+    vec4 position_offset; // 压缩顶点的位置还原参数，xyz 有效
+    vec4 position_scale;
+} instance_state;
+
+void load_instance_state() {}
+#endif
+
+Vertex fetch_vertex(uint index) {
+#ifdef PACKED_VERTEX
+    return decode_vertex(instance_state.vertex_buffer.vertices[index], instance_state.position_offset.xyz, instance_state.position_scale.xyz);
+#else
+    return instance_state.vertex_buffer.vertices[index];
+#endif
+}
+
+vec3 fetch_position(uint index) {
+    if (uvec2(instance_state.position_buffer) == uvec2(0)) { return fetch_vertex(index).position; }
+
+    Position position = instance_state.position_buffer.positions[index];
+#ifdef PACKED_VERTEX
+    return decode_position(position.xy, position.z, instance_state.position_offset.xyz, instance_state.position_scale.xyz);
+#else
+    return vec3(position.x, position.y, position.z);
+#endif
+}
@@ -16,8 +16,8 @@ void main() {
     // frag_color = color;
     // frag_color = texture(tex, tex_coord);
 
-    const vec3 base_color = vec3(0.9, 0.9, 0.9);
-    // const vec3 base_color = texture(tex, tex_coord).rgb;
+    // 没有 base color 贴图的材质绑定白色默认贴图
+    const vec3 base_color = vec3(0.9, 0.9, 0.9) * texture(tex, tex_coord).rgb;
     float diffuse = max(dot(normal, global_state.sunlight_dir), 0.0);
     vec4 color = vec4(base_color * diffuse, 1.0);
     frag_color = color;
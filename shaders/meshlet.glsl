@@ -0,0 +1,17 @@
+// 与 mesh_buffer.h 中的 Meshlet 对应，需启用 GL_EXT_buffer_reference
+
+struct Meshlet {
+    vec3 center;
+    float radius;
+    vec3 cone_apex;
+    float cone_cutoff;
+    vec3 cone_axis;
+    uint index_offset; // 相对于 mesh 首个索引，以所属 primitive 的索引类型计
+    uint index_count;
+    uint vertex_offset;
+    uint padding[2];
+};
+
+layout (buffer_reference, std430) readonly buffer MeshletBuffer {
+    Meshlet meshlets[];
+};
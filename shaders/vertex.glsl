@@ -0,0 +1,62 @@
+// 顶点格式与解码，定义 PACKED_VERTEX 时读取压缩顶点（与 mesh_buffer.h 中的 PackedVertex 对应）
+
+struct Vertex {
+    vec3 position;
+    vec2 tex_coord;
+    vec3 normal;
+    vec4 color;
+};
+
+#ifdef PACKED_VERTEX
+struct PackedVertex {
+    uint position_xy; // unorm16x2
+    uint position_z;  // unorm16，高 16 位为填充
+    uint normal;      // 八面体编码，snorm16x2
+    uint tex_coord;   // half2
+    uint color;       // unorm8x4
+};
+
+layout (buffer_reference, std430) readonly buffer VertexBuffer {
+    PackedVertex vertices[];
+};
+
+// 位置流，与 mesh_buffer.h 中的 PackedPosition 对应
+struct Position {
+    uint xy; // unorm16x2
+    uint z;  // unorm16，高 16 位为填充
+};
+
+vec3 decode_position(uint xy, uint z, vec3 position_offset, vec3 position_scale) {
+    return position_offset + vec3(unpackUnorm2x16(xy), unpackUnorm2x16(z).x) * position_scale;
+}
+
+vec3 decode_octahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+Vertex decode_vertex(PackedVertex packed_vertex, vec3 position_offset, vec3 position_scale) {
+    Vertex vertex;
+    vertex.position = decode_position(packed_vertex.position_xy, packed_vertex.position_z, position_offset, position_scale);
+    vertex.tex_coord = unpackHalf2x16(packed_vertex.tex_coord);
+    vertex.normal = decode_octahedral(unpackSnorm2x16(packed_vertex.normal));
+    vertex.color = unpackUnorm4x8(packed_vertex.color);
+    return vertex;
+}
+#else
+layout (buffer_reference, std430) readonly buffer VertexBuffer {
+    Vertex vertices[];
+};
+
+// 位置流，紧密排列的 float3
+struct Position {
+    float x, y, z;
+};
+#endif
+
+layout (buffer_reference, std430) readonly buffer PositionBuffer {
+    Position positions[];
+};
@@ -0,0 +1,187 @@
+#include "core/frame_graph.h"
+#include "core/logging.h"
+#include <cstring>
+
+// 只编译 frame graph 并检查剔除结果与生成的 barrier，不创建 device，也不执行 pass
+
+static int failure_count = 0;
+
+#define CHECK(cond) \
+    if (!(cond)) { \
+        log_error("%s:%d: check failed: %s", __FILE__, __LINE__, STR(cond)); \
+        ++failure_count; \
+    }
+
+struct TestResources {
+    uint32_t color_image;
+    uint32_t depth_image;
+    uint32_t history_image; // 跨帧共用，本帧读取上一帧末尾写入的内容
+    uint32_t debug_image;   // 没有 pass 读取，写入它的 pass 被剔除
+    uint32_t swapchain_image;
+    uint32_t skinned_vertex_buffer;
+    uint32_t draw_command_buffer;
+};
+
+enum TestPass : uint32_t {
+    TEST_PASS_BACKGROUND,
+    TEST_PASS_SKINNING,
+    TEST_PASS_DEBUG_OVERLAY,
+    TEST_PASS_DRAW_COMMANDS,
+    TEST_PASS_SCENE,
+    TEST_PASS_HISTORY_COPY,
+    TEST_PASS_PRESENT_BLIT,
+    TEST_PASS_COUNT,
+};
+
+// 与 app.cc 中 create_frame_graph 的结构相同，另加一个无用的 pass 与一个只输出到下一帧的 pass
+static void create_test_frame_graph(FrameGraph *frame_graph, TestResources *resources) {
+    auto noop = [](VkCommandBuffer) {};
+    resources->color_image = frame_graph_import_image(frame_graph, "color_image", VK_IMAGE_ASPECT_COLOR_BIT, true);
+    resources->depth_image = frame_graph_import_image(frame_graph, "depth_image", VK_IMAGE_ASPECT_DEPTH_BIT, true);
+    resources->history_image = frame_graph_import_image(frame_graph, "history_image", VK_IMAGE_ASPECT_COLOR_BIT, true);
+    resources->debug_image = frame_graph_import_image(frame_graph, "debug_image", VK_IMAGE_ASPECT_COLOR_BIT, false);
+    resources->swapchain_image = frame_graph_import_image(frame_graph, "swapchain_image", VK_IMAGE_ASPECT_COLOR_BIT, false);
+    resources->skinned_vertex_buffer = frame_graph_import_buffer(frame_graph, "skinned_vertex_buffer", false);
+    resources->draw_command_buffer = frame_graph_import_buffer(frame_graph, "draw_command_buffer", false);
+    frame_graph_set_output(frame_graph, resources->swapchain_image, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE,
+                           VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    uint32_t pass = frame_graph_add_pass(frame_graph, "background", noop);
+    frame_graph_write(frame_graph, pass, resources->color_image, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_GENERAL);
+
+    pass = frame_graph_add_pass(frame_graph, "skinning", noop);
+    frame_graph_write(frame_graph, pass, resources->skinned_vertex_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_UNDEFINED);
+
+    pass = frame_graph_add_pass(frame_graph, "debug_overlay", noop);
+    frame_graph_write(frame_graph, pass, resources->debug_image, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_GENERAL);
+
+    pass = frame_graph_add_pass(frame_graph, "draw_commands", noop);
+    frame_graph_write(frame_graph, pass, resources->draw_command_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_UNDEFINED);
+
+    pass = frame_graph_add_pass(frame_graph, "scene", noop);
+    frame_graph_read(frame_graph, pass, resources->skinned_vertex_buffer, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                     VK_IMAGE_LAYOUT_UNDEFINED);
+    frame_graph_read(frame_graph, pass, resources->draw_command_buffer, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                     VK_IMAGE_LAYOUT_UNDEFINED);
+    frame_graph_read(frame_graph, pass, resources->color_image, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT,
+                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    frame_graph_write(frame_graph, pass, resources->color_image, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    frame_graph_write(frame_graph, pass, resources->depth_image, VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                      VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+    frame_graph_read(frame_graph, pass, resources->history_image, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    pass = frame_graph_add_pass(frame_graph, "history_copy", noop);
+    frame_graph_read(frame_graph, pass, resources->color_image, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    frame_graph_write(frame_graph, pass, resources->history_image, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    pass = frame_graph_add_pass(frame_graph, "present_blit", noop);
+    frame_graph_read(frame_graph, pass, resources->color_image, VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    frame_graph_write(frame_graph, pass, resources->swapchain_image, VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+}
+
+// 在 `pass` 之前提交的 batch 中对 `resource` 的 barrier，没有时返回 nullptr
+static const FrameGraphBarrier *find_barrier(const FrameGraph *frame_graph, uint32_t pass, uint32_t resource) {
+    for (const FrameGraphBarrierBatch &batch: frame_graph->batches) {
+        if (batch.pass != pass) { continue; }
+        for (uint32_t i = batch.first_barrier; i < batch.first_barrier + batch.barrier_count; ++i) {
+            if (frame_graph->barriers[i].resource == resource) { return &frame_graph->barriers[i]; }
+        }
+    }
+    return nullptr;
+}
+
+static void check_image_barrier(const FrameGraph *frame_graph, uint32_t pass, uint32_t resource, VkImageLayout old_layout, VkImageLayout new_layout) {
+    const FrameGraphBarrier *barrier = find_barrier(frame_graph, pass, resource);
+    CHECK(barrier != nullptr);
+    if (!barrier) { return; }
+    CHECK(barrier->old_layout == old_layout);
+    CHECK(barrier->new_layout == new_layout);
+}
+
+static void test_culled_passes(const FrameGraph *frame_graph) {
+    for (uint32_t pass = 0; pass < TEST_PASS_COUNT; ++pass) {
+        // 只有 debug_overlay 的输出无人读取；history_copy 的输出在下一帧被读取，不能剔除
+        CHECK(frame_graph->passes[pass].is_culled == (pass == TEST_PASS_DEBUG_OVERLAY));
+    }
+}
+
+static void test_batches(const FrameGraph *frame_graph, const TestResources *resources) {
+    // skinning 与 draw_commands 的 buffer 每帧只写，不需要同步
+    const uint32_t expected_passes[] = {TEST_PASS_BACKGROUND, TEST_PASS_SCENE, TEST_PASS_HISTORY_COPY, TEST_PASS_PRESENT_BLIT, TEST_PASS_COUNT};
+    const uint32_t expected_barrier_counts[] = {1, 5, 2, 2, 1};
+    CHECK(frame_graph->batches.size() == sizeof(expected_passes) / sizeof(expected_passes[0]));
+    for (size_t i = 0; i < frame_graph->batches.size() && i < sizeof(expected_passes) / sizeof(expected_passes[0]); ++i) {
+        CHECK(frame_graph->batches[i].pass == expected_passes[i]);
+        CHECK(frame_graph->batches[i].barrier_count == expected_barrier_counts[i]);
+    }
+
+    // 只写的访问丢弃之前的内容
+    check_image_barrier(frame_graph, TEST_PASS_BACKGROUND, resources->color_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+    check_image_barrier(frame_graph, TEST_PASS_SCENE, resources->color_image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    check_image_barrier(frame_graph, TEST_PASS_SCENE, resources->depth_image, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+    check_image_barrier(frame_graph, TEST_PASS_HISTORY_COPY, resources->color_image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    check_image_barrier(frame_graph, TEST_PASS_HISTORY_COPY, resources->history_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    check_image_barrier(frame_graph, TEST_PASS_PRESENT_BLIT, resources->swapchain_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    check_image_barrier(frame_graph, TEST_PASS_COUNT, resources->swapchain_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    // 同一 image 相同布局的连续读取：只等待上一次布局转换
+    const FrameGraphBarrier *barrier = find_barrier(frame_graph, TEST_PASS_PRESENT_BLIT, resources->color_image);
+    CHECK(barrier != nullptr);
+    if (barrier) {
+        CHECK(barrier->old_layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL && barrier->new_layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        CHECK(barrier->src_stage_mask == VK_PIPELINE_STAGE_2_COPY_BIT);
+        CHECK(barrier->dst_stage_mask == VK_PIPELINE_STAGE_2_BLIT_BIT);
+    }
+
+    barrier = find_barrier(frame_graph, TEST_PASS_SCENE, resources->skinned_vertex_buffer);
+    CHECK(barrier != nullptr);
+    if (barrier) {
+        CHECK(barrier->src_stage_mask == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT && barrier->src_access_mask == VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+        CHECK(barrier->dst_stage_mask == VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT && barrier->dst_access_mask == VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+    }
+}
+
+static void test_persistent_image(const FrameGraph *frame_graph, const TestResources *resources) {
+    // 本帧首次读取 history 时等待上一帧 history_copy 的写入，并从其布局转换，而不是从 UNDEFINED 丢弃
+    const FrameGraphBarrier *barrier = find_barrier(frame_graph, TEST_PASS_SCENE, resources->history_image);
+    CHECK(barrier != nullptr);
+    if (!barrier) { return; }
+    CHECK(barrier->old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    CHECK(barrier->new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    CHECK(barrier->src_stage_mask == VK_PIPELINE_STAGE_2_COPY_BIT);
+    CHECK(barrier->src_access_mask == VK_ACCESS_2_TRANSFER_WRITE_BIT);
+    CHECK(barrier->dst_stage_mask == VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+    CHECK(barrier->dst_access_mask == VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+}
+
+int main() {
+    FrameGraph *frame_graph;
+    frame_graph_create(&frame_graph);
+    TestResources resources{};
+    create_test_frame_graph(frame_graph, &resources);
+    frame_graph_compile(frame_graph);
+
+    test_culled_passes(frame_graph);
+    test_batches(frame_graph, &resources);
+    test_persistent_image(frame_graph, &resources);
+
+    frame_graph_destroy(frame_graph);
+    if (failure_count > 0) {
+        log_error("frame graph test: %d checks failed", failure_count);
+        return 1;
+    }
+    log_info("frame graph test: passed");
+    return 0;
+}
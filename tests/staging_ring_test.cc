@@ -0,0 +1,95 @@
+#include "core/logging.h"
+#include "core/staging_ring.h"
+
+// 只检查 upload engine 所用 staging ring 的位置计算，不创建 device
+
+static int failure_count = 0;
+
+#define CHECK(cond) \
+    if (!(cond)) { \
+        log_error("%s:%d: check failed: %s", __FILE__, __LINE__, STR(cond)); \
+        ++failure_count; \
+    }
+
+#define MB (1024ull * 1024ull)
+
+static StagingRing create_test_ring(uint64_t capacity) {
+    StagingRing ring{};
+    ring.capacity = capacity;
+    ring.alignment = 16;
+    return ring;
+}
+
+// 分配并返回实际偏移，空间不足时不分配并返回 UINT64_MAX
+static uint64_t allocate(StagingRing *ring, size_t size) {
+    uint64_t head = staging_ring_get_allocation_head(ring, size);
+    if (!staging_ring_can_allocate(ring, head, size)) { return UINT64_MAX; }
+    return staging_ring_allocate(ring, head, size);
+}
+
+static void test_alignment() {
+    StagingRing ring = create_test_ring(1024);
+    CHECK(allocate(&ring, 10) == 0);
+    CHECK(allocate(&ring, 10) == 16);
+    CHECK(ring.head == 26);
+}
+
+// ring 回收完毕后，需要跳到开头的大块上传不再等待已经不存在的批次
+static void test_wrap_after_drain() {
+    StagingRing ring = create_test_ring(64 * MB);
+    CHECK(allocate(&ring, 30 * MB) == 0);
+    uint64_t batch_end = ring.head;
+    CHECK(allocate(&ring, 40 * MB) == UINT64_MAX);
+
+    staging_ring_release(&ring, batch_end);
+    CHECK(allocate(&ring, 40 * MB) == 0);
+    CHECK(ring.head - ring.tail == 40 * MB);
+
+    // 之后的分配紧接其后，只需要等待这 40 MB 回收
+    CHECK(allocate(&ring, 20 * MB) == 40 * MB);
+    CHECK(allocate(&ring, 10 * MB) == UINT64_MAX);
+    staging_ring_release(&ring, ring.head);
+    CHECK(allocate(&ring, 10 * MB) == 0);
+}
+
+// 跳到开头时，只有与尚未回收的数据重叠才需要等待
+static void test_wrap_with_data_in_flight() {
+    StagingRing ring = create_test_ring(100 * 16);
+    CHECK(allocate(&ring, 60 * 16) == 0);
+    uint64_t first_end = ring.head;
+    CHECK(allocate(&ring, 30 * 16) == 60 * 16);
+    uint64_t second_end = ring.head;
+    CHECK(allocate(&ring, 20 * 16) == UINT64_MAX);
+
+    staging_ring_release(&ring, first_end);
+    CHECK(allocate(&ring, 40 * 16) == 0);
+    CHECK(allocate(&ring, 30 * 16) == UINT64_MAX); // 与第二次分配重叠
+    staging_ring_release(&ring, second_end);
+    CHECK(allocate(&ring, 30 * 16) == 40 * 16);
+}
+
+// ring 为空时 tail 跟随 head 前移，之后完成的、只使用独立 staging buffer 的批次不会让 tail 后退
+static void test_release_behind_tail() {
+    StagingRing ring = create_test_ring(64 * MB);
+    CHECK(allocate(&ring, 30 * MB) == 0);
+    uint64_t dedicated_batch_end = ring.head;
+    staging_ring_release(&ring, ring.head);
+    CHECK(allocate(&ring, 40 * MB) == 0);
+    uint64_t tail = ring.tail;
+    staging_ring_release(&ring, dedicated_batch_end);
+    CHECK(ring.tail == tail);
+}
+
+int main() {
+    test_alignment();
+    test_wrap_after_drain();
+    test_wrap_with_data_in_flight();
+    test_release_behind_tail();
+
+    if (failure_count > 0) {
+        log_error("staging ring test: %d checks failed", failure_count);
+        return 1;
+    }
+    log_info("staging ring test: passed");
+    return 0;
+}
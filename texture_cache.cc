@@ -0,0 +1,121 @@
+#include "texture_cache.h"
+#include "core/logging.h"
+#include "core/mapped_file.h"
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#define TEXTURE_CACHE_MAGIC 0x52584554 // "TEXR"
+#define TEXTURE_CACHE_FORMAT_VERSION 1 // 烘焙结果或文件布局变化时递增
+
+// 文件布局：header | level 表 | 各层 mip 数据
+struct TextureCacheHeader {
+    uint32_t magic;
+    uint32_t format_version;
+    uint32_t cook_flags;
+    uint32_t usage;
+    uint64_t source_hash;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t level_count;
+    uint64_t data_size;
+};
+
+static std::string get_cache_filepath(uint64_t source_hash, TextureUsage usage, uint32_t cook_flags) {
+    char filename[64];
+    snprintf(filename, sizeof(filename), "%016llx-%u-%x.tex", (unsigned long long) source_hash, usage, cook_flags);
+    return (std::filesystem::path(TEXTURE_CACHE_DIRECTORY) / filename).string();
+}
+
+static bool validate_cache(uint32_t cook_flags, const ImportedTexture *imported_texture, const MappedFile *mapped_file) {
+    if (mapped_file->size < sizeof(TextureCacheHeader)) { return false; }
+
+    const TextureCacheHeader *header = (const TextureCacheHeader *) mapped_file->data;
+    if (header->magic != TEXTURE_CACHE_MAGIC || header->format_version != TEXTURE_CACHE_FORMAT_VERSION || header->cook_flags != cook_flags ||
+        header->usage != imported_texture->usage || header->source_hash != imported_texture->source_hash || header->level_count == 0 ||
+        header->level_count > TEXTURE_MAX_LEVEL_COUNT) {
+        return false;
+    }
+
+    size_t data_offset = sizeof(TextureCacheHeader) + header->level_count * sizeof(TextureLevel);
+    if (mapped_file->size < data_offset || mapped_file->size - data_offset < header->data_size) { return false; }
+
+    const TextureLevel *levels = (const TextureLevel *) (header + 1);
+    for (uint32_t i = 0; i < header->level_count; ++i) {
+        if (levels[i].offset + levels[i].size > header->data_size) { return false; }
+    }
+    return true;
+}
+
+bool texture_cache_load(uint32_t cook_flags, ImportedTexture *imported_texture) {
+    std::string cache_filepath = get_cache_filepath(imported_texture->source_hash, imported_texture->usage, cook_flags);
+    MappedFile mapped_file;
+    if (!map_file(cache_filepath.c_str(), &mapped_file)) { return false; }
+
+    if (!validate_cache(cook_flags, imported_texture, &mapped_file)) {
+        log_warning("texture cache %s is stale or corrupted", cache_filepath.c_str());
+        unmap_file(&mapped_file);
+        return false;
+    }
+
+    const TextureCacheHeader *header = (const TextureCacheHeader *) mapped_file.data;
+    const TextureLevel *levels = (const TextureLevel *) (header + 1);
+    const uint8_t *data = (const uint8_t *) (levels + header->level_count);
+
+    imported_texture->format = (VkFormat) header->format;
+    imported_texture->width = header->width;
+    imported_texture->height = header->height;
+    imported_texture->level_count = header->level_count;
+    memcpy(imported_texture->levels, levels, header->level_count * sizeof(TextureLevel));
+    imported_texture->data.assign(data, data + header->data_size);
+
+    unmap_file(&mapped_file);
+    return true;
+}
+
+void texture_cache_write(uint32_t cook_flags, const ImportedTexture *imported_texture) {
+    TextureCacheHeader header{};
+    header.magic = TEXTURE_CACHE_MAGIC;
+    header.format_version = TEXTURE_CACHE_FORMAT_VERSION;
+    header.cook_flags = cook_flags;
+    header.usage = imported_texture->usage;
+    header.source_hash = imported_texture->source_hash;
+    header.format = imported_texture->format;
+    header.width = imported_texture->width;
+    header.height = imported_texture->height;
+    header.level_count = imported_texture->level_count;
+    header.data_size = imported_texture->data.size();
+
+    std::error_code error_code;
+    std::filesystem::create_directories(TEXTURE_CACHE_DIRECTORY, error_code);
+
+    // 先写临时文件再重命名，避免进程中断留下不完整的缓存；多个工作线程可能同时烘焙同一张图片，临时文件名中带上线程 id
+    std::string cache_filepath = get_cache_filepath(imported_texture->source_hash, imported_texture->usage, cook_flags);
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%zx.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::string temp_filepath = cache_filepath + suffix;
+    FILE *file = fopen(temp_filepath.c_str(), "wb");
+    if (!file) {
+        log_warning("failed to create texture cache %s", temp_filepath.c_str());
+        return;
+    }
+
+    fwrite(&header, 1, sizeof(header), file);
+    fwrite(imported_texture->levels, 1, imported_texture->level_count * sizeof(TextureLevel), file);
+    fwrite(imported_texture->data.data(), 1, imported_texture->data.size(), file);
+
+    bool is_ok = ferror(file) == 0;
+    is_ok = fclose(file) == 0 && is_ok;
+    if (!is_ok) {
+        log_warning("failed to write texture cache %s", temp_filepath.c_str());
+        std::filesystem::remove(temp_filepath, error_code);
+        return;
+    }
+
+    std::filesystem::rename(temp_filepath, cache_filepath, error_code);
+    if (error_code) {
+        log_warning("failed to rename texture cache %s: %s", temp_filepath.c_str(), error_code.message().c_str());
+        std::filesystem::remove(temp_filepath, error_code);
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "texture_import.h"
+
+// 烘焙后的贴图缓存目录，相对于工作目录
+#define TEXTURE_CACHE_DIRECTORY "cache/textures"
+
+// `cook_flags` 为影响烘焙结果的选项，不同选项的结果分别缓存；`imported_texture` 的 source_hash 与 usage 需已设置
+// 命中时从映射的缓存文件中读出所有 mip 并返回 true，不访问 gpu，可在工作线程上执行
+bool texture_cache_load(uint32_t cook_flags, ImportedTexture *imported_texture);
+
+void texture_cache_write(uint32_t cook_flags, const ImportedTexture *imported_texture);
@@ -0,0 +1,267 @@
+#include "texture_import.h"
+#include "texture_cache.h"
+#include "vk_context.h"
+#include "vk_image.h"
+#include "vk_image_view.h"
+#include "core/hash.h"
+#include "core/logging.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <glm/glm.hpp>
+
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
+
+#define TEXTURE_COOK_VERSION 2 // mip 生成或编码方式变化时递增
+
+// 影响烘焙结果的选项，参与缓存 key
+static uint32_t get_cook_flags(bool compress) { return TEXTURE_COOK_VERSION << 8 | (compress ? 1u : 0u); }
+
+static VkFormat select_format(TextureUsage usage, bool compress, bool has_alpha) {
+    if (usage == TEXTURE_USAGE_NORMAL) { return compress ? VK_FORMAT_BC5_UNORM_BLOCK : VK_FORMAT_R8G8_UNORM; }
+    if (!compress) { return VK_FORMAT_R8G8B8A8_SRGB; }
+    return has_alpha ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+}
+
+static const float *get_srgb_to_linear_table() {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> values{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            float value = i / 255.0f;
+            values[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+static uint8_t linear_to_srgb(float value) {
+    value = std::clamp(value, 0.0f, 1.0f);
+    value = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    return (uint8_t) (value * 255.0f + 0.5f);
+}
+
+static float decode_snorm8(uint8_t value) { return value / 127.5f - 1.0f; }
+
+static uint8_t encode_snorm8(float value) { return (uint8_t) (std::clamp(value * 0.5f + 0.5f, 0.0f, 1.0f) * 255.0f + 0.5f); }
+
+// 2x2 盒式滤波生成下一层 mip，奇数边长时最后一列（行）重复采样
+// 颜色在线性空间中平均；法线先重建 z 再平均并归一化
+static void downsample_level(const uint8_t *src, uint32_t src_width, uint32_t src_height, TextureUsage usage, uint8_t *dst, uint32_t dst_width,
+                             uint32_t dst_height) {
+    const float *srgb_to_linear = get_srgb_to_linear_table();
+    for (uint32_t y = 0; y < dst_height; ++y) {
+        uint32_t y0 = std::min(y * 2, src_height - 1), y1 = std::min(y * 2 + 1, src_height - 1);
+        for (uint32_t x = 0; x < dst_width; ++x) {
+            uint32_t x0 = std::min(x * 2, src_width - 1), x1 = std::min(x * 2 + 1, src_width - 1);
+            const uint8_t *texels[4] = {src + ((size_t) y0 * src_width + x0) * 4, src + ((size_t) y0 * src_width + x1) * 4,
+                                        src + ((size_t) y1 * src_width + x0) * 4, src + ((size_t) y1 * src_width + x1) * 4};
+            uint8_t *out = dst + ((size_t) y * dst_width + x) * 4;
+
+            if (usage == TEXTURE_USAGE_NORMAL) {
+                glm::vec3 normal(0.0f);
+                for (const uint8_t *texel: texels) {
+                    float nx = decode_snorm8(texel[0]), ny = decode_snorm8(texel[1]);
+                    normal += glm::vec3(nx, ny, std::sqrt(std::max(0.0f, 1.0f - nx * nx - ny * ny)));
+                }
+                float length = glm::length(normal);
+                normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+                out[0] = encode_snorm8(normal.x);
+                out[1] = encode_snorm8(normal.y);
+                out[2] = encode_snorm8(normal.z);
+                out[3] = 255;
+            } else {
+                for (uint32_t channel = 0; channel < 3; ++channel) {
+                    float sum = 0.0f;
+                    for (const uint8_t *texel: texels) { sum += srgb_to_linear[texel[channel]]; }
+                    out[channel] = linear_to_srgb(sum * 0.25f);
+                }
+                out[3] = (uint8_t) ((texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3] + 2) / 4);
+            }
+        }
+    }
+}
+
+// 将 rgba8 的一层 mip 编码为 `format`，块压缩格式按块行并行编码
+static void encode_level(ThreadPool *thread_pool, const uint8_t *rgba, uint32_t width, uint32_t height, VkFormat format, uint8_t *dst) {
+    if (format == VK_FORMAT_R8G8B8A8_SRGB) {
+        memcpy(dst, rgba, (size_t) width * height * 4);
+        return;
+    }
+    if (format == VK_FORMAT_R8G8_UNORM) {
+        for (size_t i = 0; i < (size_t) width * height; ++i) {
+            dst[i * 2 + 0] = rgba[i * 4 + 0];
+            dst[i * 2 + 1] = rgba[i * 4 + 1];
+        }
+        return;
+    }
+
+    ImageFormatBlock block = vk_get_format_block(format);
+    uint32_t block_count_x = (width + 3) / 4, block_count_y = (height + 3) / 4;
+    thread_pool_parallel_for(thread_pool, block_count_y, [&](uint32_t block_y) {
+        uint8_t block_rgba[16 * 4];
+        uint8_t block_rg[16 * 2];
+        for (uint32_t block_x = 0; block_x < block_count_x; ++block_x) {
+            // 边缘不足 4x4 的块重复最后一列（行）的纹素
+            for (uint32_t i = 0; i < 16; ++i) {
+                uint32_t x = std::min(block_x * 4 + i % 4, width - 1), y = std::min(block_y * 4 + i / 4, height - 1);
+                memcpy(&block_rgba[i * 4], &rgba[((size_t) y * width + x) * 4], 4);
+                block_rg[i * 2 + 0] = block_rgba[i * 4 + 0];
+                block_rg[i * 2 + 1] = block_rgba[i * 4 + 1];
+            }
+
+            uint8_t *out = dst + ((size_t) block_y * block_count_x + block_x) * block.size;
+            if (format == VK_FORMAT_BC5_UNORM_BLOCK) {
+                stb_compress_bc5_block(out, block_rg);
+            } else {
+                stb_compress_dxt_block(out, block_rgba, format == VK_FORMAT_BC3_SRGB_BLOCK ? 1 : 0, STB_DXT_HIGHQUAL);
+            }
+        }
+    });
+}
+
+bool import_texture(ThreadPool *thread_pool, const uint8_t *encoded_data, size_t encoded_size, TextureUsage usage, bool compress,
+                    ImportedTexture *imported_texture) {
+    imported_texture->source_hash = hash_bytes(encoded_data, encoded_size);
+    imported_texture->usage = usage;
+    imported_texture->level_count = 0;
+    imported_texture->data.clear();
+
+    uint32_t cook_flags = get_cook_flags(compress);
+    if (texture_cache_load(cook_flags, imported_texture)) { return true; }
+
+    int width, height, channel_count;
+    stbi_uc *pixels = stbi_load_from_memory(encoded_data, (int) encoded_size, &width, &height, &channel_count, 4);
+    if (!pixels) {
+        log_error("failed to decode image: %s", stbi_failure_reason());
+        imported_texture->source_hash = 0;
+        return false;
+    }
+
+    uint32_t level_count = vk_get_mip_level_count(width, height);
+    if (level_count > TEXTURE_MAX_LEVEL_COUNT) {
+        log_error("image %dx%d exceeds the maximum texture size", width, height);
+        stbi_image_free(pixels);
+        imported_texture->source_hash = 0;
+        return false;
+    }
+
+    bool has_alpha = false;
+    for (size_t i = 0; i < (size_t) width * height && !has_alpha; ++i) { has_alpha = pixels[i * 4 + 3] != 255; }
+
+    // 未压缩的颜色贴图只烘焙第 0 层，其余 mip 上传时在 gpu 上 blit 生成（srgb 格式在线性空间中过滤）
+    // 块压缩格式不能作为 blit 目标，法线需要重新归一化，这两类在 cpu 上生成完整的 mip 链
+    VkFormat format = select_format(usage, compress, has_alpha);
+    if (format == VK_FORMAT_R8G8B8A8_SRGB) { level_count = 1; }
+    imported_texture->format = format;
+    imported_texture->width = width;
+    imported_texture->height = height;
+    imported_texture->level_count = level_count;
+
+    uint64_t data_size = 0;
+    for (uint32_t level = 0; level < level_count; ++level) {
+        TextureLevel *texture_level = &imported_texture->levels[level];
+        texture_level->width = std::max((uint32_t) width >> level, 1u);
+        texture_level->height = std::max((uint32_t) height >> level, 1u);
+        texture_level->offset = data_size;
+        texture_level->size = vk_get_image_level_size(format, texture_level->width, texture_level->height);
+        data_size += texture_level->size;
+    }
+    imported_texture->data.resize(data_size);
+
+    std::vector<uint8_t> level_pixels(pixels, pixels + (size_t) width * height * 4), next_level_pixels;
+    stbi_image_free(pixels);
+    for (uint32_t level = 0; level < level_count; ++level) {
+        const TextureLevel *texture_level = &imported_texture->levels[level];
+        encode_level(thread_pool, level_pixels.data(), texture_level->width, texture_level->height, format,
+                     imported_texture->data.data() + texture_level->offset);
+        if (level + 1 < level_count) {
+            const TextureLevel *next_level = &imported_texture->levels[level + 1];
+            next_level_pixels.resize((size_t) next_level->width * next_level->height * 4);
+            downsample_level(level_pixels.data(), texture_level->width, texture_level->height, usage, next_level_pixels.data(), next_level->width,
+                             next_level->height);
+            level_pixels.swap(next_level_pixels);
+        }
+    }
+
+    texture_cache_write(cook_flags, imported_texture);
+    return true;
+}
+
+bool load_cached_texture(bool compress, ImportedTexture *imported_texture) {
+    return texture_cache_load(get_cook_flags(compress), imported_texture);
+}
+
+// 烘焙了完整 mip 链时，边长不超过 TEXTURE_TAIL_SIZE 的第一层；否则为 0，即整个贴图常驻
+static uint32_t get_tail_level(const ImportedTexture *imported_texture) {
+    if (imported_texture->level_count != vk_get_mip_level_count(imported_texture->width, imported_texture->height)) { return 0; }
+    uint32_t level = 0;
+    while (std::max(imported_texture->levels[level].width, imported_texture->levels[level].height) > TEXTURE_TAIL_SIZE) { ++level; }
+    return level;
+}
+
+// 从 `first_level` 开始的各层在 data 中连续存放到末尾，一次上传；烘焙的层数不足时其余各层在 gpu 上生成
+static UploadToken create_texture_image(UploadEngine *upload_engine, const ImportedTexture *imported_texture, uint32_t first_level, Image **out_image,
+                                        VkImageView *out_image_view) {
+    VkContext *vk_context = upload_engine->vk_context;
+    const TextureLevel *level = &imported_texture->levels[first_level];
+    vk_create_image(vk_context, level->width, level->height, imported_texture->format, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, true,
+                    out_image);
+    vk_create_image_view(vk_context->device, (*out_image)->image, imported_texture->format, VK_IMAGE_ASPECT_COLOR_BIT, (*out_image)->mip_levels,
+                         out_image_view);
+    return upload_image(upload_engine, *out_image, imported_texture->format, level->width, level->height, imported_texture->level_count - first_level,
+                        imported_texture->data.data() + level->offset, imported_texture->data.size() - level->offset);
+}
+
+void create_imported_texture(UploadEngine *upload_engine, ImportedTexture *imported_texture, Texture *texture) {
+    *texture = {};
+    if (imported_texture->level_count == 0) { return; }
+
+    texture->format = imported_texture->format;
+    texture->width = imported_texture->width;
+    texture->height = imported_texture->height;
+    texture->level_count = vk_get_mip_level_count(texture->width, texture->height);
+    texture->tail_level = get_tail_level(imported_texture);
+    texture->resident_level = texture->tail_level;
+    texture->resident_bytes = get_texture_levels_size(texture, texture->resident_level);
+    texture->upload_token = create_texture_image(upload_engine, imported_texture, texture->resident_level, &texture->image, &texture->image_view);
+    if (texture->tail_level > 0) { texture->source = std::move(*imported_texture); }
+}
+
+size_t get_imported_texture_size(const ImportedTexture *imported_texture) {
+    return imported_texture->data.size() - imported_texture->levels[get_tail_level(imported_texture)].offset;
+}
+
+UploadToken create_texture_levels(UploadEngine *upload_engine, const Texture *texture, uint32_t first_level, Image **out_image,
+                                  VkImageView *out_image_view) {
+    ASSERT(is_texture_streamed(texture) && first_level < texture->source.level_count);
+    return create_texture_image(upload_engine, &texture->source, first_level, out_image, out_image_view);
+}
+
+uint64_t get_texture_levels_size(const Texture *texture, uint32_t first_level) {
+    uint64_t size = 0;
+    for (uint32_t level = first_level; level < texture->level_count; ++level) {
+        size += vk_get_image_level_size(texture->format, std::max(texture->width >> level, 1u), std::max(texture->height >> level, 1u));
+    }
+    return size;
+}
+
+bool is_texture_streamed(const Texture *texture) { return texture->tail_level > 0; }
+
+void destroy_texture(VkContext *vk_context, Texture *texture) {
+    if (!texture->image) { return; }
+    if (texture->pending_image) {
+        vk_destroy_image_view(vk_context->device, texture->pending_image_view);
+        vk_destroy_image(vk_context, texture->pending_image);
+    }
+    vk_destroy_image_view(vk_context->device, texture->image_view);
+    vk_destroy_image(vk_context, texture->image);
+    *texture = {};
+}
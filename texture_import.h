@@ -0,0 +1,85 @@
+#pragma once
+
+#include "upload_engine.h"
+#include <cstdint>
+#include <vector>
+#include <volk.h>
+
+struct Image;
+struct ThreadPool;
+
+#define TEXTURE_MAX_LEVEL_COUNT 16 // 最大 32768x32768
+#define TEXTURE_TAIL_SIZE 64 // 边长不超过该值的 mip 始终常驻，创建贴图时即上传，更精细的 mip 由 TextureStreamer 按需上传
+
+enum TextureUsage : uint32_t {
+    TEXTURE_USAGE_COLOR,  // srgb 颜色，压缩为 BC1（不透明）或 BC3（含 alpha）
+    TEXTURE_USAGE_NORMAL, // 切线空间法线，只保留 xy，压缩为 BC5，着色时重建 z
+};
+
+// 一层 mip 在 ImportedTexture::data 中的范围
+struct TextureLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// 烘焙完成、尚未上传的贴图，各层 mip 按 `format` 紧密排列，可直接拷入 staging
+struct ImportedTexture {
+    uint64_t source_hash; // 编码的图片数据（png/jpeg）的哈希，与 usage 一起作为缓存 key，为 0 时表示导入失败
+    TextureUsage usage;
+    VkFormat format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t level_count; // 烘焙的 mip 层数，少于完整 mip 链时其余各层上传时在 gpu 上生成
+    TextureLevel levels[TEXTURE_MAX_LEVEL_COUNT];
+    std::vector<uint8_t> data;
+};
+
+struct Texture {
+    Image *image; // 只包含从 resident_level 开始的各层 mip；为 nullptr 时表示尚未创建或导入失败，绘制时使用默认贴图
+    VkImageView image_view;
+    VkFormat format;
+    uint32_t width; // 第 0 层的尺寸
+    uint32_t height;
+    uint32_t level_count; // 完整 mip 链的层数
+    UploadToken upload_token;
+
+    // 流式加载，见 texture_streamer.h
+    ImportedTexture source; // 保留在内存中的烘焙数据，按需上传更精细的 mip；不参与流式加载的贴图为空
+    uint32_t resident_level; // image 第 0 层对应的 mip，越小越精细
+    uint32_t tail_level; // 始终常驻的最精细一层，驱逐不会越过该层；不参与流式加载的贴图为 0
+    uint32_t requested_level; // last_used_frame 那一帧绘制需要的最精细一层
+    uint64_t last_used_frame;
+    uint64_t resident_bytes;
+    Image *pending_image; // 正在上传的新 image，上传可用后替换 image
+    VkImageView pending_image_view;
+    uint32_t pending_level;
+    UploadToken pending_upload_token;
+};
+
+// cpu 阶段：解码 png/jpeg，`compress` 为 true 时编码为块压缩格式并生成完整的 mip 链，否则保留 8 位未压缩格式
+// 结果按图片数据的哈希缓存，命中时跳过解码；不访问 gpu，可在工作线程上执行，`thread_pool` 用于并行编码，可以为 nullptr
+bool import_texture(ThreadPool *thread_pool, const uint8_t *encoded_data, size_t encoded_size, TextureUsage usage, bool compress,
+                    ImportedTexture *imported_texture);
+
+// 只从缓存读取，`imported_texture` 的 source_hash 与 usage 需已设置，未命中时返回 false
+bool load_cached_texture(bool compress, ImportedTexture *imported_texture);
+
+// gpu 阶段：创建 image 并录制上传，只能在 upload engine 所属的线程上调用，导入失败的贴图保持为空
+// 烘焙了完整 mip 链且大于 TEXTURE_TAIL_SIZE 的贴图只上传常驻的末尾几层，烘焙数据移入 texture->source 供流式加载；其余贴图完整常驻
+void create_imported_texture(UploadEngine *upload_engine, ImportedTexture *imported_texture, Texture *texture);
+
+// 创建贴图时需要拷入 staging 的字节数
+size_t get_imported_texture_size(const ImportedTexture *imported_texture);
+
+// 创建只包含从 `first_level` 开始各层 mip 的 image 并录制上传，数据取自 texture->source
+UploadToken create_texture_levels(UploadEngine *upload_engine, const Texture *texture, uint32_t first_level, Image **out_image,
+                                  VkImageView *out_image_view);
+
+// 从 `first_level` 开始的各层 mip 在显存中的字节数
+uint64_t get_texture_levels_size(const Texture *texture, uint32_t first_level);
+
+bool is_texture_streamed(const Texture *texture);
+
+void destroy_texture(VkContext *vk_context, Texture *texture);
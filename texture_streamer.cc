@@ -0,0 +1,211 @@
+#include "texture_streamer.h"
+#include "mesh_loader.h"
+#include "vk_context.h"
+#include "vk_image.h"
+#include "vk_image_view.h"
+#include "core/logging.h"
+#include <algorithm>
+
+#define TEXTURE_STREAMER_HEAP_HEADROOM 0.1 // 保留 device local heap 预算的比例给贴图以外的分配（render target、新导入的 mesh 等）
+
+void texture_streamer_create(VkContext *vk_context, UploadEngine *upload_engine, uint64_t budget_cap_bytes, uint64_t upload_budget_bytes,
+                             uint32_t frames_in_flight, TextureStreamer **out_texture_streamer) {
+    TextureStreamer *texture_streamer = new TextureStreamer();
+    texture_streamer->vk_context = vk_context;
+    texture_streamer->upload_engine = upload_engine;
+    texture_streamer->budget_cap_bytes = budget_cap_bytes;
+    texture_streamer->upload_budget_bytes = upload_budget_bytes;
+    texture_streamer->frames_in_flight = frames_in_flight;
+    *out_texture_streamer = texture_streamer;
+}
+
+void texture_streamer_destroy(TextureStreamer *texture_streamer) {
+    for (const RetiredTextureImage &retired_image: texture_streamer->retired_images) {
+        vk_destroy_image_view(texture_streamer->vk_context->device, retired_image.image_view);
+        vk_destroy_image(texture_streamer->vk_context, retired_image.image);
+    }
+    delete texture_streamer;
+}
+
+void request_texture_level(Texture *texture, uint32_t level, uint64_t frame_number) {
+    texture->requested_level = texture->last_used_frame == frame_number ? std::min(texture->requested_level, level) : level;
+    texture->last_used_frame = frame_number;
+}
+
+// 正在上传时按上传完成后的层数计算
+static uint64_t get_committed_bytes(const Texture *texture) {
+    return texture->pending_image ? get_texture_levels_size(texture, texture->pending_level) : texture->resident_bytes;
+}
+
+// 所有贴图可以占用的显存：配置的上限，以及贴图已占用的加上 device local heap 剩余的预算（扣除保留部分）中较小者
+static uint64_t get_texture_budget(const TextureStreamer *texture_streamer, uint64_t committed_bytes) {
+    if (!texture_streamer->vk_context->is_memory_budget_supported) { return texture_streamer->budget_cap_bytes; }
+
+    const VkPhysicalDeviceMemoryProperties *memory_properties;
+    vmaGetMemoryProperties(texture_streamer->vk_context->allocator, &memory_properties);
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(texture_streamer->vk_context->allocator, budgets);
+
+    uint64_t heap_budget = 0, heap_usage = 0;
+    for (uint32_t i = 0; i < memory_properties->memoryHeapCount; ++i) {
+        if (!(memory_properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) { continue; }
+        heap_budget += budgets[i].budget;
+        heap_usage += budgets[i].usage;
+    }
+    uint64_t reserved_bytes = heap_usage + (uint64_t) (heap_budget * TEXTURE_STREAMER_HEAP_HEADROOM);
+    uint64_t available_bytes = heap_budget > reserved_bytes ? heap_budget - reserved_bytes : 0;
+    return std::min(texture_streamer->budget_cap_bytes, committed_bytes + available_bytes);
+}
+
+// 从 `level` 开始的各层需要拷入 staging 的字节数
+static uint64_t get_levels_upload_size(const Texture *texture, uint32_t level) {
+    return texture->source.data.size() - texture->source.levels[level].offset;
+}
+
+static uint64_t set_pending_level(TextureStreamer *texture_streamer, Texture *texture, uint32_t level) {
+    texture->pending_level = level;
+    texture->pending_upload_token = create_texture_levels(texture_streamer->upload_engine, texture, level, &texture->pending_image,
+                                                          &texture->pending_image_view);
+    uint64_t size = get_levels_upload_size(texture, level);
+    texture_streamer->stats.bytes_uploaded += size;
+    return size;
+}
+
+void texture_streamer_update(TextureStreamer *texture_streamer, Geometry *geometry, uint64_t frame_number) {
+    VkContext *vk_context = texture_streamer->vk_context;
+
+    // 替换上传已可用的 image，旧的 image 可能仍被之前的帧使用
+    for (Texture &texture: geometry->textures) {
+        if (!texture.pending_image || !upload_engine_is_available(texture_streamer->upload_engine, texture.pending_upload_token)) { continue; }
+        texture_streamer->retired_images.push_back({texture.image, texture.image_view, frame_number, texture.resident_bytes});
+        texture.image = texture.pending_image;
+        texture.image_view = texture.pending_image_view;
+        texture.upload_token = texture.pending_upload_token;
+        texture.resident_level = texture.pending_level;
+        texture.resident_bytes = get_texture_levels_size(&texture, texture.resident_level);
+        texture.pending_image = nullptr;
+        texture.pending_image_view = VK_NULL_HANDLE;
+    }
+
+    // 调用前已等待本帧的 fence，frames_in_flight 帧之前替换的 image 不再被使用
+    // committed_bytes 为替换完成后的占用，transient_bytes 为替换前后新旧 image 同时存在的额外占用
+    std::vector<RetiredTextureImage> &retired_images = texture_streamer->retired_images;
+    size_t retired_count = 0;
+    uint64_t transient_bytes = 0;
+    for (const RetiredTextureImage &retired_image: retired_images) {
+        if (retired_image.retire_frame + texture_streamer->frames_in_flight > frame_number) {
+            retired_images[retired_count++] = retired_image;
+            transient_bytes += retired_image.bytes;
+            continue;
+        }
+        vk_destroy_image_view(vk_context->device, retired_image.image_view);
+        vk_destroy_image(vk_context, retired_image.image);
+    }
+    retired_images.resize(retired_count);
+
+    uint64_t committed_bytes = 0;
+    std::vector<Texture *> requested_textures; // 需要更精细 mip 的贴图
+    std::vector<Texture *> evictable_textures; // 本帧不需要其最精细一层的贴图
+    for (Texture &texture: geometry->textures) {
+        if (!texture.image) { continue; }
+        committed_bytes += get_committed_bytes(&texture);
+        if (texture.pending_image) { transient_bytes += texture.resident_bytes; }
+        if (!is_texture_streamed(&texture) || texture.pending_image) { continue; }
+        bool is_used = texture.last_used_frame == frame_number;
+        if (is_used && texture.requested_level < texture.resident_level) {
+            requested_textures.push_back(&texture);
+        } else if (texture.resident_level < texture.tail_level && (!is_used || texture.resident_level < texture.requested_level)) {
+            evictable_textures.push_back(&texture);
+        }
+    }
+    uint64_t budget_bytes = get_texture_budget(texture_streamer, committed_bytes + transient_bytes);
+
+    // 与请求相差最多的先上传，越模糊越优先；最久未使用的先驱逐，相同时先驱逐更精细的
+    std::sort(requested_textures.begin(), requested_textures.end(), [](const Texture *a, const Texture *b) {
+        return a->resident_level - a->requested_level > b->resident_level - b->requested_level;
+    });
+    std::sort(evictable_textures.begin(), evictable_textures.end(), [](const Texture *a, const Texture *b) {
+        if (a->last_used_frame != b->last_used_frame) { return a->last_used_frame < b->last_used_frame; }
+        return a->resident_level < b->resident_level;
+    });
+
+    uint64_t upload_bytes = 0;
+    auto is_upload_budget_exceeded = [&](uint64_t size) { return upload_bytes > 0 && upload_bytes + size > texture_streamer->upload_budget_bytes; };
+
+    // 驱逐在替换完成、旧 image 销毁之后才释放显存，本帧只减少替换完成后的占用
+    size_t next_eviction = 0;
+    auto evict = [&]() {
+        if (next_eviction == evictable_textures.size()) { return false; }
+        Texture *texture = evictable_textures[next_eviction];
+        if (is_upload_budget_exceeded(get_levels_upload_size(texture, texture->resident_level + 1))) { return false; }
+        ++next_eviction;
+        committed_bytes -= texture->resident_bytes;
+        transient_bytes += texture->resident_bytes;
+        upload_bytes += set_pending_level(texture_streamer, texture, texture->resident_level + 1);
+        committed_bytes += get_committed_bytes(texture);
+        ++texture_streamer->stats.eviction_count;
+        return true;
+    };
+
+    // 每个贴图每帧只提升一层，由粗到细
+    for (Texture *texture: requested_textures) {
+        uint32_t level = texture->resident_level - 1;
+        uint64_t level_bytes = get_texture_levels_size(texture, level) - texture->resident_bytes;
+        if (is_upload_budget_exceeded(get_levels_upload_size(texture, level))) { break; }
+
+        bool is_over_budget = false;
+        while (committed_bytes + level_bytes > budget_bytes && !is_over_budget) { is_over_budget = !evict(); }
+        if (is_over_budget) {
+            ++texture_streamer->stats.over_budget_frame_count;
+            break;
+        }
+        // 新 image 与旧 image 在替换前同时存在，放不下时等待之前的替换释放显存；驱逐的上传可能已用完本帧的上传预算
+        if (committed_bytes + transient_bytes + get_texture_levels_size(texture, level) > budget_bytes ||
+            is_upload_budget_exceeded(get_levels_upload_size(texture, level))) {
+            break;
+        }
+
+        upload_bytes += set_pending_level(texture_streamer, texture, level);
+        committed_bytes += level_bytes;
+        transient_bytes += texture->resident_bytes;
+        ++texture_streamer->stats.stream_in_count;
+    }
+
+    // 预算缩小（其他程序占用显存等）时，即使没有请求也驱逐到预算以内，受每帧上传预算限制
+    while (committed_bytes > budget_bytes && evict()) {}
+
+    texture_streamer->stats.budget_bytes = budget_bytes;
+    texture_streamer->stats.resident_bytes = committed_bytes;
+    texture_streamer->stats.transient_bytes = transient_bytes;
+}
+
+TextureResidency get_texture_residency(const Texture *texture, uint64_t frame_number) {
+    TextureResidency residency{};
+    residency.is_streamed = is_texture_streamed(texture);
+    residency.is_uploading = texture->pending_image != nullptr;
+    residency.level_count = texture->level_count;
+    residency.resident_level = texture->resident_level;
+    residency.resident_width = std::max(texture->width >> texture->resident_level, 1u);
+    residency.resident_height = std::max(texture->height >> texture->resident_level, 1u);
+    residency.requested_level = texture->last_used_frame == frame_number ? texture->requested_level : texture->level_count;
+    residency.resident_bytes = texture->resident_bytes;
+    residency.idle_frame_count = frame_number - texture->last_used_frame;
+    return residency;
+}
+
+void texture_streamer_log_stats(const TextureStreamer *texture_streamer, const Geometry *geometry, uint64_t frame_number) {
+    const TextureStreamerStats *stats = &texture_streamer->stats;
+    log_info("texture streamer: %.2f / %.2f MB resident, %.2f MB transient, %llu stream ins, %llu evictions, %.2f MB uploaded, %llu frames over budget, "
+             "%s budget",
+             stats->resident_bytes / (1024.0 * 1024.0), stats->budget_bytes / (1024.0 * 1024.0), stats->transient_bytes / (1024.0 * 1024.0),
+             (unsigned long long) stats->stream_in_count,
+             (unsigned long long) stats->eviction_count, stats->bytes_uploaded / (1024.0 * 1024.0), (unsigned long long) stats->over_budget_frame_count,
+             texture_streamer->vk_context->is_memory_budget_supported ? "heap" : "fixed");
+    for (size_t i = 0; i < geometry->textures.size(); ++i) {
+        if (!geometry->textures[i].image) { continue; }
+        TextureResidency residency = get_texture_residency(&geometry->textures[i], frame_number);
+        log_debug("  texture %zu: mip %u/%u (%ux%u)%s, %.2f MB, %s, idle %llu frames", i, residency.resident_level, residency.level_count,
+                  residency.resident_width, residency.resident_height, residency.is_uploading ? " uploading" : "", residency.resident_bytes / (1024.0 * 1024.0),
+                  residency.is_streamed ? "streamed" : "fully resident", (unsigned long long) residency.idle_frame_count);
+    }
+}
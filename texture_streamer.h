@@ -0,0 +1,66 @@
+#pragma once
+
+#include "texture_import.h"
+#include <vector>
+
+struct Geometry;
+
+// 被替换的 image，等到可能使用它的帧都执行完后销毁
+struct RetiredTextureImage {
+    Image *image;
+    VkImageView image_view;
+    uint64_t retire_frame;
+    uint64_t bytes;
+};
+
+struct TextureStreamerStats {
+    uint64_t budget_bytes; // 最近一帧的贴图显存预算
+    uint64_t resident_bytes; // 所有贴图常驻与正在上传的字节数，包括不参与流式加载的贴图
+    uint64_t transient_bytes; // 正在上传的贴图的旧 image 与等待销毁的 image 额外占用的字节数
+    uint64_t stream_in_count; // 提升一层精度的次数
+    uint64_t eviction_count; // 预算不足时驱逐一层的次数
+    uint64_t bytes_uploaded;
+    uint64_t over_budget_frame_count; // 驱逐后仍无法满足请求或驱逐超出本帧上传预算、停止上传的帧数
+};
+
+// 单个贴图的驻留情况
+struct TextureResidency {
+    bool is_streamed;
+    bool is_uploading;
+    uint32_t level_count;
+    uint32_t resident_level;
+    uint32_t resident_width;
+    uint32_t resident_height;
+    uint32_t requested_level; // 本帧的请求，没有被绘制时为 level_count
+    uint64_t resident_bytes;
+    uint64_t idle_frame_count; // 距最近一次被绘制的帧数
+};
+
+// 贴图的 mip 按屏幕上的需求由粗到细逐层上传，显存不足时驱逐最久未使用的贴图的最精细一层
+// 改变驻留层数时创建新的 image 并从 Texture::source 重新上传，上传可用后替换旧的 image；只能在 upload engine 所属的线程上调用
+// 驱逐同样需要重新上传，与提升精度共用每帧的上传预算；新旧 image 在旧的被销毁前同时占用显存，一并计入预算
+struct TextureStreamer {
+    VkContext *vk_context;
+    UploadEngine *upload_engine;
+    uint64_t budget_cap_bytes; // 配置的上限，支持 VK_EXT_memory_budget 时取它与 device local heap 剩余预算中较小者
+    uint64_t upload_budget_bytes; // 每帧最多拷入 staging 的字节数（包括驱逐的重新上传），每帧至少上传一个贴图
+    uint32_t frames_in_flight;
+    std::vector<RetiredTextureImage> retired_images;
+    TextureStreamerStats stats;
+};
+
+void texture_streamer_create(VkContext *vk_context, UploadEngine *upload_engine, uint64_t budget_cap_bytes, uint64_t upload_budget_bytes,
+                             uint32_t frames_in_flight, TextureStreamer **out_texture_streamer);
+
+// 需在 gpu 空闲后调用，只销毁被替换的 image，贴图本身归 Geometry 所有
+void texture_streamer_destroy(TextureStreamer *texture_streamer);
+
+// 记录本帧绘制需要的最精细一层 mip，同一帧多次请求取最精细者；本帧没有请求的贴图视为不需要
+void request_texture_level(Texture *texture, uint32_t level, uint64_t frame_number);
+
+// 每帧在等待该帧的 fence 之后、录制绘制命令之前调用一次：替换上传完成的 image，按本帧的请求与预算上传或驱逐 mip
+void texture_streamer_update(TextureStreamer *texture_streamer, Geometry *geometry, uint64_t frame_number);
+
+TextureResidency get_texture_residency(const Texture *texture, uint64_t frame_number);
+
+void texture_streamer_log_stats(const TextureStreamer *texture_streamer, const Geometry *geometry, uint64_t frame_number);
@@ -0,0 +1,253 @@
+#include "transform_hierarchy.h"
+#include "core/logging.h"
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSFORM_HIERARCHY_AVX2 1
+#define TRANSFORM_HIERARCHY_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRANSFORM_HIERARCHY_SSE2 1
+#endif
+
+uint32_t add_transform_nodes(TransformHierarchy *hierarchy, const int32_t *parents, uint32_t node_count) {
+    uint32_t first_node = hierarchy->node_count;
+    uint32_t total_node_count = first_node + node_count;
+
+    hierarchy->parents.resize(total_node_count);
+    hierarchy->subtree_ends.resize(total_node_count);
+    for (uint32_t i = 0; i < 3; ++i) { hierarchy->translations[i].resize(total_node_count, 0.0f); }
+    for (uint32_t i = 0; i < 4; ++i) { hierarchy->rotations[i].resize(total_node_count, i == 3 ? 1.0f : 0.0f); }
+    for (uint32_t i = 0; i < 3; ++i) { hierarchy->scales[i].resize(total_node_count, 1.0f); }
+    hierarchy->dirty_flags.resize(total_node_count, 0);
+    hierarchy->local_matrices.resize(total_node_count);
+    hierarchy->world_matrices.resize(total_node_count, glm::mat4(1.0f));
+
+    for (uint32_t i = 0; i < node_count; ++i) {
+        ASSERT_MESSAGE(parents[i] < (int32_t) i, "transform nodes must be in pre-order, node %u has parent %d", i, parents[i]);
+        hierarchy->parents[first_node + i] = parents[i] < 0 ? -1 : (int32_t) first_node + parents[i];
+        hierarchy->subtree_ends[first_node + i] = first_node + i + 1;
+    }
+    // 先序排列下子节点的子树末尾即父节点子树的候选末尾，逆序传播一遍即可
+    for (uint32_t i = total_node_count; i-- > first_node;) {
+        int32_t parent = hierarchy->parents[i];
+        if (parent >= 0) { hierarchy->subtree_ends[parent] = std::max(hierarchy->subtree_ends[parent], hierarchy->subtree_ends[i]); }
+    }
+
+    // 新节点的根各自是一棵子树，只需标记根节点
+    for (uint32_t i = first_node; i < total_node_count; ++i) {
+        if (hierarchy->parents[i] < 0) {
+            hierarchy->dirty_flags[i] = 1;
+            hierarchy->dirty_nodes.push_back(i);
+        }
+    }
+    hierarchy->node_count = total_node_count;
+    return first_node;
+}
+
+void set_local_transform(TransformHierarchy *hierarchy, uint32_t node_index, const glm::vec3 &translation, const glm::quat &rotation,
+                         const glm::vec3 &scale) {
+    ASSERT(node_index < hierarchy->node_count);
+    for (uint32_t i = 0; i < 3; ++i) {
+        hierarchy->translations[i][node_index] = translation[i];
+        hierarchy->scales[i][node_index] = scale[i];
+    }
+    hierarchy->rotations[0][node_index] = rotation.x;
+    hierarchy->rotations[1][node_index] = rotation.y;
+    hierarchy->rotations[2][node_index] = rotation.z;
+    hierarchy->rotations[3][node_index] = rotation.w;
+
+    if (!hierarchy->dirty_flags[node_index]) {
+        hierarchy->dirty_flags[node_index] = 1;
+        hierarchy->dirty_nodes.push_back(node_index);
+    }
+}
+
+// 由 TRS 计算单个变换的矩阵，列主序，与 glm 一致
+static void compose_matrix(const TransformComponents *components, uint32_t index, float *matrix) {
+    float x = components->rotations[0][index], y = components->rotations[1][index];
+    float z = components->rotations[2][index], w = components->rotations[3][index];
+    float sx = components->scales[0][index], sy = components->scales[1][index], sz = components->scales[2][index];
+
+    float xx = x * x * 2.0f, yy = y * y * 2.0f, zz = z * z * 2.0f;
+    float xy = x * y * 2.0f, xz = x * z * 2.0f, yz = y * z * 2.0f;
+    float wx = w * x * 2.0f, wy = w * y * 2.0f, wz = w * z * 2.0f;
+
+    matrix[0] = (1.0f - (yy + zz)) * sx;
+    matrix[1] = (xy + wz) * sx;
+    matrix[2] = (xz - wy) * sx;
+    matrix[3] = 0.0f;
+    matrix[4] = (xy - wz) * sy;
+    matrix[5] = (1.0f - (xx + zz)) * sy;
+    matrix[6] = (yz + wx) * sy;
+    matrix[7] = 0.0f;
+    matrix[8] = (xz + wy) * sz;
+    matrix[9] = (yz - wx) * sz;
+    matrix[10] = (1.0f - (xx + yy)) * sz;
+    matrix[11] = 0.0f;
+    matrix[12] = components->translations[0][index];
+    matrix[13] = components->translations[1][index];
+    matrix[14] = components->translations[2][index];
+    matrix[15] = 1.0f;
+}
+
+#if TRANSFORM_HIERARCHY_SSE2
+// 4 个变换同一列的 4 行转置为各自的列向量写出
+static void store_columns(__m128 row0, __m128 row1, __m128 row2, __m128 row3, float *matrices, uint32_t column) {
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+    _mm_storeu_ps(matrices + 0 * 16 + column * 4, row0);
+    _mm_storeu_ps(matrices + 1 * 16 + column * 4, row1);
+    _mm_storeu_ps(matrices + 2 * 16 + column * 4, row2);
+    _mm_storeu_ps(matrices + 3 * 16 + column * 4, row3);
+}
+
+// 每次处理 4 个变换，SoA 的分量一次加载 4 个，计算完成后转置为 AoS 的矩阵
+static uint32_t compose_matrices_sse2(const TransformComponents *components, uint32_t begin, uint32_t end, float *matrices) {
+    const __m128 one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(&components->rotations[0][i]), y = _mm_loadu_ps(&components->rotations[1][i]);
+        __m128 z = _mm_loadu_ps(&components->rotations[2][i]), w = _mm_loadu_ps(&components->rotations[3][i]);
+        __m128 sx = _mm_loadu_ps(&components->scales[0][i]), sy = _mm_loadu_ps(&components->scales[1][i]), sz = _mm_loadu_ps(&components->scales[2][i]);
+
+        __m128 x2 = _mm_add_ps(x, x), y2 = _mm_add_ps(y, y), z2 = _mm_add_ps(z, z);
+        __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+        __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+        __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+        float *node_matrices = matrices + (size_t) (i - begin) * 16;
+        store_columns(_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_add_ps(xy, wz), sx), _mm_mul_ps(_mm_sub_ps(xz, wy), sx), zero,
+                      node_matrices, 0);
+        store_columns(_mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy), _mm_mul_ps(_mm_add_ps(yz, wx), sy), zero,
+                      node_matrices, 1);
+        store_columns(_mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), zero,
+                      node_matrices, 2);
+        store_columns(_mm_loadu_ps(&components->translations[0][i]), _mm_loadu_ps(&components->translations[1][i]),
+                      _mm_loadu_ps(&components->translations[2][i]), one, node_matrices, 3);
+    }
+    return i;
+}
+
+// out = a * b，out 不能与 a 或 b 重叠
+static void multiply_matrices(const float *a, const float *b, float *out) {
+    __m128 a0 = _mm_loadu_ps(a + 0), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+    for (uint32_t column = 0; column < 4; ++column) {
+        const float *b_column = b + column * 4;
+        __m128 result = _mm_mul_ps(a0, _mm_set1_ps(b_column[0]));
+        result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(b_column[1])));
+        result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(b_column[2])));
+        result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_set1_ps(b_column[3])));
+        _mm_storeu_ps(out + column * 4, result);
+    }
+}
+#else
+static void multiply_matrices(const float *a, const float *b, float *out) {
+    for (uint32_t column = 0; column < 4; ++column) {
+        for (uint32_t row = 0; row < 4; ++row) {
+            out[column * 4 + row] = a[0 * 4 + row] * b[column * 4 + 0] + a[1 * 4 + row] * b[column * 4 + 1] + a[2 * 4 + row] * b[column * 4 + 2] +
+                                    a[3 * 4 + row] * b[column * 4 + 3];
+        }
+    }
+}
+#endif
+
+#if TRANSFORM_HIERARCHY_AVX2
+// 每次处理 8 个变换，高低两半各自转置写出
+static uint32_t compose_matrices_avx2(const TransformComponents *components, uint32_t begin, uint32_t end, float *matrices) {
+    const __m256 one = _mm256_set1_ps(1.0f), zero = _mm256_setzero_ps();
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 x = _mm256_loadu_ps(&components->rotations[0][i]), y = _mm256_loadu_ps(&components->rotations[1][i]);
+        __m256 z = _mm256_loadu_ps(&components->rotations[2][i]), w = _mm256_loadu_ps(&components->rotations[3][i]);
+        __m256 sx = _mm256_loadu_ps(&components->scales[0][i]), sy = _mm256_loadu_ps(&components->scales[1][i]);
+        __m256 sz = _mm256_loadu_ps(&components->scales[2][i]);
+
+        __m256 x2 = _mm256_add_ps(x, x), y2 = _mm256_add_ps(y, y), z2 = _mm256_add_ps(z, z);
+        __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+        __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+        __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+
+        __m256 columns[4][4] = {
+            {_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+             _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx), zero},
+            {_mm256_mul_ps(_mm256_sub_ps(xy, wz), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+             _mm256_mul_ps(_mm256_add_ps(yz, wx), sy), zero},
+            {_mm256_mul_ps(_mm256_add_ps(xz, wy), sz), _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+             _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), zero},
+            {_mm256_loadu_ps(&components->translations[0][i]), _mm256_loadu_ps(&components->translations[1][i]),
+             _mm256_loadu_ps(&components->translations[2][i]), one},
+        };
+
+        float *node_matrices = matrices + (size_t) (i - begin) * 16;
+        for (uint32_t column = 0; column < 4; ++column) {
+            const __m256 *rows = columns[column];
+            store_columns(_mm256_castps256_ps128(rows[0]), _mm256_castps256_ps128(rows[1]), _mm256_castps256_ps128(rows[2]),
+                          _mm256_castps256_ps128(rows[3]), node_matrices, column);
+            store_columns(_mm256_extractf128_ps(rows[0], 1), _mm256_extractf128_ps(rows[1], 1), _mm256_extractf128_ps(rows[2], 1),
+                          _mm256_extractf128_ps(rows[3], 1), node_matrices + 4 * 16, column);
+        }
+    }
+    return i;
+}
+#endif
+
+void compose_transform_matrices(const TransformComponents *components, uint32_t begin, uint32_t end, glm::mat4 *matrices) {
+    float *matrix_data = &matrices[0][0][0];
+    uint32_t i = begin;
+#if TRANSFORM_HIERARCHY_AVX2
+    i = compose_matrices_avx2(components, i, end, matrix_data);
+#endif
+#if TRANSFORM_HIERARCHY_SSE2
+    i = compose_matrices_sse2(components, i, end, matrix_data + (size_t) (i - begin) * 16);
+#endif
+    for (; i < end; ++i) { compose_matrix(components, i, matrix_data + (size_t) (i - begin) * 16); }
+}
+
+void multiply_transform_matrices(const glm::mat4 &a, const glm::mat4 &b, glm::mat4 *out) { multiply_matrices(&a[0][0], &b[0][0], &(*out)[0][0]); }
+
+// 重算一棵子树，父节点在子节点之前，按顺序相乘即可保证父节点的世界矩阵已是最新
+static void update_subtree(TransformHierarchy *hierarchy, uint32_t begin, uint32_t end) {
+    TransformComponents components;
+    for (uint32_t i = 0; i < 3; ++i) { components.translations[i] = hierarchy->translations[i].data(); }
+    for (uint32_t i = 0; i < 4; ++i) { components.rotations[i] = hierarchy->rotations[i].data(); }
+    for (uint32_t i = 0; i < 3; ++i) { components.scales[i] = hierarchy->scales[i].data(); }
+    compose_transform_matrices(&components, begin, end, &hierarchy->local_matrices[begin]);
+    for (uint32_t i = begin; i < end; ++i) {
+        int32_t parent = hierarchy->parents[i];
+        if (parent < 0) {
+            hierarchy->world_matrices[i] = hierarchy->local_matrices[i];
+        } else {
+            multiply_matrices(&hierarchy->world_matrices[parent][0][0], &hierarchy->local_matrices[i][0][0], &hierarchy->world_matrices[i][0][0]);
+        }
+    }
+}
+
+uint32_t update_transform_hierarchy(TransformHierarchy *hierarchy) {
+    std::vector<uint32_t> &dirty_nodes = hierarchy->dirty_nodes;
+    if (dirty_nodes.empty()) { return 0; }
+
+    // 按下标排序后，dirty 祖先总在其后代之前，后代落在已重算的区间内时跳过
+    std::sort(dirty_nodes.begin(), dirty_nodes.end());
+    uint32_t updated_node_count = 0;
+    uint32_t updated_end = 0;
+    for (uint32_t node_index: dirty_nodes) {
+        hierarchy->dirty_flags[node_index] = 0;
+        if (node_index < updated_end) { continue; }
+        updated_end = hierarchy->subtree_ends[node_index];
+        update_subtree(hierarchy, node_index, updated_end);
+        updated_node_count += updated_end - node_index;
+    }
+    dirty_nodes.clear();
+    return updated_node_count;
+}
+
+const char *transform_hierarchy_simd_name() {
+#if TRANSFORM_HIERARCHY_AVX2
+    return "avx2";
+#elif TRANSFORM_HIERARCHY_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
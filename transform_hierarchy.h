@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+// SoA 存放的 TRS 分量，各数组的同一下标为同一个变换
+struct TransformComponents {
+    const float *translations[3];
+    const float *rotations[4]; // 四元数 x, y, z, w
+    const float *scales[3];
+};
+
+// 展平的节点层级：节点按先序深度优先排列，父节点总在子节点之前，每个节点的子树是一段连续区间
+// 局部变换按分量以 SoA 存放，更新时批量计算局部矩阵，再按顺序与父节点的世界矩阵相乘
+struct TransformHierarchy {
+    uint32_t node_count;
+    std::vector<int32_t> parents;       // 根节点为 -1
+    std::vector<uint32_t> subtree_ends; // 节点 i 的子树为 [i, subtree_ends[i])
+    std::vector<float> translations[3]; // x, y, z
+    std::vector<float> rotations[4];    // 四元数 x, y, z, w
+    std::vector<float> scales[3];
+
+    std::vector<uint8_t> dirty_flags;   // 局部变换在上次更新后被修改
+    std::vector<uint32_t> dirty_nodes;  // 去重后的 dirty 节点，更新时按下标排序
+
+    std::vector<glm::mat4> local_matrices; // 更新时的中间结果
+    std::vector<glm::mat4> world_matrices;
+};
+
+// 追加一组节点，`parents` 相对于这组节点的首个节点且须按先序排列（parents[i] < i），根节点为 -1
+// 新节点为单位变换，下次更新时计算世界矩阵，返回首个节点的下标
+uint32_t add_transform_nodes(TransformHierarchy *hierarchy, const int32_t *parents, uint32_t node_count);
+
+// 设置局部变换并标记为 dirty，下次更新时重算该节点的整个子树
+void set_local_transform(TransformHierarchy *hierarchy, uint32_t node_index, const glm::vec3 &translation, const glm::quat &rotation,
+                         const glm::vec3 &scale);
+
+// 重算所有 dirty 节点的子树，被 dirty 祖先覆盖的子树只计算一次，返回重算的节点数
+uint32_t update_transform_hierarchy(TransformHierarchy *hierarchy);
+
+// 批量由 TRS 计算 [begin, end) 的矩阵，写入 matrices[0, end - begin)，列主序
+void compose_transform_matrices(const TransformComponents *components, uint32_t begin, uint32_t end, glm::mat4 *matrices);
+
+// out = a * b，out 不能与 a 或 b 重叠
+void multiply_transform_matrices(const glm::mat4 &a, const glm::mat4 &b, glm::mat4 *out);
+
+// 编译时启用的指令集，用于日志输出
+const char *transform_hierarchy_simd_name();
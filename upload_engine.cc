@@ -0,0 +1,361 @@
+#include "upload_engine.h"
+#include "vk_command_buffer.h"
+#include "vk_command_pool.h"
+#include "vk_context.h"
+#include "vk_fence.h"
+#include "vk_image.h"
+#include "vk_queue.h"
+#include "core/logging.h"
+#include <algorithm>
+
+// 满足 buffer 与 image 拷贝对 bufferOffset 的对齐要求
+#define UPLOAD_RING_ALIGNMENT 16
+
+void upload_engine_create(VkContext *vk_context, size_t ring_capacity, UploadEngine **out_upload_engine) {
+    UploadEngine *upload_engine = new UploadEngine();
+    upload_engine->vk_context = vk_context;
+    upload_engine->queue = vk_context->transfer_queue;
+    upload_engine->queue_family_index = vk_context->transfer_queue_family_index;
+    upload_engine->graphics_queue_family_index = vk_context->graphics_queue_family_index;
+    upload_engine->is_dedicated_transfer_queue = vk_context->transfer_queue_family_index != vk_context->graphics_queue_family_index;
+    bool succeed = vk_create_command_pool(vk_context->device, upload_engine->queue_family_index, &upload_engine->command_pool);
+    ASSERT(succeed);
+
+    vk_create_buffer(vk_context, ring_capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, &upload_engine->ring_buffer);
+    VmaAllocationInfo allocation_info;
+    vmaGetAllocationInfo(vk_context->allocator, upload_engine->ring_buffer.allocation, &allocation_info);
+    upload_engine->ring_data = (uint8_t *) allocation_info.pMappedData;
+    upload_engine->ring.capacity = ring_capacity;
+    upload_engine->ring.alignment = UPLOAD_RING_ALIGNMENT;
+
+    upload_engine->next_token = 1;
+    upload_engine->completed_token = 0;
+    upload_engine->available_token = 0;
+
+    *out_upload_engine = upload_engine;
+}
+
+void upload_engine_destroy(UploadEngine *upload_engine) {
+    VkDevice device = upload_engine->vk_context->device;
+
+    upload_engine_wait(upload_engine, upload_engine_flush(upload_engine));
+    ASSERT(upload_engine->in_flight_batches.empty());
+
+    for (UploadBatch &batch: upload_engine->free_batches) {
+        vk_destroy_fence(device, batch.fence);
+        vk_free_command_buffer(device, upload_engine->command_pool, batch.command_buffer);
+    }
+    vk_destroy_command_pool(device, upload_engine->command_pool);
+    vk_destroy_buffer(upload_engine->vk_context, &upload_engine->ring_buffer);
+    delete upload_engine;
+}
+
+// 生成剩余的 mip 并将整个 image 转换为 SHADER_READ_ONLY_OPTIMAL，调用前所有层处于 TRANSFER_DST_OPTIMAL
+static void record_mipmap_generation(VkCommandBuffer command_buffer, const MipmapGeneration *mipmap_generation) {
+    vk_generate_mipmaps(command_buffer, mipmap_generation->image, mipmap_generation->width, mipmap_generation->height, mipmap_generation->base_level,
+                        mipmap_generation->level_count);
+    if (mipmap_generation->base_level > 0) {
+        vk_transition_image_levels(command_buffer, mipmap_generation->image, 0, mipmap_generation->base_level, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                   VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT,
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    vk_transition_image_levels(command_buffer, mipmap_generation->image, mipmap_generation->base_level, mipmap_generation->level_count + 1,
+                               VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                               VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT,
+                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+static void retire_batch(UploadEngine *upload_engine, UploadBatch *batch) {
+    for (Buffer &buffer: batch->dedicated_buffers) { vk_destroy_buffer(upload_engine->vk_context, &buffer); }
+    batch->dedicated_buffers.clear();
+
+    // release 已在 transfer queue 上执行完毕，对应的 acquire 由 graphics queue 在之后的提交中执行
+    for (VkBufferMemoryBarrier2 barrier: batch->buffer_barriers) {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+        upload_engine->pending_buffer_acquires.push_back(barrier);
+    }
+    for (VkImageMemoryBarrier2 barrier: batch->image_barriers) {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        if (barrier.newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) { // 还需生成 mip
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        } else {
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+        }
+        upload_engine->pending_image_acquires.push_back(barrier);
+    }
+    upload_engine->pending_mipmap_generations.insert(upload_engine->pending_mipmap_generations.end(), batch->mipmap_generations.begin(),
+                                                     batch->mipmap_generations.end());
+    batch->buffer_barriers.clear();
+    batch->image_barriers.clear();
+    batch->mipmap_generations.clear();
+    if (upload_engine->is_dedicated_transfer_queue) { upload_engine->pending_acquire_token = batch->token; }
+
+    staging_ring_release(&upload_engine->ring, batch->ring_end);
+    upload_engine->completed_token = batch->token;
+    upload_engine->free_batches.push_back(std::move(*batch));
+}
+
+void upload_engine_poll(UploadEngine *upload_engine) {
+    // 同一队列上的批次按提交顺序完成
+    while (!upload_engine->in_flight_batches.empty()) {
+        UploadBatch &batch = upload_engine->in_flight_batches.front();
+        if (vkGetFenceStatus(upload_engine->vk_context->device, batch.fence) != VK_SUCCESS) { break; }
+        retire_batch(upload_engine, &batch);
+        upload_engine->in_flight_batches.pop_front();
+    }
+}
+
+// 阻塞直到最早提交的批次完成
+static void wait_oldest_batch(UploadEngine *upload_engine) {
+    ASSERT(!upload_engine->in_flight_batches.empty());
+    UploadBatch &batch = upload_engine->in_flight_batches.front();
+    vk_wait_fence(upload_engine->vk_context->device, batch.fence);
+    retire_batch(upload_engine, &batch);
+    upload_engine->in_flight_batches.pop_front();
+}
+
+static UploadBatch *begin_batch(UploadEngine *upload_engine) {
+    UploadBatch *batch = &upload_engine->recording_batch;
+    if (batch->command_buffer != VK_NULL_HANDLE) { return batch; }
+
+    VkDevice device = upload_engine->vk_context->device;
+    if (!upload_engine->free_batches.empty()) {
+        *batch = std::move(upload_engine->free_batches.back());
+        upload_engine->free_batches.pop_back();
+        vk_reset_fence(device, batch->fence);
+        vk_reset_command_buffer(batch->command_buffer);
+    } else {
+        *batch = {};
+        vk_alloc_command_buffer(device, upload_engine->command_pool, &batch->command_buffer);
+        vk_create_fence(device, false, &batch->fence);
+    }
+    batch->token = upload_engine->next_token;
+    batch->ring_end = upload_engine->ring.head;
+    batch->bytes = 0;
+    vk_begin_one_flight_command_buffer(batch->command_buffer);
+    return batch;
+}
+
+UploadToken upload_engine_flush(UploadEngine *upload_engine) {
+    UploadBatch *batch = &upload_engine->recording_batch;
+    if (batch->command_buffer == VK_NULL_HANDLE) { return upload_engine->next_token - 1; }
+
+    VkDependencyInfo dependency_info{};
+    dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    VkMemoryBarrier2 memory_barrier{};
+    if (upload_engine->is_dedicated_transfer_queue) {
+        // release ownership 给 graphics queue family，image 的布局转换包含在 barrier 中
+        dependency_info.bufferMemoryBarrierCount = batch->buffer_barriers.size();
+        dependency_info.pBufferMemoryBarriers = batch->buffer_barriers.data();
+        dependency_info.imageMemoryBarrierCount = batch->image_barriers.size();
+        dependency_info.pImageMemoryBarriers = batch->image_barriers.data();
+    } else {
+        // 拷贝结果对之后提交到该队列的所有命令可见，image 的布局转换已在录制时完成
+        memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        memory_barrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        memory_barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        memory_barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        memory_barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+        dependency_info.memoryBarrierCount = 1;
+        dependency_info.pMemoryBarriers = &memory_barrier;
+    }
+    vkCmdPipelineBarrier2KHR(batch->command_buffer, &dependency_info);
+
+    vk_end_command_buffer(batch->command_buffer);
+    vk_queue_submit(upload_engine->queue, batch->command_buffer, batch->fence);
+
+    UploadToken token = batch->token;
+    upload_engine->next_token = token + 1;
+    if (!upload_engine->is_dedicated_transfer_queue) { upload_engine->available_token = token; }
+    ++upload_engine->stats.submission_count;
+    upload_engine->in_flight_batches.push_back(std::move(*batch));
+    *batch = {};
+    return token;
+}
+
+bool upload_engine_is_complete(UploadEngine *upload_engine, UploadToken token) {
+    if (token <= upload_engine->completed_token) { return true; }
+    upload_engine_poll(upload_engine);
+    return token <= upload_engine->completed_token;
+}
+
+void upload_engine_record_acquire_barriers(UploadEngine *upload_engine, VkCommandBuffer command_buffer) {
+    if (upload_engine->pending_buffer_acquires.empty() && upload_engine->pending_image_acquires.empty()) {
+        upload_engine->available_token = std::max(upload_engine->available_token, upload_engine->pending_acquire_token);
+        return;
+    }
+
+    VkDependencyInfo dependency_info{};
+    dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency_info.bufferMemoryBarrierCount = upload_engine->pending_buffer_acquires.size();
+    dependency_info.pBufferMemoryBarriers = upload_engine->pending_buffer_acquires.data();
+    dependency_info.imageMemoryBarrierCount = upload_engine->pending_image_acquires.size();
+    dependency_info.pImageMemoryBarriers = upload_engine->pending_image_acquires.data();
+    vkCmdPipelineBarrier2KHR(command_buffer, &dependency_info);
+
+    for (const MipmapGeneration &mipmap_generation: upload_engine->pending_mipmap_generations) { record_mipmap_generation(command_buffer, &mipmap_generation); }
+
+    upload_engine->pending_buffer_acquires.clear();
+    upload_engine->pending_image_acquires.clear();
+    upload_engine->pending_mipmap_generations.clear();
+    upload_engine->available_token = upload_engine->pending_acquire_token;
+}
+
+bool upload_engine_is_available(const UploadEngine *upload_engine, UploadToken token) { return token <= upload_engine->available_token; }
+
+void upload_engine_wait(UploadEngine *upload_engine, UploadToken token) {
+    if (token >= upload_engine->next_token) { upload_engine_flush(upload_engine); }
+    while (upload_engine->completed_token < token) { wait_oldest_batch(upload_engine); }
+    if (upload_engine->available_token < token) {
+        vk_command_buffer_submit(upload_engine->vk_context, [&](VkCommandBuffer command_buffer) {
+            upload_engine_record_acquire_barriers(upload_engine, command_buffer);
+        });
+    }
+}
+
+// 在 ring 中分配 staging 空间并拷入数据，返回 (buffer, offset)；超过 ring 容量时改用独立的 staging buffer
+static void stage_data(UploadEngine *upload_engine, const void *data, size_t size, VkBuffer *out_buffer, uint64_t *out_offset) {
+    if (size > upload_engine->ring.capacity) {
+        UploadBatch *batch = begin_batch(upload_engine);
+        Buffer staging_buffer;
+        vk_create_buffer(upload_engine->vk_context, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, &staging_buffer);
+        vk_copy_data_to_buffer(upload_engine->vk_context, &staging_buffer, data, size);
+        batch->dedicated_buffers.push_back(staging_buffer);
+        *out_buffer = staging_buffer.handle;
+        *out_offset = 0;
+        return;
+    }
+
+    StagingRing *ring = &upload_engine->ring;
+    uint64_t head = staging_ring_get_allocation_head(ring, size);
+
+    // 空间不足时先提交正在录制的批次，再依次等待最早的批次完成；全部完成后 ring 为空，总能分配
+    if (!staging_ring_can_allocate(ring, head, size)) {
+        ++upload_engine->stats.stall_count;
+        upload_engine_flush(upload_engine);
+        upload_engine_poll(upload_engine);
+        while (!staging_ring_can_allocate(ring, head, size)) { wait_oldest_batch(upload_engine); }
+    }
+
+    UploadBatch *batch = begin_batch(upload_engine);
+    uint64_t offset = staging_ring_allocate(ring, head, size);
+    memcpy(upload_engine->ring_data + offset, data, size);
+    batch->ring_end = ring->head;
+
+    *out_buffer = upload_engine->ring_buffer.handle;
+    *out_offset = offset;
+}
+
+UploadToken upload_buffer(UploadEngine *upload_engine, VkBuffer dst, uint64_t dst_offset, const void *data, size_t size) {
+    if (size == 0) { return 0; }
+
+    VkBuffer staging_buffer;
+    uint64_t staging_offset;
+    stage_data(upload_engine, data, size, &staging_buffer, &staging_offset);
+
+    UploadBatch *batch = &upload_engine->recording_batch;
+    vk_command_copy_buffer(batch->command_buffer, staging_buffer, dst, size, staging_offset, dst_offset);
+    batch->bytes += size;
+
+    if (upload_engine->is_dedicated_transfer_queue) {
+        // 与上一次上传在同一 buffer 中相邻时合并为一个 barrier
+        if (!batch->buffer_barriers.empty() && batch->buffer_barriers.back().buffer == dst &&
+            batch->buffer_barriers.back().offset + batch->buffer_barriers.back().size == dst_offset) {
+            batch->buffer_barriers.back().size += size;
+        } else {
+            VkBufferMemoryBarrier2 barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+            barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+            barrier.dstAccessMask = VK_ACCESS_2_NONE;
+            barrier.srcQueueFamilyIndex = upload_engine->queue_family_index;
+            barrier.dstQueueFamilyIndex = upload_engine->graphics_queue_family_index;
+            barrier.buffer = dst;
+            barrier.offset = dst_offset;
+            barrier.size = size;
+            batch->buffer_barriers.push_back(barrier);
+        }
+    }
+
+    ++upload_engine->stats.upload_count;
+    upload_engine->stats.bytes_uploaded += size;
+    return batch->token;
+}
+
+UploadToken upload_image(UploadEngine *upload_engine, const Image *image, VkFormat format, uint32_t width, uint32_t height, uint32_t level_count,
+                         const void *data, size_t size) {
+    ASSERT(level_count > 0 && level_count <= image->mip_levels);
+    MipmapGeneration mipmap_generation{image->image, width, height, level_count - 1, image->mip_levels - level_count};
+    if (mipmap_generation.level_count > 0) {
+        ASSERT_MESSAGE(vk_is_mipmap_generation_supported(upload_engine->vk_context, format), "format %d does not support mipmap generation", format);
+    }
+
+    VkBuffer staging_buffer;
+    uint64_t staging_offset;
+    stage_data(upload_engine, data, size, &staging_buffer, &staging_offset);
+
+    UploadBatch *batch = &upload_engine->recording_batch;
+    VkCommandBuffer command_buffer = batch->command_buffer;
+    vk_transition_image_layout(command_buffer, image->image, VK_PIPELINE_STAGE_2_NONE, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    // 各层的偏移是块大小的整数倍，staging 起始按 UPLOAD_RING_ALIGNMENT 对齐，满足 bufferOffset 的对齐要求
+    std::vector<VkBufferImageCopy> buffer_image_copies(level_count);
+    uint64_t level_offset = 0;
+    for (uint32_t level = 0; level < level_count; ++level) {
+        uint32_t level_width = std::max(width >> level, 1u), level_height = std::max(height >> level, 1u);
+        VkBufferImageCopy *buffer_image_copy = &buffer_image_copies[level];
+        *buffer_image_copy = {};
+        buffer_image_copy->bufferOffset = staging_offset + level_offset;
+        buffer_image_copy->imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        buffer_image_copy->imageSubresource.mipLevel = level;
+        buffer_image_copy->imageSubresource.baseArrayLayer = 0;
+        buffer_image_copy->imageSubresource.layerCount = 1;
+        buffer_image_copy->imageExtent = {level_width, level_height, 1};
+        level_offset += vk_get_image_level_size(format, level_width, level_height);
+    }
+    ASSERT_MESSAGE(level_offset == size, "image data size %zu does not match %u levels of format %d", size, level_count, format);
+    vkCmdCopyBufferToImage(command_buffer, staging_buffer, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, buffer_image_copies.size(), buffer_image_copies.data());
+
+    if (upload_engine->is_dedicated_transfer_queue) {
+        // transfer queue 不支持 shader stage 与 blit，布局转换随 release/acquire barrier 一起执行；需要生成 mip 时保持 TRANSFER_DST，acquire 之后再生成
+        VkImageMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.dstAccessMask = VK_ACCESS_2_NONE;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = mipmap_generation.level_count > 0 ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = upload_engine->queue_family_index;
+        barrier.dstQueueFamilyIndex = upload_engine->graphics_queue_family_index;
+        barrier.image = image->image;
+        barrier.subresourceRange = vk_image_subresource_range(VK_IMAGE_ASPECT_COLOR_BIT);
+        batch->image_barriers.push_back(barrier);
+        if (mipmap_generation.level_count > 0) { batch->mipmap_generations.push_back(mipmap_generation); }
+    } else if (mipmap_generation.level_count > 0) {
+        record_mipmap_generation(command_buffer, &mipmap_generation);
+    } else {
+        vk_transition_image_layout(command_buffer, image->image, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    batch->bytes += size;
+
+    ++upload_engine->stats.upload_count;
+    upload_engine->stats.bytes_uploaded += size;
+    upload_engine->stats.generated_level_count += mipmap_generation.level_count;
+    return batch->token;
+}
+
+void upload_engine_log_stats(const UploadEngine *upload_engine) {
+    const UploadStats *stats = &upload_engine->stats;
+    log_info("upload engine: %llu uploads, %.2f MB in %llu submissions, %llu stalls, %llu mip levels generated, ring %.1f MB, %s queue",
+             (unsigned long long) stats->upload_count, stats->bytes_uploaded / (1024.0 * 1024.0), (unsigned long long) stats->submission_count,
+             (unsigned long long) stats->stall_count, (unsigned long long) stats->generated_level_count, upload_engine->ring.capacity / (1024.0 * 1024.0),
+             upload_engine->is_dedicated_transfer_queue ? "transfer" : "graphics");
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "core/staging_ring.h"
+#include "vk_buffer.h"
+#include "vk_image.h"
+#include <deque>
+#include <vector>
+
+// 上传完成的凭证，单调递增，每次提交对应一个；0 表示无需等待
+typedef uint64_t UploadToken;
+
+// 永远不会可用的 token，标记尚未录制上传的资源，不能用于等待
+#define UPLOAD_TOKEN_NEVER UINT64_MAX
+
+// 拷贝之后需要在 gpu 上 blit 生成的 mip 层
+struct MipmapGeneration {
+    VkImage image;
+    uint32_t width;
+    uint32_t height;
+    uint32_t base_level; // 最后一层拷贝的 mip，由它生成之后的各层
+    uint32_t level_count;
+};
+
+// 一次提交所包含的上传，命令录制在同一个 command buffer 中
+struct UploadBatch {
+    UploadToken token;
+    VkCommandBuffer command_buffer;
+    VkFence fence;
+    uint64_t ring_end;                     // 该批次在 staging ring 中占用到的位置，完成后据此回收
+    std::vector<Buffer> dedicated_buffers; // 超过 ring 容量的上传使用独立的 staging buffer，完成后销毁
+    size_t bytes;
+
+    // 使用独立 transfer queue 时，提交前录制的 release barrier，完成后在 graphics queue 上执行对应的 acquire
+    std::vector<VkBufferMemoryBarrier2> buffer_barriers;
+    std::vector<VkImageMemoryBarrier2> image_barriers;
+    std::vector<MipmapGeneration> mipmap_generations; // transfer queue 不支持 blit，acquire 之后在 graphics queue 上生成
+};
+
+struct UploadStats {
+    uint64_t submission_count;
+    uint64_t upload_count;
+    uint64_t bytes_uploaded;
+    uint64_t stall_count; // ring 空间不足需要等待 gpu 的次数
+    uint64_t generated_level_count; // 在 gpu 上 blit 生成的 mip 层数
+};
+
+// 持久映射的 staging ring + 批量提交，只能在创建它的线程上使用
+// 设备有独立的 transfer queue family 时提交到该队列，并通过 queue family ownership transfer 将资源交给 graphics queue
+struct UploadEngine {
+    VkContext *vk_context;
+    VkQueue queue;
+    uint32_t queue_family_index;
+    uint32_t graphics_queue_family_index;
+    bool is_dedicated_transfer_queue;
+    VkCommandPool command_pool;
+
+    Buffer ring_buffer;
+    uint8_t *ring_data;
+    StagingRing ring;
+
+    UploadBatch recording_batch; // command_buffer 为 VK_NULL_HANDLE 时表示当前没有正在录制的批次
+    std::deque<UploadBatch> in_flight_batches;
+    std::vector<UploadBatch> free_batches; // 可复用的 command buffer 与 fence
+
+    UploadToken next_token;
+    UploadToken completed_token; // gpu 已执行完拷贝的批次
+    UploadToken available_token; // 之后提交到 graphics queue 的命令可以使用的批次
+
+    // 已完成但还未在 graphics queue 上 acquire 的资源
+    std::vector<VkBufferMemoryBarrier2> pending_buffer_acquires;
+    std::vector<VkImageMemoryBarrier2> pending_image_acquires;
+    std::vector<MipmapGeneration> pending_mipmap_generations;
+    UploadToken pending_acquire_token;
+
+    UploadStats stats;
+};
+
+void upload_engine_create(VkContext *vk_context, size_t ring_capacity, UploadEngine **out_upload_engine);
+
+// 等待所有上传完成后销毁
+void upload_engine_destroy(UploadEngine *upload_engine);
+
+// 将数据拷入 staging ring 并录制一次 buffer 拷贝，返回所属批次的 token，批次在 flush 后才会提交
+// token 可用（upload_engine_is_available）后，之后在 graphics queue 上提交的命令即可读取
+UploadToken upload_buffer(UploadEngine *upload_engine, VkBuffer dst, uint64_t dst_offset, const void *data, size_t size);
+
+// 上传 image 的前 `level_count` 层 mip，`data` 中各层按 `format` 的块大小紧密排列、依次存放，完成后 image 处于 SHADER_READ_ONLY_OPTIMAL
+// image 的 mip 层数多于 `level_count` 时，其余各层由最后一层逐级 blit 生成，与拷贝在同一批次中提交；使用独立 transfer queue 时在 acquire 时生成
+UploadToken upload_image(UploadEngine *upload_engine, const Image *image, VkFormat format, uint32_t width, uint32_t height, uint32_t level_count,
+                         const void *data, size_t size);
+
+// 提交当前批次，返回其 token，没有待提交的上传时返回最近一次提交的 token
+UploadToken upload_engine_flush(UploadEngine *upload_engine);
+
+// 查询已完成的批次并回收 ring 空间，不阻塞
+void upload_engine_poll(UploadEngine *upload_engine);
+
+bool upload_engine_is_complete(UploadEngine *upload_engine, UploadToken token);
+
+// 使用独立 transfer queue 时，在 graphics command buffer 开头录制已完成批次的 acquire barrier 与待生成的 mip，之后这些上传变为可用
+// 与 graphics queue 共用时上传在 flush 后即可用，此函数不录制任何命令
+void upload_engine_record_acquire_barriers(UploadEngine *upload_engine, VkCommandBuffer command_buffer);
+
+bool upload_engine_is_available(const UploadEngine *upload_engine, UploadToken token);
+
+// 必要时先提交当前批次，再阻塞直到 token 对应的上传完成并可用，需要时同步执行 acquire
+void upload_engine_wait(UploadEngine *upload_engine, UploadToken token);
+
+void upload_engine_log_stats(const UploadEngine *upload_engine);
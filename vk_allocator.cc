@@ -18,6 +18,7 @@ void vk_create_allocator(VkContext *vk_context) {
     allocator_create_info.pVulkanFunctions = &vulkan_functions;
     allocator_create_info.vulkanApiVersion = vk_context->api_version;
     allocator_create_info.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    if (vk_context->is_memory_budget_supported) { allocator_create_info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT; }
 
     VkResult result = vmaCreateAllocator(&allocator_create_info, &vk_context->allocator);
     ASSERT(result == VK_SUCCESS);
@@ -19,6 +19,36 @@ void vk_destroy_buffer(VkContext *vk_context, Buffer *buffer) {
     vmaDestroyBuffer(vk_context->allocator, buffer->handle, buffer->allocation);
 }
 
+VkDeviceAddress vk_get_buffer_device_address(VkContext *vk_context, const Buffer *buffer) {
+    VkBufferDeviceAddressInfo buffer_device_address_info{};
+    buffer_device_address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+    buffer_device_address_info.buffer = buffer->handle;
+    return vkGetBufferDeviceAddress(vk_context->device, &buffer_device_address_info);
+}
+
+void vk_buffer_barrier(VkCommandBuffer command_buffer, const Buffer *buffer,
+                       VkPipelineStageFlags2 src_stage_mask, VkPipelineStageFlags2 dst_stage_mask,
+                       VkAccessFlags2 src_access_mask, VkAccessFlags2 dst_access_mask) {
+    VkBufferMemoryBarrier2 buffer_memory_barrier{};
+    buffer_memory_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+    buffer_memory_barrier.srcStageMask = src_stage_mask;
+    buffer_memory_barrier.dstStageMask = dst_stage_mask;
+    buffer_memory_barrier.srcAccessMask = src_access_mask;
+    buffer_memory_barrier.dstAccessMask = dst_access_mask;
+    buffer_memory_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_memory_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_memory_barrier.buffer = buffer->handle;
+    buffer_memory_barrier.offset = 0;
+    buffer_memory_barrier.size = VK_WHOLE_SIZE;
+
+    VkDependencyInfo dependency_info{};
+    dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency_info.bufferMemoryBarrierCount = 1;
+    dependency_info.pBufferMemoryBarriers = &buffer_memory_barrier;
+
+    vkCmdPipelineBarrier2KHR(command_buffer, &dependency_info);
+}
+
 void vk_copy_data_to_buffer(VkContext *vk_context, const Buffer *buffer, const void *data, size_t size) {
     void *mapped_ptr = nullptr;
     VkResult result = vmaMapMemory(vk_context->allocator, buffer->allocation, &mapped_ptr);
@@ -26,3 +56,13 @@ void vk_copy_data_to_buffer(VkContext *vk_context, const Buffer *buffer, const v
     memcpy(mapped_ptr, data, size);
     vmaUnmapMemory(vk_context->allocator, buffer->allocation);
 }
+
+void vk_copy_data_from_buffer(VkContext *vk_context, const Buffer *buffer, void *data, size_t size) {
+    VkResult result = vmaInvalidateAllocation(vk_context->allocator, buffer->allocation, 0, size);
+    ASSERT(result == VK_SUCCESS);
+    void *mapped_ptr = nullptr;
+    result = vmaMapMemory(vk_context->allocator, buffer->allocation, &mapped_ptr);
+    ASSERT(result == VK_SUCCESS);
+    memcpy(data, mapped_ptr, size);
+    vmaUnmapMemory(vk_context->allocator, buffer->allocation);
+}
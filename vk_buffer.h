@@ -11,4 +11,15 @@ void vk_create_buffer(VkContext *vk_context, size_t size, VkBufferUsageFlags usa
 
 void vk_destroy_buffer(VkContext *vk_context, Buffer *buffer);
 
+// buffer 需以 VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT 创建
+VkDeviceAddress vk_get_buffer_device_address(VkContext *vk_context, const Buffer *buffer);
+
+// 整个 buffer 范围上的 memory barrier
+void vk_buffer_barrier(VkCommandBuffer command_buffer, const Buffer *buffer,
+                       VkPipelineStageFlags2 src_stage_mask, VkPipelineStageFlags2 dst_stage_mask,
+                       VkAccessFlags2 src_access_mask, VkAccessFlags2 dst_access_mask);
+
 void vk_copy_data_to_buffer(VkContext *vk_context, const Buffer *buffer, const void *data, size_t size);
+
+// buffer 需为 host 可见，且 gpu 的写入已对 host 可见（barrier 的 dst 为 VK_PIPELINE_STAGE_2_HOST_BIT，并已等待提交完成）
+void vk_copy_data_from_buffer(VkContext *vk_context, const Buffer *buffer, void *data, size_t size);
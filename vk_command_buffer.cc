@@ -87,10 +87,11 @@ void vk_command_buffer_submit(VkContext *vk_context, const std::function<void(Vk
     VkFence fence;
     vk_create_fence(vk_context->device, false, &fence);
 
-    vk_queue_submit(vk_context->graphics_queue, command_buffer, fence); // todo: 区分 graphics queue 和 transfer queue
+    vk_queue_submit(vk_context->graphics_queue, command_buffer, fence); // 资源上传走 UploadEngine 的 transfer queue
 
     vk_wait_fence(vk_context->device, fence);
     vk_destroy_fence(vk_context->device, fence);
+    vk_free_command_buffer(vk_context->device, vk_context->command_pool, command_buffer);
 }
 
 void vk_command_clear_color_image(VkCommandBuffer command_buffer, VkImage image, VkImageLayout image_layout,
@@ -131,12 +132,12 @@ void vk_command_bind_pipeline(VkCommandBuffer command_buffer, VkPipelineBindPoin
 }
 
 void vk_command_bind_descriptor_sets(VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point,
-                                     VkPipelineLayout pipeline_layout, uint32_t set_count, const VkDescriptorSet *descriptor_sets) {
-    vkCmdBindDescriptorSets(command_buffer, bind_point, pipeline_layout, 0, set_count, descriptor_sets, 0, nullptr);
+                                     VkPipelineLayout pipeline_layout, uint32_t first_set, uint32_t set_count, const VkDescriptorSet *descriptor_sets) {
+    vkCmdBindDescriptorSets(command_buffer, bind_point, pipeline_layout, first_set, set_count, descriptor_sets, 0, nullptr);
 }
 
-void vk_command_bind_index_buffer(VkCommandBuffer command_buffer, VkBuffer buffer, uint64_t offset) {
-    vkCmdBindIndexBuffer(command_buffer, buffer, offset, VK_INDEX_TYPE_UINT32);
+void vk_command_bind_index_buffer(VkCommandBuffer command_buffer, VkBuffer buffer, uint64_t offset, VkIndexType index_type) {
+    vkCmdBindIndexBuffer(command_buffer, buffer, offset, index_type);
 }
 
 void vk_command_push_constants(VkCommandBuffer command_buffer, VkPipelineLayout layout, VkShaderStageFlags stage_flags,
@@ -190,8 +191,18 @@ vk_command_draw(VkCommandBuffer command_buffer, uint32_t vertex_count, uint32_t
     vkCmdDraw(command_buffer, vertex_count, instance_count, first_vertex, first_instance);
 }
 
-void vk_command_draw_indexed(VkCommandBuffer command_buffer, uint32_t index_count) {
-    vkCmdDrawIndexed(command_buffer, index_count, 1, 0, 0, 0);
+void vk_command_draw_indexed(VkCommandBuffer command_buffer, uint32_t index_count, uint32_t instance_count, uint32_t first_index,
+                             int32_t vertex_offset, uint32_t first_instance) {
+    vkCmdDrawIndexed(command_buffer, index_count, instance_count, first_index, vertex_offset, first_instance);
+}
+
+void vk_command_draw_indexed_indirect_count(VkCommandBuffer command_buffer, VkBuffer buffer, uint64_t offset, VkBuffer count_buffer,
+                                            uint64_t count_offset, uint32_t max_draw_count, uint32_t stride) {
+    vkCmdDrawIndexedIndirectCount(command_buffer, buffer, offset, count_buffer, count_offset, max_draw_count, stride);
+}
+
+void vk_command_fill_buffer(VkCommandBuffer command_buffer, VkBuffer buffer, uint64_t offset, uint64_t size, uint32_t data) {
+    vkCmdFillBuffer(command_buffer, buffer, offset, size, data);
 }
 
 void
@@ -28,6 +28,7 @@ VkCommandBufferSubmitInfo vk_command_buffer_submit_info(VkCommandBuffer command_
 VkSubmitInfo2 vk_submit_info(VkCommandBufferSubmitInfo *command_buffer, VkSemaphoreSubmitInfo *wait_semaphore,
                              VkSemaphoreSubmitInfo *signal_semaphore);
 
+// 同步提交到 graphics queue 并等待完成，仅用于一次性的命令；资源上传使用 UploadEngine
 void vk_command_buffer_submit(VkContext *vk_context, const std::function<void(VkCommandBuffer command_buffer)> &func);
 
 void vk_command_clear_color_image(VkCommandBuffer command_buffer, VkImage image, VkImageLayout image_layout,
@@ -38,9 +39,9 @@ void vk_command_blit_image(VkCommandBuffer command_buffer, VkImage src, VkImage
 void vk_command_bind_pipeline(VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point, VkPipeline pipeline);
 
 void vk_command_bind_descriptor_sets(VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point,
-                                     VkPipelineLayout pipeline_layout, uint32_t set_count, const VkDescriptorSet *descriptor_sets);
+                                     VkPipelineLayout pipeline_layout, uint32_t first_set, uint32_t set_count, const VkDescriptorSet *descriptor_sets);
 
-void vk_command_bind_index_buffer(VkCommandBuffer command_buffer, VkBuffer buffer, uint64_t offset);
+void vk_command_bind_index_buffer(VkCommandBuffer command_buffer, VkBuffer buffer, uint64_t offset, VkIndexType index_type);
 
 void vk_command_push_constants(VkCommandBuffer command_buffer, VkPipelineLayout layout, VkShaderStageFlags stage_flags,
                                uint32_t size, const void *data);
@@ -63,7 +64,14 @@ void
 vk_command_draw(VkCommandBuffer command_buffer, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex,
                 uint32_t first_instance);
 
-void vk_command_draw_indexed(VkCommandBuffer command_buffer, uint32_t index_count);
+void vk_command_draw_indexed(VkCommandBuffer command_buffer, uint32_t index_count, uint32_t instance_count, uint32_t first_index,
+                             int32_t vertex_offset, uint32_t first_instance);
+
+// `count_buffer` 中 `count_offset` 处的 u32 为实际绘制数，不超过 `max_draw_count`
+void vk_command_draw_indexed_indirect_count(VkCommandBuffer command_buffer, VkBuffer buffer, uint64_t offset, VkBuffer count_buffer,
+                                            uint64_t count_offset, uint32_t max_draw_count, uint32_t stride);
+
+void vk_command_fill_buffer(VkCommandBuffer command_buffer, VkBuffer buffer, uint64_t offset, uint64_t size, uint32_t data);
 
 void
 vk_command_copy_buffer(VkCommandBuffer command_buffer, VkBuffer src, VkBuffer dst, uint32_t size, uint32_t src_offset,
@@ -14,6 +14,14 @@ struct VkContext {
     VkDevice device;
     uint32_t graphics_queue_family_index;
     VkQueue graphics_queue;
+    uint32_t transfer_queue_family_index; // 没有独立的 transfer queue family 时与 graphics 相同
+    VkQueue transfer_queue;
+    bool is_draw_indirect_count_supported; // vkCmdDrawIndexedIndirectCount，gpu 剔除后按实际数量绘制
+    bool is_draw_indirect_first_instance_supported; // 间接绘制命令的 firstInstance 可以非 0，用于索引实例数据
+    bool is_storage_image_extended_formats_supported; // rg32f 等扩展格式的 storage image，用于构建 min/max 深度金字塔
+    bool is_texture_compression_bc_supported; // 不支持时贴图以未压缩格式烘焙
+    bool is_memory_budget_supported; // VK_EXT_memory_budget，不支持时贴图流式加载只使用配置的上限
+    bool is_index_type_uint8_supported; // VK_EXT_index_type_uint8，不支持时小 primitive 使用 u16 索引
     VmaAllocator allocator;
     VkSwapchainKHR swapchain;
     VkExtent2D swapchain_extent;
@@ -60,6 +60,25 @@ bool get_queue_family_index(const std::vector<VkQueueFamilyProperties> &queue_fa
     return false;
 }
 
+// 优先选择只支持 transfer 的 family（通常对应独立的 dma 引擎），其次是不支持 graphics 的 family
+static bool get_transfer_queue_family_index(const std::vector<VkQueueFamilyProperties> &queue_families, uint32_t *queue_family_index) {
+    for (uint32_t i = 0; i < queue_families.size(); ++i) {
+        VkQueueFlags flags = queue_families[i].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+            *queue_family_index = i;
+            return true;
+        }
+    }
+    for (uint32_t i = 0; i < queue_families.size(); ++i) {
+        VkQueueFlags flags = queue_families[i].queueFlags;
+        if ((flags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT)) && !(flags & VK_QUEUE_GRAPHICS_BIT)) {
+            *queue_family_index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
 bool vk_create_device(VkContext *vk_context) {
     if (!select_physical_device(vk_context)) { return false; }
 
@@ -98,6 +117,24 @@ bool vk_create_device(VkContext *vk_context) {
         if (!found) { return false; }
     }
 
+    // 可选扩展：VK_EXT_memory_budget 提供各 heap 当前可用的预算，贴图流式加载据此控制显存占用
+    for (const VkExtensionProperties &extension: extensions) {
+        if (strcmp(extension.extensionName, "VK_EXT_memory_budget") == 0) {
+            required_extensions.push_back("VK_EXT_memory_budget");
+            vk_context->is_memory_budget_supported = true;
+            break;
+        }
+    }
+
+    // 可选扩展：VK_EXT_index_type_uint8，顶点数不超过 256 的 primitive 以 u8 存放索引
+    bool has_index_type_uint8_extension = false;
+    for (const VkExtensionProperties &extension: extensions) {
+        if (strcmp(extension.extensionName, "VK_EXT_index_type_uint8") == 0) {
+            has_index_type_uint8_extension = true;
+            break;
+        }
+    }
+
     uint32_t queue_family_count = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(vk_context->physical_device, &queue_family_count, nullptr);
     std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
@@ -118,15 +155,38 @@ bool vk_create_device(VkContext *vk_context) {
     VkPhysicalDeviceFeatures features;
     vkGetPhysicalDeviceFeatures(vk_context->physical_device, &features);
 
+    VkPhysicalDeviceIndexTypeUint8FeaturesEXT supported_index_type_uint8_features{};
+    supported_index_type_uint8_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INDEX_TYPE_UINT8_FEATURES_EXT;
+    VkPhysicalDeviceVulkan12Features supported_vulkan_12_features{};
+    supported_vulkan_12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    if (has_index_type_uint8_extension) { supported_vulkan_12_features.pNext = &supported_index_type_uint8_features; }
+    VkPhysicalDeviceFeatures2 supported_features{};
+    supported_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported_features.pNext = &supported_vulkan_12_features;
+    vkGetPhysicalDeviceFeatures2(vk_context->physical_device, &supported_features);
+
     VkPhysicalDeviceFeatures required_device_features{};
     required_device_features.samplerAnisotropy = features.samplerAnisotropy;
     required_device_features.fillModeNonSolid = features.fillModeNonSolid;
     required_device_features.wideLines = features.wideLines;
+    required_device_features.multiDrawIndirect = features.multiDrawIndirect;
+    required_device_features.drawIndirectFirstInstance = features.drawIndirectFirstInstance;
+    required_device_features.textureCompressionBC = features.textureCompressionBC;
+    required_device_features.shaderStorageImageExtendedFormats = features.shaderStorageImageExtendedFormats;
 
     VkPhysicalDeviceFragmentShaderBarycentricFeaturesKHR fragment_shader_barycentric_features{};
     fragment_shader_barycentric_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADER_BARYCENTRIC_FEATURES_KHR;
     fragment_shader_barycentric_features.fragmentShaderBarycentric = VK_TRUE;
 
+    VkPhysicalDeviceIndexTypeUint8FeaturesEXT index_type_uint8_features{};
+    index_type_uint8_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INDEX_TYPE_UINT8_FEATURES_EXT;
+    index_type_uint8_features.indexTypeUint8 = VK_TRUE;
+    if (has_index_type_uint8_extension && supported_index_type_uint8_features.indexTypeUint8) {
+        required_extensions.push_back("VK_EXT_index_type_uint8");
+        fragment_shader_barycentric_features.pNext = &index_type_uint8_features;
+        vk_context->is_index_type_uint8_supported = true;
+    }
+
     VkPhysicalDeviceSynchronization2Features synchronization2_features{};
     synchronization2_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
     synchronization2_features.synchronization2 = VK_TRUE;
@@ -142,6 +202,7 @@ bool vk_create_device(VkContext *vk_context) {
     vulkan_12_features.timelineSemaphore = VK_TRUE;
     vulkan_12_features.uniformAndStorageBuffer8BitAccess = VK_TRUE;
     vulkan_12_features.bufferDeviceAddress = VK_TRUE;
+    vulkan_12_features.drawIndirectCount = supported_vulkan_12_features.drawIndirectCount && features.multiDrawIndirect;
     vulkan_12_features.pNext = &dynamic_rendering_features;
 
     VkDeviceCreateInfo device_create_info{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
@@ -156,11 +217,32 @@ bool vk_create_device(VkContext *vk_context) {
 
     volkLoadDevice(vk_context->device);
 
+    vk_context->is_draw_indirect_count_supported = vulkan_12_features.drawIndirectCount;
+    log_info("vk draw indirect count: %s", vk_context->is_draw_indirect_count_supported ? "supported" : "unsupported");
+    vk_context->is_draw_indirect_first_instance_supported = required_device_features.drawIndirectFirstInstance;
+    log_info("vk draw indirect first instance: %s", vk_context->is_draw_indirect_first_instance_supported ? "supported" : "unsupported");
+    vk_context->is_storage_image_extended_formats_supported = required_device_features.shaderStorageImageExtendedFormats;
+    log_info("vk storage image extended formats: %s", vk_context->is_storage_image_extended_formats_supported ? "supported" : "unsupported");
+    vk_context->is_texture_compression_bc_supported = required_device_features.textureCompressionBC;
+    log_info("vk texture compression bc: %s", vk_context->is_texture_compression_bc_supported ? "supported" : "unsupported");
+    log_info("vk memory budget: %s", vk_context->is_memory_budget_supported ? "supported" : "unsupported");
+    log_info("vk index type uint8: %s", vk_context->is_index_type_uint8_supported ? "supported" : "unsupported");
+
     // get graphics queue
     if (found = get_queue_family_index(queue_families, VK_QUEUE_GRAPHICS_BIT,
                                        &vk_context->graphics_queue_family_index); !found) { return false; }
     vkGetDeviceQueue(vk_context->device, vk_context->graphics_queue_family_index, 0, &vk_context->graphics_queue);
 
+    // get transfer queue, fallback to graphics queue
+    if (get_transfer_queue_family_index(queue_families, &vk_context->transfer_queue_family_index)) {
+        vkGetDeviceQueue(vk_context->device, vk_context->transfer_queue_family_index, 0, &vk_context->transfer_queue);
+        log_info("vk transfer queue family: %u", vk_context->transfer_queue_family_index);
+    } else {
+        vk_context->transfer_queue_family_index = vk_context->graphics_queue_family_index;
+        vk_context->transfer_queue = vk_context->graphics_queue;
+        log_info("vk no dedicated transfer queue family, uploads use the graphics queue");
+    }
+
     return true;
 }
 
@@ -6,6 +6,43 @@
 #include "vk_queue.h"
 #include "core/logging.h"
 
+ImageFormatBlock vk_get_format_block(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8_UNORM: return {1, 1, 1};
+        case VK_FORMAT_R8G8_UNORM: return {1, 1, 2};
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_R32_SFLOAT: return {1, 1, 4};
+        case VK_FORMAT_R16G16B16A16_SFLOAT: return {1, 1, 8};
+        case VK_FORMAT_R32G32B32A32_SFLOAT: return {1, 1, 16};
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK: return {4, 4, 8};
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK: return {4, 4, 16};
+        default: ASSERT_MESSAGE(false, "unsupported image format - %d", format);
+    }
+    return {1, 1, 0};
+}
+
+size_t vk_get_image_level_size(VkFormat format, uint32_t width, uint32_t height) {
+    ImageFormatBlock block = vk_get_format_block(format);
+    size_t block_count_x = (width + block.width - 1) / block.width;
+    size_t block_count_y = (height + block.height - 1) / block.height;
+    return block_count_x * block_count_y * block.size;
+}
+
+uint32_t vk_get_mip_level_count(uint32_t width, uint32_t height) {
+    return (uint32_t) std::floor(std::log2(std::max(width, height))) + 1;
+}
+
 void vk_create_image(VkContext *vk_context, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage,
                      bool enable_mipmap, Image **out_image) {
     Image *image = new Image();
@@ -18,14 +55,14 @@ void vk_create_image(VkContext *vk_context, uint32_t width, uint32_t height, VkF
     image_create_info.extent.height = height;
     image_create_info.extent.depth = 1;
     if (enable_mipmap) {
-        image_create_info.mipLevels = (uint32_t) std::floor(std::log2(std::max(width, height))) + 1;
+        image_create_info.mipLevels = vk_get_mip_level_count(width, height);
     } else {
         image_create_info.mipLevels = 1;
     }
     image_create_info.arrayLayers = 1;
     image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
     image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
-    image_create_info.usage = usage;
+    image_create_info.usage = enable_mipmap ? usage | VK_IMAGE_USAGE_TRANSFER_SRC_BIT : usage;
     image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
@@ -46,14 +83,20 @@ void vk_create_image_from_data(VkContext *vk_context, const void *data, uint32_t
     vk_create_image(vk_context, width, height, format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT, enable_mipmap, out_image);
 
     Buffer staging_buffer;
-    size_t size = width * height * 4; // todo support other formats
+    size_t size = vk_get_image_level_size(format, width, height);
     vk_create_buffer(vk_context, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, &staging_buffer);
     vk_copy_data_to_buffer(vk_context, &staging_buffer, data, size);
 
     vk_command_buffer_submit(vk_context, [&](VkCommandBuffer command_buffer) {
         vk_transition_image_layout(command_buffer, (*out_image)->image, VK_PIPELINE_STAGE_2_NONE, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
         vk_command_copy_buffer_to_image(command_buffer, staging_buffer.handle, (*out_image)->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, width, height);
-        vk_transition_image_layout(command_buffer, (*out_image)->image, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        if ((*out_image)->mip_levels > 1) {
+            ASSERT_MESSAGE(vk_is_mipmap_generation_supported(vk_context, format), "format %d does not support mipmap generation", format);
+            vk_generate_mipmaps(command_buffer, (*out_image)->image, width, height, 0, (*out_image)->mip_levels - 1);
+            vk_transition_image_layout(command_buffer, (*out_image)->image, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        } else {
+            vk_transition_image_layout(command_buffer, (*out_image)->image, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
     });
 
     vk_destroy_buffer(vk_context, &staging_buffer);
@@ -97,6 +140,76 @@ void vk_transition_image_layout(VkCommandBuffer command_buffer, VkImage image,
     vkCmdPipelineBarrier2KHR(command_buffer, &dependency_info);
 }
 
+void vk_transition_image_levels(VkCommandBuffer command_buffer, VkImage image, uint32_t base_level, uint32_t level_count,
+                                VkPipelineStageFlags2 src_stage_mask, VkPipelineStageFlags2 dst_stage_mask,
+                                VkAccessFlags2 src_access_mask, VkAccessFlags2 dst_access_mask,
+                                VkImageLayout old_layout, VkImageLayout new_layout) {
+    VkImageMemoryBarrier2 image_memory_barrier{};
+    image_memory_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    image_memory_barrier.srcStageMask = src_stage_mask;
+    image_memory_barrier.dstStageMask = dst_stage_mask;
+    image_memory_barrier.srcAccessMask = src_access_mask;
+    image_memory_barrier.dstAccessMask = dst_access_mask;
+    image_memory_barrier.oldLayout = old_layout;
+    image_memory_barrier.newLayout = new_layout;
+    image_memory_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    image_memory_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    image_memory_barrier.image = image;
+    image_memory_barrier.subresourceRange = vk_image_subresource_range(VK_IMAGE_ASPECT_COLOR_BIT);
+    image_memory_barrier.subresourceRange.baseMipLevel = base_level;
+    image_memory_barrier.subresourceRange.levelCount = level_count;
+
+    VkDependencyInfo dependency_info{};
+    dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency_info.imageMemoryBarrierCount = 1;
+    dependency_info.pImageMemoryBarriers = &image_memory_barrier;
+
+    vkCmdPipelineBarrier2KHR(command_buffer, &dependency_info);
+}
+
+bool vk_is_mipmap_generation_supported(VkContext *vk_context, VkFormat format) {
+    VkFormatProperties format_properties;
+    vkGetPhysicalDeviceFormatProperties(vk_context->physical_device, format, &format_properties);
+    VkFormatFeatureFlags required_features =
+            VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (format_properties.optimalTilingFeatures & required_features) == required_features;
+}
+
+void vk_generate_mipmaps(VkCommandBuffer command_buffer, VkImage image, uint32_t width, uint32_t height, uint32_t base_level, uint32_t level_count) {
+    int32_t src_width = std::max(width >> base_level, 1u), src_height = std::max(height >> base_level, 1u);
+    for (uint32_t level = base_level + 1; level <= base_level + level_count; ++level) {
+        // 上一层的写入（拷贝或 blit）完成后才能作为 blit 的源
+        vk_transition_image_levels(command_buffer, image, level - 1, 1, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                   VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+        int32_t dst_width = std::max(src_width / 2, 1), dst_height = std::max(src_height / 2, 1);
+        VkImageBlit2KHR image_blit_region{};
+        image_blit_region.sType = VK_STRUCTURE_TYPE_IMAGE_BLIT_2_KHR;
+        image_blit_region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1};
+        image_blit_region.srcOffsets[1] = {src_width, src_height, 1};
+        image_blit_region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+        image_blit_region.dstOffsets[1] = {dst_width, dst_height, 1};
+
+        VkBlitImageInfo2 blit_image_info{};
+        blit_image_info.sType = VK_STRUCTURE_TYPE_BLIT_IMAGE_INFO_2;
+        blit_image_info.srcImage = image;
+        blit_image_info.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        blit_image_info.dstImage = image;
+        blit_image_info.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        blit_image_info.regionCount = 1;
+        blit_image_info.pRegions = &image_blit_region;
+        blit_image_info.filter = VK_FILTER_LINEAR;
+        vkCmdBlitImage2KHR(command_buffer, &blit_image_info);
+
+        src_width = dst_width;
+        src_height = dst_height;
+    }
+    vk_transition_image_levels(command_buffer, image, base_level + level_count, 1, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                               VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+}
+
 VkImageSubresourceRange vk_image_subresource_range(VkImageAspectFlags aspect_mask) {
     VkImageSubresourceRange subresource_range{};
     subresource_range.aspectMask = aspect_mask;
@@ -11,17 +11,48 @@ struct Image {
     uint16_t mip_levels;
 };
 
+// 格式的纹素块，非压缩格式的块为 1x1 个纹素，`size` 为块的字节数
+struct ImageFormatBlock {
+    uint32_t width;
+    uint32_t height;
+    uint32_t size;
+};
+
+ImageFormatBlock vk_get_format_block(VkFormat format);
+
+// 一层 mip 紧密排列时的字节数，块压缩格式按块向上取整
+size_t vk_get_image_level_size(VkFormat format, uint32_t width, uint32_t height);
+
+// 完整 mip 链的层数，直到 1x1
+uint32_t vk_get_mip_level_count(uint32_t width, uint32_t height);
+
+// `enable_mipmap` 为 true 时创建完整的 mip 链，并加上 TRANSFER_SRC 用途以便在 gpu 上 blit 生成 mip
 void vk_create_image(VkContext *vk_context, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage,
                      bool enable_mipmap, Image **out_image);
 
+// 只写入第 0 层，其余 mip 在同一次提交中 blit 生成
 void vk_create_image_from_data(VkContext *vk_context, const void *data, uint32_t width, uint32_t height,
                                VkFormat format, VkImageUsageFlags usage, bool enable_mipmap, Image **out_image);
 
 void vk_destroy_image(VkContext *vk_context, Image *image);
 
+// 转换所有 mip 层
 void vk_transition_image_layout(VkCommandBuffer command_buffer, VkImage image,
                                 VkPipelineStageFlags2 src_stage_mask, VkPipelineStageFlags2 dst_stage_mask,
                                 VkAccessFlags2 src_access_mask, VkAccessFlags2 dst_access_mask,
                                 VkImageLayout old_layout, VkImageLayout new_layout);
 
+// 只转换 [base_level, base_level + level_count) 层的颜色 image
+void vk_transition_image_levels(VkCommandBuffer command_buffer, VkImage image, uint32_t base_level, uint32_t level_count,
+                                VkPipelineStageFlags2 src_stage_mask, VkPipelineStageFlags2 dst_stage_mask,
+                                VkAccessFlags2 src_access_mask, VkAccessFlags2 dst_access_mask,
+                                VkImageLayout old_layout, VkImageLayout new_layout);
+
+// 格式支持线性过滤的 blit 时才能在 gpu 上生成 mip，块压缩格式均不支持
+bool vk_is_mipmap_generation_supported(VkContext *vk_context, VkFormat format);
+
+// 从第 `base_level` 层逐级 blit 生成之后的 `level_count` 层，每层只等待上一层写完
+// 调用前这些层与 base_level 都处于 TRANSFER_DST_OPTIMAL 且 base_level 已写入，完成后都处于 TRANSFER_SRC_OPTIMAL
+void vk_generate_mipmaps(VkCommandBuffer command_buffer, VkImage image, uint32_t width, uint32_t height, uint32_t base_level, uint32_t level_count);
+
 VkImageSubresourceRange vk_image_subresource_range(VkImageAspectFlags aspect_mask);
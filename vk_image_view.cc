@@ -3,14 +3,19 @@
 
 void vk_create_image_view(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspect,
                           uint16_t mip_levels, VkImageView *image_view) {
+    vk_create_image_level_view(device, image, format, aspect, 0, mip_levels, image_view);
+}
+
+void vk_create_image_level_view(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspect, uint32_t base_level, uint32_t level_count,
+                                VkImageView *image_view) {
     VkImageViewCreateInfo image_view_create_info{};
     image_view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     image_view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
     image_view_create_info.image = image;
     image_view_create_info.format = format;
     image_view_create_info.subresourceRange.aspectMask = aspect;
-    image_view_create_info.subresourceRange.baseMipLevel = 0;
-    image_view_create_info.subresourceRange.levelCount = mip_levels;
+    image_view_create_info.subresourceRange.baseMipLevel = base_level;
+    image_view_create_info.subresourceRange.levelCount = level_count;
     image_view_create_info.subresourceRange.baseArrayLayer = 0;
     image_view_create_info.subresourceRange.layerCount = 1;
     VkResult result = vkCreateImageView(device, &image_view_create_info, nullptr, image_view);
@@ -5,4 +5,8 @@
 void vk_create_image_view(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspect,
                           uint16_t mip_levels, VkImageView *image_view);
 
+// 只包含 [base_level, base_level + level_count) 层的 view，用于逐层读写 mip
+void vk_create_image_level_view(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspect, uint32_t base_level, uint32_t level_count,
+                                VkImageView *image_view);
+
 void vk_destroy_image_view(VkDevice device, VkImageView image_view);
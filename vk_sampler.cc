@@ -11,6 +11,21 @@ void vk_create_sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter
     ASSERT(result == VK_SUCCESS);
 }
 
+void vk_create_mipmap_sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter, VkSamplerMipmapMode mipmap_mode, VkSampler *sampler) {
+    VkSamplerCreateInfo sampler_create_info = {};
+    sampler_create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_create_info.magFilter = mag_filter;
+    sampler_create_info.minFilter = min_filter;
+    sampler_create_info.mipmapMode = mipmap_mode;
+    sampler_create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_create_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_create_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_create_info.maxLod = VK_LOD_CLAMP_NONE;
+
+    VkResult result = vkCreateSampler(device, &sampler_create_info, nullptr, sampler);
+    ASSERT(result == VK_SUCCESS);
+}
+
 void vk_destroy_sampler(VkDevice device, VkSampler sampler) {
     vkDestroySampler(device, sampler, nullptr);
 }
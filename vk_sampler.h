@@ -4,4 +4,7 @@
 
 void vk_create_sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter, VkSampler *sampler);
 
+// 重复寻址，可访问所有 mip
+void vk_create_mipmap_sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter, VkSamplerMipmapMode mipmap_mode, VkSampler *sampler);
+
 void vk_destroy_sampler(VkDevice device, VkSampler sampler);